@@ -17,92 +17,95 @@ Bitstream::Bitstream()
     resetBits();
 }
 
-void Bitstream::push_back(uint8_t val)
+/* make room for numBytes more bytes, doubling the allocation as needed */
+bool Bitstream::reserve(uint32_t numBytes)
 {
     if (!m_fifo)
-        return;
+        return false;
 
-    if (m_byteOccupancy >= m_byteAlloc)
+    if (m_byteOccupancy + numBytes > m_byteAlloc)
     {
-        /** reallocate buffer with doubled size */
-        uint8_t *temp = X265_MALLOC(uint8_t, m_byteAlloc * 2);
-        if (temp)
-        {
-            memcpy(temp, m_fifo, m_byteOccupancy);
-            X265_FREE(m_fifo);
-            m_fifo = temp;
-            m_byteAlloc *= 2;
-        }
-        else
+        uint32_t newAlloc = X265_MAX(m_byteAlloc * 2, m_byteOccupancy + numBytes);
+        uint8_t *temp = X265_MALLOC(uint8_t, newAlloc);
+        if (!temp)
         {
             x265_log(NULL, X265_LOG_ERROR, "Unable to realloc bitstream buffer");
-            return;
+            return false;
         }
+        memcpy(temp, m_fifo, m_byteOccupancy);
+        X265_FREE(m_fifo);
+        m_fifo = temp;
+        m_byteAlloc = newAlloc;
     }
-    m_fifo[m_byteOccupancy++] = val;
+    return true;
 }
 
-void Bitstream::write(uint32_t val, uint32_t numBits)
+/* store the oldest 32 cached bits */
+void Bitstream::flushWord()
 {
-    X265_CHECK(numBits <= 32, "numBits out of range\n");
-    X265_CHECK(numBits == 32 || ((val & (~0u << numBits)) == 0), "numBits & val out of range\n");
-
-    uint32_t totalPartialBits = m_partialByteBits + numBits;
-    uint32_t nextPartialBits = totalPartialBits & 7;
-    uint8_t  nextHeldByte = val << (8 - nextPartialBits);
-    uint32_t writeBytes = totalPartialBits >> 3;
-
-    if (writeBytes)
+    m_cacheBits -= 32;
+    uint32_t word = (uint32_t)(m_cache >> m_cacheBits);
+    if (reserve(4))
     {
-        /* topword aligns m_partialByte with the msb of val */
-        uint32_t topword = (numBits - nextPartialBits) & ~7;
-#if USING_FTRAPV
-        uint32_t write_bits = (topword < 32 ? m_partialByte << topword : 0) | (val >> nextPartialBits);
-#else
-        uint32_t write_bits = (m_partialByte << topword) | (val >> nextPartialBits);
-#endif
+        uint8_t *out = m_fifo + m_byteOccupancy;
+        out[0] = (uint8_t)(word >> 24);
+        out[1] = (uint8_t)(word >> 16);
+        out[2] = (uint8_t)(word >> 8);
+        out[3] = (uint8_t)word;
+        m_byteOccupancy += 4;
+    }
+}
 
-        switch (writeBytes)
-        {
-        case 4: push_back(write_bits >> 24);
-        case 3: push_back(write_bits >> 16);
-        case 2: push_back(write_bits >> 8);
-        case 1: push_back(write_bits);
-        }
+/* store all whole bytes held in the cache */
+void Bitstream::flushBytes()
+{
+    if (m_cacheBits >= 32)
+        flushWord();
 
-        m_partialByte = nextHeldByte;
-        m_partialByteBits = nextPartialBits;
-    }
-    else
+    uint32_t numBytes = m_cacheBits >> 3;
+    if (numBytes && reserve(numBytes))
     {
-        m_partialByte |= nextHeldByte;
-        m_partialByteBits = nextPartialBits;
+        for (uint32_t i = 0; i < numBytes; i++)
+            m_fifo[m_byteOccupancy++] = (uint8_t)(m_cache >> (m_cacheBits - 8 * (i + 1)));
     }
+    m_cacheBits &= 7;
+}
+
+void Bitstream::write(uint32_t val, uint32_t numBits)
+{
+    X265_CHECK(numBits <= 32, "numBits out of range\n");
+    X265_CHECK(numBits == 32 || ((val & (~0u << numBits)) == 0), "numBits & val out of range\n");
+
+    /* the cache holds less than 32 bits, so no pending bit is shifted out */
+    m_cache = (m_cache << numBits) | val;
+    m_cacheBits += numBits;
+    if (m_cacheBits >= 32)
+        flushWord();
 }
 
 void Bitstream::writeByte(uint32_t val)
 {
     // Only CABAC will call writeByte, the fifo must be byte aligned
-    X265_CHECK(!m_partialByteBits, "expecting m_partialByteBits = 0\n");
+    X265_CHECK(!(m_cacheBits & 7), "expecting byte aligned bitstream\n");
 
-    push_back(val);
+    write(val & 0xff, 8);
 }
 
 void Bitstream::writeAlignOne()
 {
-    uint32_t numBits = (8 - m_partialByteBits) & 0x7;
+    uint32_t numBits = (8 - m_cacheBits) & 0x7;
 
     write((1 << numBits) - 1, numBits);
+    flushBytes();
 }
 
 void Bitstream::writeAlignZero()
 {
-    if (m_partialByteBits)
-    {
-        push_back(m_partialByte);
-        m_partialByte = 0;
-        m_partialByteBits = 0;
-    }
+    uint32_t numBits = (8 - m_cacheBits) & 0x7;
+
+    m_cache <<= numBits;
+    m_cacheBits += numBits;
+    flushBytes();
 }
 
 void Bitstream::writeByteAlignment()
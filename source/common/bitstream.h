@@ -60,6 +60,9 @@ public:
 };
 
 
+/* Bits are gathered MSB first in a 64-bit cache and stored to the FIFO four
+ * bytes at a time. The FIFO is only complete once the stream is byte aligned
+ * by writeAlignZero(), writeAlignOne() or writeByteAlignment() */
 class Bitstream : public BitInterface
 {
 public:
@@ -67,9 +70,9 @@ public:
     Bitstream();
     ~Bitstream()                             { X265_FREE(m_fifo); }
 
-    void     resetBits()                     { m_partialByteBits = m_byteOccupancy = 0; m_partialByte = 0; }
-    uint32_t getNumberOfWrittenBytes() const { return m_byteOccupancy; }
-    uint32_t getNumberOfWrittenBits()  const { return m_byteOccupancy * 8 + m_partialByteBits; }
+    void     resetBits()                     { m_byteOccupancy = 0; m_cache = 0; m_cacheBits = 0; }
+    uint32_t getNumberOfWrittenBytes() const { X265_CHECK(!m_cacheBits, "bitstream is not aligned\n"); return m_byteOccupancy; }
+    uint32_t getNumberOfWrittenBits()  const { return m_byteOccupancy * 8 + m_cacheBits; }
     const uint8_t* getFIFO() const           { return m_fifo; }
 
     void     write(uint32_t val, uint32_t numBits);
@@ -84,10 +87,12 @@ private:
     uint8_t *m_fifo;
     uint32_t m_byteAlloc;
     uint32_t m_byteOccupancy;
-    uint32_t m_partialByteBits;
-    uint8_t  m_partialByte;
+    uint64_t m_cache;          // pending bits, right aligned
+    uint32_t m_cacheBits;      // number of pending bits, less than 32 between calls
 
-    void     push_back(uint8_t val);
+    bool     reserve(uint32_t numBytes);
+    void     flushWord();
+    void     flushBytes();
 };
 
 static const uint8_t bitSize[256] =
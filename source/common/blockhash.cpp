@@ -0,0 +1,271 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "picyuv.h"
+#include "blockhash.h"
+
+using namespace X265_NS;
+
+namespace {
+
+/* the hash of a block is a polynomial of its pixels, evaluated mod 2^32 so it
+ * can be rolled one pixel right or down in constant time */
+const uint32_t ROW_BASE = 0x01000193;
+const uint32_t COL_BASE = 0x9E3779B1;
+
+inline uint32_t power7(uint32_t base)
+{
+    uint32_t p = 1;
+    for (int i = 0; i < BlockHash::BLOCK_SIZE - 1; i++)
+        p *= base;
+    return p;
+}
+
+/* hash of a row of constant value v is v * rowSum() */
+inline uint32_t rowSum()
+{
+    uint32_t s = 0;
+    for (int i = 0; i < BlockHash::BLOCK_SIZE; i++)
+        s = s * ROW_BASE + 1;
+    return s;
+}
+
+/* bijective finalizer, spreads the polynomial over the bucket bits */
+inline uint32_t mix(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+inline uint32_t hashRow(const pixel* src)
+{
+    uint32_t h = 0;
+    for (int i = 0; i < BlockHash::BLOCK_SIZE; i++)
+        h = h * ROW_BASE + src[i];
+    return h;
+}
+
+/* blocks of identical rows or of constant rows are not worth indexing */
+inline bool isSimpleBlock(const uint32_t* rowHash, intptr_t hashStride, const pixel* src, intptr_t stride, uint32_t sum)
+{
+    bool bSameRows = true;
+    for (int r = 1; r < BlockHash::BLOCK_SIZE && bSameRows; r++)
+        bSameRows = rowHash[r * hashStride] == rowHash[0];
+    if (bSameRows)
+        return true;
+
+    for (int r = 0; r < BlockHash::BLOCK_SIZE; r++)
+        if (rowHash[r * hashStride] != src[r * stride] * sum)
+            return false;
+    return true;
+}
+
+}
+
+bool BlockHashScratch::create(uint32_t picWidth, uint32_t picHeight)
+{
+    if (picWidth < BlockHash::BLOCK_SIZE || picHeight < BlockHash::BLOCK_SIZE)
+        return true;
+
+    uint32_t width = picWidth - BlockHash::BLOCK_SIZE + 1;
+    CHECKED_MALLOC(rowHash, uint32_t, width * picHeight);
+    CHECKED_MALLOC(bIndexed, uint8_t, width * (picHeight - BlockHash::BLOCK_SIZE + 1));
+    return true;
+
+fail:
+    destroy();
+    return false;
+}
+
+void BlockHashScratch::destroy()
+{
+    X265_FREE(rowHash);
+    X265_FREE(bIndexed);
+    rowHash = NULL;
+    bIndexed = NULL;
+}
+
+BlockHash::BlockHash()
+{
+    m_keys = m_entries = m_bucketStart = NULL;
+    m_freeListNext = NULL;
+    m_width = m_height = 0;
+    m_bucketBits = 0;
+    m_bValid = false;
+}
+
+void BlockHash::destroy()
+{
+    X265_FREE(m_keys);
+    X265_FREE(m_entries);
+    X265_FREE(m_bucketStart);
+    m_keys = m_entries = m_bucketStart = NULL;
+    m_width = m_height = 0;
+    m_bValid = false;
+}
+
+bool BlockHash::create(uint32_t picWidth, uint32_t picHeight)
+{
+    destroy();
+
+    uint32_t width = picWidth - BLOCK_SIZE + 1;
+    uint32_t numPos = width * (picHeight - BLOCK_SIZE + 1);
+
+    /* about two positions per bucket */
+    m_bucketBits = 8;
+    while (m_bucketBits < 24 && (1u << (m_bucketBits + 1)) < numPos)
+        m_bucketBits++;
+
+    CHECKED_MALLOC(m_keys, uint32_t, numPos);
+    CHECKED_MALLOC(m_entries, uint32_t, numPos);
+    CHECKED_MALLOC(m_bucketStart, uint32_t, (1 << m_bucketBits) + 1);
+    m_width = width;
+    m_height = picHeight - BLOCK_SIZE + 1;
+    return true;
+
+fail:
+    destroy();
+    return false;
+}
+
+bool BlockHash::build(const PicYuv& pic, BlockHashScratch& scratch)
+{
+    m_bValid = index(pic, scratch);
+    m_built.set(1);
+    return m_bValid;
+}
+
+bool BlockHash::index(const PicYuv& pic, BlockHashScratch& scratch)
+{
+    if (pic.m_picWidth < BLOCK_SIZE || pic.m_picHeight < BLOCK_SIZE || !scratch.rowHash)
+        return false;
+
+    uint32_t width = pic.m_picWidth - BLOCK_SIZE + 1;
+    uint32_t height = pic.m_picHeight - BLOCK_SIZE + 1;
+    uint32_t numPos = width * height;
+    if ((width != m_width || height != m_height) && !create(pic.m_picWidth, pic.m_picHeight))
+        return false;
+
+    uint32_t* const rowHashes = scratch.rowHash;
+    uint8_t* const bIndexed = scratch.bIndexed;
+
+    const pixel* org = pic.m_picOrg[0];
+    intptr_t stride = pic.m_stride;
+    const uint32_t rowPow = power7(ROW_BASE);
+    const uint32_t colPow = power7(COL_BASE);
+    const uint32_t sum = rowSum();
+
+    /* hash of the BLOCK_SIZE pixels right of each position, rolled along rows */
+    for (uint32_t y = 0; y < pic.m_picHeight; y++)
+    {
+        const pixel* src = org + y * stride;
+        uint32_t* rowHash = rowHashes + y * width;
+        uint32_t h = hashRow(src);
+        rowHash[0] = h;
+        for (uint32_t x = 1; x < width; x++)
+        {
+            h = (h - src[x - 1] * rowPow) * ROW_BASE + src[x + BLOCK_SIZE - 1];
+            rowHash[x] = h;
+        }
+    }
+
+    /* polynomial of the row hashes, rolled down columns */
+    for (uint32_t x = 0; x < width; x++)
+    {
+        uint32_t h = 0;
+        for (int r = 0; r < BLOCK_SIZE; r++)
+            h = h * COL_BASE + rowHashes[r * width + x];
+        m_keys[x] = h;
+    }
+    for (uint32_t y = 1; y < height; y++)
+    {
+        const uint32_t* prev = m_keys + (y - 1) * width;
+        const uint32_t* top = rowHashes + (y - 1) * width;
+        const uint32_t* bottom = rowHashes + (y + BLOCK_SIZE - 1) * width;
+        uint32_t* keys = m_keys + y * width;
+        for (uint32_t x = 0; x < width; x++)
+            keys[x] = (prev[x] - top[x] * colPow) * COL_BASE + bottom[x];
+    }
+
+    /* counting sort of the indexed positions by bucket */
+    uint32_t numBuckets = 1 << m_bucketBits;
+    memset(m_bucketStart, 0, (numBuckets + 1) * sizeof(uint32_t));
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint32_t i = y * width + x;
+            m_keys[i] = mix(m_keys[i]);
+            bIndexed[i] = !isSimpleBlock(rowHashes + i, width, org + y * stride + x, stride, sum);
+            if (bIndexed[i])
+                m_bucketStart[bucket(m_keys[i]) + 1]++;
+        }
+    }
+
+    for (uint32_t b = 1; b <= numBuckets; b++)
+        m_bucketStart[b] += m_bucketStart[b - 1];
+
+    /* bucketStart[b] is advanced to the start of bucket b + 1 while filling */
+    for (uint32_t i = 0; i < numPos; i++)
+        if (bIndexed[i])
+            m_entries[m_bucketStart[bucket(m_keys[i])]++] = i;
+
+    for (uint32_t b = numBuckets; b > 0; b--)
+        m_bucketStart[b] = m_bucketStart[b - 1];
+    m_bucketStart[0] = 0;
+
+    return true;
+}
+
+int BlockHash::lookup(const pixel* src, intptr_t stride, uint16_t (*pos)[2], int maxPos) const
+{
+    uint32_t rowHash[BLOCK_SIZE];
+    for (int r = 0; r < BLOCK_SIZE; r++)
+        rowHash[r] = hashRow(src + r * stride);
+
+    if (isSimpleBlock(rowHash, 1, src, stride, rowSum()))
+        return 0;
+
+    uint32_t h = 0;
+    for (int r = 0; r < BLOCK_SIZE; r++)
+        h = h * COL_BASE + rowHash[r];
+    uint32_t key = mix(h);
+
+    int numPos = 0;
+    uint32_t b = bucket(key);
+    for (uint32_t e = m_bucketStart[b]; e < m_bucketStart[b + 1] && numPos < maxPos; e++)
+    {
+        uint32_t i = m_entries[e];
+        if (m_keys[i] == key)
+        {
+            pos[numPos][0] = (uint16_t)(i % m_width);
+            pos[numPos][1] = (uint16_t)(i / m_width);
+            numPos++;
+        }
+    }
+
+    return numPos;
+}
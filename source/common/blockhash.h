@@ -0,0 +1,102 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#ifndef X265_BLOCKHASH_H
+#define X265_BLOCKHASH_H
+
+#include "common.h"
+#include "threading.h"
+
+namespace X265_NS {
+// private x265 namespace
+
+class PicYuv;
+
+/* Scratch space of BlockHash::build(), kept by each frame encoder */
+struct BlockHashScratch
+{
+    uint32_t* rowHash;   // hash of the BLOCK_SIZE pixels right of each position
+    uint8_t*  bIndexed;  // position was indexed
+
+    BlockHashScratch() : rowHash(NULL), bIndexed(NULL) {}
+
+    bool create(uint32_t picWidth, uint32_t picHeight);
+    void destroy();
+};
+
+/* Hash table of all 8x8 luma block positions of a picture, used by --hash-me
+ * to find exact repeats of a block at any distance. Blocks made of identical
+ * rows or of constant rows are not indexed, they match nearly everywhere and
+ * are found by the regular motion search anyway. Candidates returned by
+ * lookup() share the hash of the query block and must be verified. Tables
+ * are only attached to pictures which will be referenced, and recycled by the
+ * DPB once they are not */
+class BlockHash
+{
+public:
+
+    enum { BLOCK_SIZE = 8 };
+
+    BlockHash();
+
+    BlockHash*  m_freeListNext;
+
+    /* index the luma plane of the picture, re-using buffers when the
+     * picture size is unchanged. Marks the build finished, even on failure */
+    bool build(const PicYuv& pic, BlockHashScratch& scratch);
+    void destroy();
+
+    /* mark the table as not yet built for a new picture */
+    void reset()         { m_bValid = false; m_built.set(0); }
+
+    /* block until build() has finished */
+    void waitForBuild()
+    {
+        int built = m_built.get();
+        while (!built)
+            built = m_built.waitForChange(built);
+    }
+
+    bool isValid() const { return m_bValid; }
+
+    /* store the picture positions (x, y) of up to maxPos blocks whose hash
+     * equals that of the 8x8 block at src, returns the number stored */
+    int lookup(const pixel* src, intptr_t stride, uint16_t (*pos)[2], int maxPos) const;
+
+protected:
+
+    uint32_t* m_keys;          // hash of the block at each position
+    uint32_t* m_entries;       // indexed positions, grouped by bucket
+    uint32_t* m_bucketStart;   // first entry of each bucket, plus an end marker
+    uint32_t  m_width;         // number of block positions per row
+    uint32_t  m_height;        // number of block rows
+    int       m_bucketBits;
+    bool      m_bValid;
+    ThreadSafeInteger m_built; // build() has finished
+
+    bool create(uint32_t picWidth, uint32_t picHeight);
+    bool index(const PicYuv& pic, BlockHashScratch& scratch);
+
+    uint32_t bucket(uint32_t key) const { return key >> (32 - m_bucketBits); }
+};
+}
+
+#endif // ifndef X265_BLOCKHASH_H
@@ -271,7 +271,7 @@ void CUData::initialize(const CUDataMemPool& dataPool, uint32_t depth, int csp,
     }
 }
 
-void CUData::initCTU(const Frame& frame, uint32_t cuAddr, int qp)
+void CUData::initCTU(const Frame& frame, uint32_t cuAddr, int qp, bool bFirstRowInSlice, bool bLastRowInSlice, bool bLastCuInSlice)
 {
     m_encData       = frame.m_encData;
     m_slice         = m_encData->m_slice;
@@ -280,6 +280,9 @@ void CUData::initCTU(const Frame& frame, uint32_t cuAddr, int qp)
     m_cuPelY        = (cuAddr / m_slice->m_sps->numCuInWidth) << g_maxLog2CUSize;
     m_absIdxInCTU   = 0;
     m_numPartitions = NUM_4x4_PARTITIONS;
+    m_bFirstRowInSlice = bFirstRowInSlice;
+    m_bLastRowInSlice  = bLastRowInSlice;
+    m_bLastCuInSlice   = bLastCuInSlice;
 
     /* sequential memsets */
     m_partSet((uint8_t*)m_qp, (uint8_t)qp);
@@ -298,11 +301,30 @@ void CUData::initCTU(const Frame& frame, uint32_t cuAddr, int qp)
     /* initialize the remaining CU data in one memset */
     memset(m_cuDepth, 0, (frame.m_param->internalCsp == X265_CSP_I400 ? BytesPerPartition - 11 : BytesPerPartition - 7) * m_numPartitions);
 
+    /* CTUs of other slices and tiles are not available for prediction */
+    const PPS& pps = *m_slice->m_pps;
     uint32_t widthInCU = m_slice->m_sps->numCuInWidth;
-    m_cuLeft = (m_cuAddr % widthInCU) ? m_encData->getPicCTU(m_cuAddr - 1) : NULL;
-    m_cuAbove = (m_cuAddr / widthInCU) ? m_encData->getPicCTU(m_cuAddr - widthInCU) : NULL;
+    uint32_t col = m_cuAddr % widthInCU, row = m_cuAddr / widthInCU;
+    int tileCol = 0, tileRow = 0;
+    while (col >= pps.tileColBd[tileCol + 1])
+        tileCol++;
+    while (row >= pps.tileRowBd[tileRow + 1])
+        tileRow++;
+    m_bFirstRowInTile = row == pps.tileRowBd[tileRow];
+    m_bFirstColInTile = col == pps.tileColBd[tileCol];
+
+    m_cuLeft = !m_bFirstColInTile ? m_encData->getPicCTU(m_cuAddr - 1) : NULL;
+    m_cuAbove = !m_bFirstRowInTile && !m_bFirstRowInSlice ? m_encData->getPicCTU(m_cuAddr - widthInCU) : NULL;
     m_cuAboveLeft = (m_cuLeft && m_cuAbove) ? m_encData->getPicCTU(m_cuAddr - widthInCU - 1) : NULL;
-    m_cuAboveRight = (m_cuAbove && ((m_cuAddr % widthInCU) < (widthInCU - 1))) ? m_encData->getPicCTU(m_cuAddr - widthInCU + 1) : NULL;
+    m_cuAboveRight = (m_cuAbove && col + 1 < pps.tileColBd[tileCol + 1]) ? m_encData->getPicCTU(m_cuAddr - widthInCU + 1) : NULL;
+
+    /* at the start of a tile row segment, the CTU coded before is the last of the row above within the tile */
+    if (!m_bFirstColInTile)
+        m_cuPrev = m_cuLeft;
+    else if (!m_bFirstRowInTile && !m_bFirstRowInSlice && !pps.bEntropyCodingSyncEnabled)
+        m_cuPrev = m_encData->getPicCTU(m_cuAddr - widthInCU + pps.tileColBd[tileCol + 1] - pps.tileColBd[tileCol] - 1);
+    else
+        m_cuPrev = NULL;
 }
 
 // initialize Sub partition
@@ -318,6 +340,12 @@ void CUData::initSubCU(const CUData& ctu, const CUGeom& cuGeom, int qp)
     m_cuAbove       = ctu.m_cuAbove;
     m_cuAboveLeft   = ctu.m_cuAboveLeft;
     m_cuAboveRight  = ctu.m_cuAboveRight;
+    m_cuPrev        = ctu.m_cuPrev;
+    m_bFirstRowInSlice = ctu.m_bFirstRowInSlice;
+    m_bFirstRowInTile  = ctu.m_bFirstRowInTile;
+    m_bFirstColInTile  = ctu.m_bFirstColInTile;
+    m_bLastRowInSlice  = ctu.m_bLastRowInSlice;
+    m_bLastCuInSlice   = ctu.m_bLastCuInSlice;
     X265_CHECK(m_numPartitions == cuGeom.numPartitions, "initSubCU() size mismatch\n");
 
     m_partSet((uint8_t*)m_qp, (uint8_t)qp);
@@ -406,6 +434,12 @@ void CUData::initLosslessCU(const CUData& cu, const CUGeom& cuGeom)
     m_cuAbove      = cu.m_cuAbove;
     m_cuAboveLeft  = cu.m_cuAboveLeft;
     m_cuAboveRight = cu.m_cuAboveRight;
+    m_cuPrev       = cu.m_cuPrev;
+    m_bFirstRowInSlice = cu.m_bFirstRowInSlice;
+    m_bFirstRowInTile  = cu.m_bFirstRowInTile;
+    m_bFirstColInTile  = cu.m_bFirstColInTile;
+    m_bLastRowInSlice  = cu.m_bLastRowInSlice;
+    m_bLastCuInSlice   = cu.m_bLastCuInSlice;
     m_absIdxInCTU  = cuGeom.absPartIdx;
     m_numPartitions = cuGeom.numPartitions;
     memcpy(m_qp, cu.m_qp, BytesPerPartition * m_numPartitions);
@@ -833,8 +867,8 @@ int8_t CUData::getLastCodedQP(uint32_t absPartIdx) const
     {
         if (m_absIdxInCTU)
             return m_encData->getPicCTU(m_cuAddr)->getLastCodedQP(m_absIdxInCTU);
-        else if (m_cuAddr > 0 && !(m_slice->m_pps->bEntropyCodingSyncEnabled && !(m_cuAddr % m_slice->m_sps->numCuInWidth)))
-            return m_encData->getPicCTU(m_cuAddr - 1)->getLastCodedQP(NUM_4x4_PARTITIONS);
+        else if (m_cuPrev)
+            return m_cuPrev->getLastCodedQP(NUM_4x4_PARTITIONS);
         else
             return (int8_t)m_slice->m_sliceQp;
     }
@@ -208,13 +208,20 @@ public:
     const CUData* m_cuAboveRight;     // pointer to above-right neighbor CTU
     const CUData* m_cuAbove;          // pointer to above neighbor CTU
     const CUData* m_cuLeft;           // pointer to left neighbor CTU
+    const CUData* m_cuPrev;           // CTU coded before this one in its slice, tile or WPP row, predicts the first QP
+
+    bool          m_bFirstRowInSlice; // CTU is in the first CTU row of its slice, nothing above is available
+    bool          m_bFirstRowInTile;  // CTU is in the first CTU row of its tile, nothing above is available for prediction
+    bool          m_bFirstColInTile;  // CTU is in the first CTU column of its tile, nothing left is available for prediction
+    bool          m_bLastRowInSlice;  // CTU is in the last CTU row of its slice
+    bool          m_bLastCuInSlice;   // CTU is the last CTU of its slice, end_of_slice_segment_flag is set
 
     CUData();
 
     void     initialize(const CUDataMemPool& dataPool, uint32_t depth, int csp, int instance);
     static void calcCTUGeoms(uint32_t ctuWidth, uint32_t ctuHeight, uint32_t maxCUSize, uint32_t minCUSize, CUGeom cuDataArray[CUGeom::MAX_GEOMS]);
 
-    void     initCTU(const Frame& frame, uint32_t cuAddr, int qp);
+    void     initCTU(const Frame& frame, uint32_t cuAddr, int qp, bool bFirstRowInSlice, bool bLastRowInSlice, bool bLastCuInSlice);
     void     initSubCU(const CUData& ctu, const CUGeom& cuGeom, int qp);
     void     initLosslessCU(const CUData& cu, const CUGeom& cuGeom);
 
@@ -288,6 +295,8 @@ public:
     const CUData* getPUAboveRightAdi(uint32_t& arPartUnitIdx, uint32_t curPartUnitIdx, uint32_t partUnitOffset) const;
     const CUData* getPUBelowLeftAdi(uint32_t& blPartUnitIdx, uint32_t curPartUnitIdx, uint32_t partUnitOffset) const;
 
+    MV       scaleMvByPOCDist(const MV& inMV, int curPOC, int curRefPOC, int colPOC, int colRefPOC) const;
+
 protected:
 
     template<typename T>
@@ -309,8 +318,6 @@ protected:
     bool getColMVP(MV& outMV, int& outRefIdx, int picList, int cuAddr, int absPartIdx) const;
     bool getCollocatedMV(int cuAddr, int partUnitIdx, InterNeighbourMV *neighbour) const;
 
-    MV scaleMvByPOCDist(const MV& inMV, int curPOC, int curRefPOC, int colPOC, int colRefPOC) const;
-
     void     deriveLeftRightTopIdx(uint32_t puIdx, uint32_t& partIdxLT, uint32_t& partIdxRT) const;
 
     uint32_t deriveCenterIdx(uint32_t puIdx) const;
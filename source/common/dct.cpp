@@ -741,6 +741,54 @@ uint32_t copy_count(int16_t* coeff, const int16_t* residual, intptr_t resiStride
     return numSig;
 }
 
+/* RDOQ distortion of leaving the 16 coefficients of the 4x4 group at blkPos
+ * uncoded, scaled to the FIX15 CABAC rate units. Each cost is stored and also
+ * summed into both the uncoded and the running RD cost of the block */
+template<int log2TrSize>
+static void nonPsyRdoQuant_c(const int16_t* resiDctCoeff, int64_t* costUncoded, int64_t* totalUncodedCost, int64_t* totalRdCost, uint32_t blkPos)
+{
+    const int transformShift = MAX_TR_DYNAMIC_RANGE - X265_DEPTH - log2TrSize;
+    const int scaleBits = SCALE_BITS - 2 * transformShift;
+    const uint32_t trSize = 1 << log2TrSize;
+
+    for (int y = 0; y < MLS_CG_SIZE; y++)
+    {
+        for (int x = 0; x < MLS_CG_SIZE; x++)
+        {
+            int signCoef = resiDctCoeff[blkPos + x];
+            costUncoded[blkPos + x] = ((int64_t)signCoef * signCoef) << scaleBits;
+            *totalUncodedCost += costUncoded[blkPos + x];
+            *totalRdCost += costUncoded[blkPos + x];
+        }
+        blkPos += trSize;
+    }
+}
+
+/* psy-rdoq variant, when nothing is coded the predicted coefficient is the
+ * reconstructed one and its energy is credited against the distortion */
+template<int log2TrSize>
+static void psyRdoQuant_c(const int16_t* resiDctCoeff, const int16_t* fencDctCoeff, int64_t* costUncoded, int64_t* totalUncodedCost, int64_t* totalRdCost, int64_t psyScale, uint32_t blkPos)
+{
+    const int transformShift = MAX_TR_DYNAMIC_RANGE - X265_DEPTH - log2TrSize;
+    const int scaleBits = SCALE_BITS - 2 * transformShift;
+    const int psyShift = X265_MAX(0, 2 * transformShift + 1);
+    const uint32_t trSize = 1 << log2TrSize;
+
+    for (int y = 0; y < MLS_CG_SIZE; y++)
+    {
+        for (int x = 0; x < MLS_CG_SIZE; x++)
+        {
+            int signCoef = resiDctCoeff[blkPos + x];
+            int predictedCoef = fencDctCoeff[blkPos + x] - signCoef;
+            costUncoded[blkPos + x] = ((int64_t)signCoef * signCoef) << scaleBits;
+            costUncoded[blkPos + x] -= (psyScale * predictedCoef) >> psyShift;
+            *totalUncodedCost += costUncoded[blkPos + x];
+            *totalRdCost += costUncoded[blkPos + x];
+        }
+        blkPos += trSize;
+    }
+}
+
 static void denoiseDct_c(int16_t* dctCoef, uint32_t* resSum, const uint16_t* offset, int numCoeff)
 {
     for (int i = 0; i < numCoeff; i++)
@@ -1014,6 +1062,15 @@ void setupDCTPrimitives_c(EncoderPrimitives& p)
     p.cu[BLOCK_16x16].copy_cnt = copy_count<16>;
     p.cu[BLOCK_32x32].copy_cnt = copy_count<32>;
 
+    p.cu[BLOCK_4x4].nonPsyRdoQuant   = nonPsyRdoQuant_c<2>;
+    p.cu[BLOCK_8x8].nonPsyRdoQuant   = nonPsyRdoQuant_c<3>;
+    p.cu[BLOCK_16x16].nonPsyRdoQuant = nonPsyRdoQuant_c<4>;
+    p.cu[BLOCK_32x32].nonPsyRdoQuant = nonPsyRdoQuant_c<5>;
+    p.cu[BLOCK_4x4].psyRdoQuant   = psyRdoQuant_c<2>;
+    p.cu[BLOCK_8x8].psyRdoQuant   = psyRdoQuant_c<3>;
+    p.cu[BLOCK_16x16].psyRdoQuant = psyRdoQuant_c<4>;
+    p.cu[BLOCK_32x32].psyRdoQuant = psyRdoQuant_c<5>;
+
     p.scanPosLast = scanPosLast_c;
     p.findPosFirstLast = findPosFirstLast_c;
     p.costCoeffNxN = costCoeffNxN_c;
@@ -40,9 +40,34 @@ void Deblock::deblockCTU(const CUData* ctu, const CUGeom& cuGeom, int32_t dir)
 
     memset(blockStrength, 0, sizeof(uint8_t) * cuGeom.numPartitions);
 
+    /* each CU marks the edges of its own partitions only, so the boundary
+     * strengths of the whole CTU can be derived before any edge is filtered */
+    setEdgefilterCU(ctu, cuGeom, dir, blockStrength);
+    setBoundaryStrength(ctu, dir, cuGeom.numPartitions, blockStrength);
+
     deblockCU(ctu, cuGeom, dir, blockStrength);
 }
 
+/* The CTUs of other tiles are withheld from prediction, but the loop filters
+ * cross tile boundaries. Slice boundaries are not crossed */
+static inline const CUData* getEdgeNeighbor(const CUData* cuQ, uint32_t& partP, uint32_t partQ, int32_t dir)
+{
+    if (dir == Deblock::EDGE_VER)
+    {
+        const CUData* cuP = cuQ->getPULeft(partP, partQ);
+        if (!cuP && cuQ->m_bFirstColInTile && cuQ->m_cuPelX)
+            cuP = cuQ->m_encData->getPicCTU(cuQ->m_cuAddr - 1);
+        return cuP;
+    }
+    else
+    {
+        const CUData* cuP = cuQ->getPUAbove(partP, partQ);
+        if (!cuP && cuQ->m_bFirstRowInTile && !cuQ->m_bFirstRowInSlice)
+            cuP = cuQ->m_encData->getPicCTU(cuQ->m_cuAddr - cuQ->m_slice->m_sps->numCuInWidth);
+        return cuP;
+    }
+}
+
 static inline uint8_t bsCuEdge(const CUData* cu, uint32_t absPartIdx, int32_t dir)
 {
     if (dir == Deblock::EDGE_VER)
@@ -50,7 +75,7 @@ static inline uint8_t bsCuEdge(const CUData* cu, uint32_t absPartIdx, int32_t di
         if (cu->m_cuPelX + g_zscanToPelX[absPartIdx] > 0)
         {
             uint32_t    tempPartIdx;
-            const CUData* tempCU = cu->getPULeft(tempPartIdx, absPartIdx);
+            const CUData* tempCU = getEdgeNeighbor(cu, tempPartIdx, absPartIdx, dir);
             return tempCU ? 2 : 0;
         }
     }
@@ -59,7 +84,7 @@ static inline uint8_t bsCuEdge(const CUData* cu, uint32_t absPartIdx, int32_t di
         if (cu->m_cuPelY + g_zscanToPelY[absPartIdx] > 0)
         {
             uint32_t    tempPartIdx;
-            const CUData* tempCU = cu->getPUAbove(tempPartIdx, absPartIdx);
+            const CUData* tempCU = getEdgeNeighbor(cu, tempPartIdx, absPartIdx, dir);
             return tempCU ? 2 : 0;
         }
     }
@@ -67,9 +92,8 @@ static inline uint8_t bsCuEdge(const CUData* cu, uint32_t absPartIdx, int32_t di
     return 0;
 }
 
-/* Deblocking filter process in CU-based (the same function as conventional's)
- * param Edge the direction of the edge in block boundary (horizonta/vertical), which is added newly */
-void Deblock::deblockCU(const CUData* cu, const CUGeom& cuGeom, const int32_t dir, uint8_t blockStrength[])
+/* Marks the TU, PU and CU edges of the leaf CUs in direction dir */
+void Deblock::setEdgefilterCU(const CUData* cu, const CUGeom& cuGeom, const int32_t dir, uint8_t blockStrength[])
 {
     uint32_t absPartIdx = cuGeom.absPartIdx;
     uint32_t depth = cuGeom.depth;
@@ -82,7 +106,7 @@ void Deblock::deblockCU(const CUData* cu, const CUGeom& cuGeom, const int32_t di
         {
             const CUGeom& childGeom = *(&cuGeom + cuGeom.childOffset + subPartIdx);
             if (childGeom.flags & CUGeom::PRESENT)
-                deblockCU(cu, childGeom, dir, blockStrength);
+                setEdgefilterCU(cu, childGeom, dir, blockStrength);
         }
         return;
     }
@@ -91,16 +115,29 @@ void Deblock::deblockCU(const CUData* cu, const CUGeom& cuGeom, const int32_t di
     setEdgefilterPU(cu, absPartIdx, dir, blockStrength, numUnits);
     setEdgefilterTU(cu, absPartIdx, 0, dir, blockStrength);
     setEdgefilterMultiple(cu, absPartIdx, dir, 0, bsCuEdge(cu, absPartIdx, dir), blockStrength, numUnits);
+}
 
-    uint32_t numParts = cuGeom.numPartitions;
-    for (uint32_t partIdx = absPartIdx; partIdx < absPartIdx + numParts; partIdx++)
-    {
-        uint32_t bsCheck = !(partIdx & (1 << dir));
+/* Deblocking filter process in CU-based (the same function as conventional's)
+ * param Edge the direction of the edge in block boundary (horizonta/vertical), which is added newly */
+void Deblock::deblockCU(const CUData* cu, const CUGeom& cuGeom, const int32_t dir, const uint8_t blockStrength[])
+{
+    uint32_t absPartIdx = cuGeom.absPartIdx;
+    uint32_t depth = cuGeom.depth;
+    if (cu->m_predMode[absPartIdx] == MODE_NONE)
+        return;
 
-        if (bsCheck && blockStrength[partIdx])
-            blockStrength[partIdx] = getBoundaryStrength(cu, dir, partIdx, blockStrength);
+    if (cu->m_cuDepth[absPartIdx] > depth)
+    {
+        for (uint32_t subPartIdx = 0; subPartIdx < 4; subPartIdx++)
+        {
+            const CUGeom& childGeom = *(&cuGeom + cuGeom.childOffset + subPartIdx);
+            if (childGeom.flags & CUGeom::PRESENT)
+                deblockCU(cu, childGeom, dir, blockStrength);
+        }
+        return;
     }
 
+    uint32_t numUnits = 1 << (cuGeom.log2CUSize - LOG2_UNIT_SIZE);
     const uint32_t partIdxIncr = DEBLOCK_SMALLEST_BLOCK >> LOG2_UNIT_SIZE;
     uint32_t shiftFactor = (dir == EDGE_VER) ? cu->m_hChromaShift : cu->m_vChromaShift;
     uint32_t chromaMask = ((DEBLOCK_SMALLEST_BLOCK << shiftFactor) >> LOG2_UNIT_SIZE) - 1;
@@ -190,65 +227,63 @@ void Deblock::setEdgefilterPU(const CUData* cu, uint32_t absPartIdx, int32_t dir
     }
 }
 
-uint8_t Deblock::getBoundaryStrength(const CUData* cuQ, int32_t dir, uint32_t partQ, const uint8_t blockStrength[])
+/* Identity of the reference picture of a list as compared by the boundary
+ * strength. An unused list 0 and an unused list 1 never match each other, and
+ * only an unused list 1 has its motion vector ignored */
+static inline int32_t refIdentity(const CUData* cu, int list, uint32_t absPartIdx)
 {
-    // Calculate block index
-    uint32_t partP;
-    const CUData* cuP = (dir == EDGE_VER ? cuQ->getPULeft(partP, partQ) : cuQ->getPUAbove(partP, partQ));
-
-    // Set BS for Intra MB : BS = 2
-    if (cuP->isIntra(partP) || cuQ->isIntra(partQ))
-        return 2;
-
-    // Set BS for not Intra MB : BS = 1 or 0
-    if (blockStrength[partQ] > 1 &&
-        (cuQ->getCbf(partQ, TEXT_LUMA, cuQ->m_tuDepth[partQ]) ||
-         cuP->getCbf(partP, TEXT_LUMA, cuP->m_tuDepth[partP])))
-        return 1;
-
-    static const MV zeroMv(0, 0);
-    const Slice* const sliceQ = cuQ->m_slice;
-    const Slice* const sliceP = cuP->m_slice;
-
-    const Frame* refP0 = sliceP->m_refFrameList[0][cuP->m_refIdx[0][partP]];
-    const Frame* refQ0 = sliceQ->m_refFrameList[0][cuQ->m_refIdx[0][partQ]];
-    const MV& mvP0 = refP0 ? cuP->m_mv[0][partP] : zeroMv;
-    const MV& mvQ0 = refQ0 ? cuQ->m_mv[0][partQ] : zeroMv;
-
-    if (sliceQ->isInterP() && sliceP->isInterP())
+    int refIdx = cu->m_refIdx[list][absPartIdx];
+    return refIdx >= 0 ? cu->m_slice->m_refPOCList[list][refIdx] : -1 - list;
+}
+
+void Deblock::setBoundaryStrength(const CUData* cuQ, int32_t dir, uint32_t numParts, uint8_t blockStrength[])
+{
+    /* edges between inter blocks with no coded residual are decided by their
+     * motion, these are gathered and compared in one call */
+    ALIGN_VAR_16(int32_t, refs[4][MAX_NUM_PARTITIONS / 2]);
+    ALIGN_VAR_16(int32_t, mvs[4][MAX_NUM_PARTITIONS / 2]);
+    uint8_t partIdx[MAX_NUM_PARTITIONS / 2];
+    uint8_t motionBs[MAX_NUM_PARTITIONS / 2];
+    int count = 0;
+
+    for (uint32_t partQ = 0; partQ < numParts; partQ++)
     {
-        return ((refP0 != refQ0) ||
-                (abs(mvQ0.x - mvP0.x) >= 4) || (abs(mvQ0.y - mvP0.y) >= 4)) ? 1 : 0;
-    }
+        if ((partQ & (1 << dir)) || !blockStrength[partQ])
+            continue;
 
-    // (sliceQ->isInterB() || sliceP->isInterB())
-    const Frame* refP1 = sliceP->m_refFrameList[1][cuP->m_refIdx[1][partP]];
-    const Frame* refQ1 = sliceQ->m_refFrameList[1][cuQ->m_refIdx[1][partQ]];
-    const MV& mvP1 = refP1 ? cuP->m_mv[1][partP] : zeroMv;
-    const MV& mvQ1 = refQ1 ? cuQ->m_mv[1][partQ] : zeroMv;
+        uint32_t partP;
+        const CUData* cuP = getEdgeNeighbor(cuQ, partP, partQ, dir);
 
-    if (((refP0 == refQ0) && (refP1 == refQ1)) || ((refP0 == refQ1) && (refP1 == refQ0)))
-    {
-        if (refP0 != refP1) // Different L0 & L1
-        {
-            if (refP0 == refQ0)
-                return ((abs(mvQ0.x - mvP0.x) >= 4) || (abs(mvQ0.y - mvP0.y) >= 4) ||
-                        (abs(mvQ1.x - mvP1.x) >= 4) || (abs(mvQ1.y - mvP1.y) >= 4)) ? 1 : 0;
-            else
-                return ((abs(mvQ1.x - mvP0.x) >= 4) || (abs(mvQ1.y - mvP0.y) >= 4) ||
-                        (abs(mvQ0.x - mvP1.x) >= 4) || (abs(mvQ0.y - mvP1.y) >= 4)) ? 1 : 0;
-        }
-        else // Same L0 & L1
+        // Set BS for Intra MB : BS = 2
+        if (cuP->isIntra(partP) || cuQ->isIntra(partQ))
+            blockStrength[partQ] = 2;
+
+        // Set BS for not Intra MB : BS = 1 or 0
+        else if (blockStrength[partQ] > 1 &&
+                 (cuQ->getCbf(partQ, TEXT_LUMA, cuQ->m_tuDepth[partQ]) ||
+                  cuP->getCbf(partP, TEXT_LUMA, cuP->m_tuDepth[partP])))
+            blockStrength[partQ] = 1;
+
+        else
         {
-            return (((abs(mvQ0.x - mvP0.x) >= 4) || (abs(mvQ0.y - mvP0.y) >= 4) ||
-                     (abs(mvQ1.x - mvP1.x) >= 4) || (abs(mvQ1.y - mvP1.y) >= 4)) &&
-                    ((abs(mvQ1.x - mvP0.x) >= 4) || (abs(mvQ1.y - mvP0.y) >= 4) ||
-                     (abs(mvQ0.x - mvP1.x) >= 4) || (abs(mvQ0.y - mvP1.y) >= 4))) ? 1 : 0;
+            refs[0][count] = refIdentity(cuP, 0, partP);
+            refs[1][count] = refIdentity(cuP, 1, partP);
+            refs[2][count] = refIdentity(cuQ, 0, partQ);
+            refs[3][count] = refIdentity(cuQ, 1, partQ);
+            mvs[0][count] = cuP->m_mv[0][partP].word;
+            mvs[1][count] = refs[1][count] >= 0 ? cuP->m_mv[1][partP].word : 0;
+            mvs[2][count] = cuQ->m_mv[0][partQ].word;
+            mvs[3][count] = refs[3][count] >= 0 ? cuQ->m_mv[1][partQ].word : 0;
+            partIdx[count++] = (uint8_t)partQ;
         }
     }
-        
-    // for all different Ref_Idx
-    return 1;
+
+    if (count)
+    {
+        primitives.boundaryStrength(refs[0], mvs[0], MAX_NUM_PARTITIONS / 2, motionBs, count);
+        for (int i = 0; i < count; i++)
+            blockStrength[partIdx[i]] = motionBs[i];
+    }
 }
 
 static inline int32_t calcDP(pixel* src, intptr_t offset)
@@ -347,18 +382,27 @@ void Deblock::edgeFilterLuma(const CUData* cuQ, uint32_t absPartIdx, uint32_t de
         src += (edge << LOG2_UNIT_SIZE) * stride;
     }
 
+    /* the parameters of all units of the edge are derived first, a unit with
+     * a zero tc is not filtered */
+    int32_t tcs[MAX_CU_SIZE >> LOG2_UNIT_SIZE];
+    int32_t betas[MAX_CU_SIZE >> LOG2_UNIT_SIZE];
+    int32_t masksP[MAX_CU_SIZE >> LOG2_UNIT_SIZE];
+    int32_t masksQ[MAX_CU_SIZE >> LOG2_UNIT_SIZE];
+    bool bFilter = false;
+
     uint32_t numUnits = cuQ->m_slice->m_sps->numPartInCUSize >> depth;
     for (uint32_t idx = 0; idx < numUnits; idx++)
     {
         uint32_t partQ = calcBsIdx(cuQ, absPartIdx, dir, edge, idx);
         uint32_t bs = blockStrength[partQ];
 
+        tcs[idx] = 0;
         if (!bs)
             continue;
 
         // Derive neighboring PU index
         uint32_t partP;
-        const CUData* cuP = (dir == EDGE_VER ? cuQ->getPULeft(partP, partQ) : cuQ->getPUAbove(partP, partQ));
+        const CUData* cuP = getEdgeNeighbor(cuQ, partP, partQ, dir);
 
         if (bCheckNoFilter)
         {
@@ -376,8 +420,31 @@ void Deblock::edgeFilterLuma(const CUData* cuQ, uint32_t absPartIdx, uint32_t de
         int32_t indexB = x265_clip3(0, QP_MAX_SPEC, qp + betaOffset);
 
         const int32_t bitdepthShift = X265_DEPTH - 8;
-        int32_t beta = s_betaTable[indexB] << bitdepthShift;
+        int32_t indexTC = x265_clip3(0, QP_MAX_SPEC + DEFAULT_INTRA_TC_OFFSET, int32_t(qp + DEFAULT_INTRA_TC_OFFSET * (bs - 1) + tcOffset));
+
+        tcs[idx] = s_tcTable[indexTC] << bitdepthShift;
+        betas[idx] = s_betaTable[indexB] << bitdepthShift;
+        masksP[idx] = maskP;
+        masksQ[idx] = maskQ;
+        bFilter |= !!tcs[idx];
+    }
+
+    if (!bFilter)
+        return;
+
+    if (primitives.pelFilterLumaEdge[dir])
+    {
+        primitives.pelFilterLumaEdge[dir](src, srcStep, offset, tcs, betas, masksP, masksQ, numUnits);
+        return;
+    }
+
+    for (uint32_t idx = 0; idx < numUnits; idx++)
+    {
+        int32_t tc = tcs[idx];
+        if (!tc)
+            continue;
 
+        int32_t beta = betas[idx];
         intptr_t unitOffset = idx * srcStep << LOG2_UNIT_SIZE;
         int32_t dp0 = calcDP(src + unitOffset              , offset);
         int32_t dq0 = calcDQ(src + unitOffset              , offset);
@@ -391,9 +458,6 @@ void Deblock::edgeFilterLuma(const CUData* cuQ, uint32_t absPartIdx, uint32_t de
         if (d >= beta)
             continue;
 
-        int32_t indexTC = x265_clip3(0, QP_MAX_SPEC + DEFAULT_INTRA_TC_OFFSET, int32_t(qp + DEFAULT_INTRA_TC_OFFSET * (bs - 1) + tcOffset));
-        int32_t tc = s_tcTable[indexTC] << bitdepthShift;
-
         bool sw = (2 * d0 < (beta >> 2) &&
                    2 * d3 < (beta >> 2) &&
                    useStrongFiltering(offset, beta, tc, src + unitOffset              ) &&
@@ -402,8 +466,8 @@ void Deblock::edgeFilterLuma(const CUData* cuQ, uint32_t absPartIdx, uint32_t de
         if (sw)
         {
             int32_t tc2 = 2 * tc;
-            int32_t tcP = (tc2 & maskP);
-            int32_t tcQ = (tc2 & maskQ);
+            int32_t tcP = (tc2 & masksP[idx]);
+            int32_t tcQ = (tc2 & masksQ[idx]);
             primitives.pelFilterLumaStrong[dir](src + unitOffset, srcStep, offset, tcP, tcQ);
         }
         else
@@ -414,7 +478,7 @@ void Deblock::edgeFilterLuma(const CUData* cuQ, uint32_t absPartIdx, uint32_t de
             int32_t maskP1 = (dp < sideThreshold ? -1 : 0);
             int32_t maskQ1 = (dq < sideThreshold ? -1 : 0);
 
-            pelFilterLuma(src + unitOffset, srcStep, offset, tc, maskP, maskQ, maskP1, maskQ1);
+            pelFilterLuma(src + unitOffset, srcStep, offset, tc, masksP[idx], masksQ[idx], maskP1, maskQ1);
         }
     }
 }
@@ -469,7 +533,7 @@ void Deblock::edgeFilterChroma(const CUData* cuQ, uint32_t absPartIdx, uint32_t
 
         // Derive neighboring PU index
         uint32_t partP;
-        const CUData* cuP = (dir == EDGE_VER ? cuQ->getPULeft(partP, partQ) : cuQ->getPUAbove(partP, partQ));
+        const CUData* cuP = getEdgeNeighbor(cuQ, partP, partQ, dir);
 
         if (bCheckNoFilter)
         {
@@ -31,6 +31,7 @@ using namespace X265_NS;
 Frame::Frame()
 {
     m_bChromaExtended = false;
+    m_bDuplicate = false;
     m_lowresInit = false;
     m_reconRowCount.set(0);
     m_reconColCount = NULL;
@@ -144,5 +145,83 @@ void Frame::destroy()
     }
 
     m_lowres.destroy();
+    m_analysisHints.destroy();
     X265_FREE(m_rcData);
 }
+
+bool AnalysisHints::create(uint32_t numCUsInFrame, uint32_t numPartsPerCTU)
+{
+    uint32_t count = numCUsInFrame * numPartsPerCTU;
+    numPartitions = numPartsPerCTU;
+    bValid = false;
+
+    CHECKED_MALLOC(depth, uint8_t, count);
+    CHECKED_MALLOC(predMode, uint8_t, count);
+    CHECKED_MALLOC(lumaIntraDir, uint8_t, count);
+    for (int l = 0; l < 2; l++)
+    {
+        CHECKED_MALLOC_ZERO(mv[l], MV, count);
+        CHECKED_MALLOC(refIdx[l], int8_t, count);
+    }
+    return true;
+
+fail:
+    destroy();
+    return false;
+}
+
+void AnalysisHints::destroy()
+{
+    X265_FREE(depth);
+    X265_FREE(predMode);
+    X265_FREE(lumaIntraDir);
+    for (int l = 0; l < 2; l++)
+    {
+        X265_FREE(mv[l]);
+        X265_FREE(refIdx[l]);
+    }
+    memset(this, 0, sizeof(*this));
+}
+
+/* Each destination 4x4 partition takes the decisions of the source partition
+ * covering its centre. CU depths are offset by the log2 of the scale factor
+ * so the mapped CUs cover roughly the same picture area, and MVs are scaled
+ * by the picture size ratio */
+void AnalysisHints::scale(const AnalysisHints& src, uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight)
+{
+    int depthOffset = (int)floor(log2((double)srcWidth / dstWidth) + 0.5);
+    uint32_t srcWidthInCU = (srcWidth + g_maxCUSize - 1) >> g_maxLog2CUSize;
+    uint32_t dstWidthInCU = (dstWidth + g_maxCUSize - 1) >> g_maxLog2CUSize;
+    uint32_t dstNumCUs = dstWidthInCU * ((dstHeight + g_maxCUSize - 1) >> g_maxLog2CUSize);
+    uint32_t ctuMask = g_maxCUSize - 1;
+    uint32_t numPartInCUSize = g_maxCUSize >> LOG2_UNIT_SIZE;
+
+    for (uint32_t cuAddr = 0; cuAddr < dstNumCUs; cuAddr++)
+    {
+        uint32_t ctuX = (cuAddr % dstWidthInCU) << g_maxLog2CUSize;
+        uint32_t ctuY = (cuAddr / dstWidthInCU) << g_maxLog2CUSize;
+        uint32_t base = cuAddr * numPartitions;
+
+        for (uint32_t i = 0; i < numPartitions; i++)
+        {
+            uint32_t x = ctuX + g_zscanToPelX[i] + 2;
+            uint32_t y = ctuY + g_zscanToPelY[i] + 2;
+            uint32_t sx = X265_MIN((uint32_t)((uint64_t)x * srcWidth / dstWidth), srcWidth - 1);
+            uint32_t sy = X265_MIN((uint32_t)((uint64_t)y * srcHeight / dstHeight), srcHeight - 1);
+            uint32_t srcAddr = (sy >> g_maxLog2CUSize) * srcWidthInCU + (sx >> g_maxLog2CUSize);
+            uint32_t srcIdx = srcAddr * src.numPartitions +
+                              g_rasterToZscan[((sy & ctuMask) >> LOG2_UNIT_SIZE) * numPartInCUSize + ((sx & ctuMask) >> LOG2_UNIT_SIZE)];
+
+            depth[base + i] = (uint8_t)x265_clip3(0, (int)g_maxCUDepth, src.depth[srcIdx] + depthOffset);
+            predMode[base + i] = src.predMode[srcIdx];
+            lumaIntraDir[base + i] = src.lumaIntraDir[srcIdx];
+            for (int l = 0; l < 2; l++)
+            {
+                const MV& srcMv = src.mv[l][srcIdx];
+                mv[l][base + i] = MV((int16_t)(srcMv.x * (int)dstWidth / (int)srcWidth),
+                                     (int16_t)(srcMv.y * (int)dstHeight / (int)srcHeight));
+                refIdx[l][base + i] = src.refIdx[l][srcIdx];
+            }
+        }
+    }
+}
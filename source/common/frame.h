@@ -58,6 +58,29 @@ struct RcStats
     int      keptAsRef;
 };
 
+/* CU decisions made for this picture by another encode of the same content,
+ * possibly at a different resolution, mapped onto this encode's CTU grid
+ * (one entry per 4x4 partition in CTU z-order). They seed and limit the CU
+ * analysis but do not force its decisions */
+struct AnalysisHints
+{
+    uint8_t* depth;
+    uint8_t* predMode;
+    uint8_t* lumaIntraDir;       // ALL_IDX where unknown
+    MV*      mv[2];
+    int8_t*  refIdx[2];
+    uint32_t numPartitions;      // partitions per CTU
+    bool     bValid;             // hints are available for the current picture
+
+    AnalysisHints() { memset(this, 0, sizeof(*this)); }
+
+    bool create(uint32_t numCUsInFrame, uint32_t numPartsPerCTU);
+    void destroy();
+
+    /* map the hints of a picture of another size onto this CTU grid */
+    void scale(const AnalysisHints& src, uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight);
+};
+
 class Frame
 {
 public:
@@ -80,6 +103,7 @@ public:
     Lowres                 m_lowres;
     bool                   m_lowresInit;         // lowres init complete (pre-analysis)
     bool                   m_bChromaExtended;    // orig chroma planes motion extended for weight analysis
+    bool                   m_bDuplicate;         // source identical to that of L0[0] (--static-skip)
 
     float*                 m_quantOffsets;       // points to quantOffsets in x265_picture
 
@@ -93,6 +117,7 @@ public:
     Frame*                 m_prev;
     x265_param*            m_param;              // Points to the latest param set for the frame.
     x265_analysis_data     m_analysisData;
+    AnalysisHints          m_analysisHints;
     RcStats*               m_rcData;
     Frame();
 
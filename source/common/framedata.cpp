@@ -67,4 +67,10 @@ void FrameData::destroy()
 
     X265_FREE(m_cuStat);
     X265_FREE(m_rowStat);
+
+    if (m_blockHash)
+    {
+        m_blockHash->destroy();
+        delete m_blockHash;
+    }
 }
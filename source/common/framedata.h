@@ -27,6 +27,7 @@
 #include "common.h"
 #include "slice.h"
 #include "cudata.h"
+#include "blockhash.h"
 
 namespace X265_NS {
 // private namespace
@@ -61,6 +62,7 @@ struct FrameStats
     double      percentMergeCu[NUM_CU_DEPTH];
     double      percentIntraDistribution[NUM_CU_DEPTH][INTRA_MODES];
     double      percentInterDistribution[NUM_CU_DEPTH][3];           // 2Nx2N, RECT, AMP modes percentage
+    double      percentDegradedCtu;                                  // CTUs analyzed at reduced effort (frame budget)
 
     uint64_t    cntIntraNxN;
     uint64_t    totalCu;
@@ -75,6 +77,8 @@ struct FrameStats
     uint64_t    cntIntra[NUM_CU_DEPTH];
     uint64_t    cuInterDistribution[NUM_CU_DEPTH][INTER_MODES];
     uint64_t    cuIntraDistribution[NUM_CU_DEPTH][INTRA_MODES];
+    uint64_t    cntDegradedCtu;
+    int         maxDegradeLevel;
 
     FrameStats()
     {
@@ -148,6 +152,8 @@ public:
     double         m_rateFactor; /* calculated based on the Frame QP */
     int            m_picCsp;
 
+    BlockHash*     m_blockHash;  /* hash of the source blocks of a referenced picture, for --hash-me */
+
     FrameData();
 
     bool create(const x265_param& param, const SPS& sps, int csp);
@@ -168,7 +174,8 @@ struct analysis_intra_data
 /* Stores inter analysis data for a single frame */
 struct analysis_inter_data
 {
-    MV*         mv;
+    MV*         mv[2];
+    int8_t*     refIdx[2];
     WeightParam* wt;
     int32_t*    ref;
     uint8_t*    depth;
@@ -178,6 +178,105 @@ static void pelFilterChroma_c(pixel* src, intptr_t srcStep, intptr_t offset, int
         src[0]        = x265_clip(m4 - (delta & maskQ));
     }
 }
+
+/* Deblocking of consecutive 4-line units of a luma edge, with the filter
+ * decisions of each unit made on its first and last line
+ * \param tc      tc value per unit, 0 for a unit left as is
+ * \param beta    beta value per unit
+ * \param maskP   indicator to disable filtering on partP, per unit
+ * \param maskQ   indicator to disable filtering on partQ, per unit */
+static void pelFilterLumaEdge_c(pixel* src, intptr_t srcStep, intptr_t offset, const int32_t* tc, const int32_t* beta,
+                                const int32_t* maskP, const int32_t* maskQ, int count)
+{
+    for (int unit = 0; unit < count; unit++, src += srcStep << LOG2_UNIT_SIZE)
+    {
+        if (!tc[unit])
+            continue;
+
+        int32_t dp[2], dq[2], strong[2];
+        for (int i = 0; i < 2; i++)
+        {
+            const pixel* line = src + srcStep * 3 * i;
+            dp[i] = abs(line[-offset * 3] - 2 * line[-offset * 2] + line[-offset]);
+            dq[i] = abs(line[0] - 2 * line[offset] + line[offset * 2]);
+            strong[i] = abs(line[-offset * 4] - line[-offset]) + abs(line[offset * 3] - line[0]) < (beta[unit] >> 3) &&
+                        abs(line[-offset] - line[0]) < ((tc[unit] * 5 + 1) >> 1) &&
+                        2 * (dp[i] + dq[i]) < (beta[unit] >> 2);
+        }
+
+        if (dp[0] + dq[0] + dp[1] + dq[1] >= beta[unit])
+            continue;
+
+        if (strong[0] && strong[1])
+        {
+            pelFilterLumaStrong_c(src, srcStep, offset, 2 * tc[unit] & maskP[unit], 2 * tc[unit] & maskQ[unit]);
+            continue;
+        }
+
+        int32_t sideThreshold = (beta[unit] + (beta[unit] >> 1)) >> 3;
+        int32_t maskP1 = dp[0] + dp[1] < sideThreshold ? maskP[unit] : 0;
+        int32_t maskQ1 = dq[0] + dq[1] < sideThreshold ? maskQ[unit] : 0;
+        int32_t tcUnit = tc[unit];
+        int32_t tc2 = tcUnit >> 1;
+
+        pixel* line = src;
+        for (int32_t i = 0; i < UNIT_SIZE; i++, line += srcStep)
+        {
+            int16_t m4 = (int16_t)line[0];
+            int16_t m3 = (int16_t)line[-offset];
+            int16_t m5 = (int16_t)line[offset];
+            int16_t m2 = (int16_t)line[-offset * 2];
+
+            int32_t delta = (9 * (m4 - m3) - 3 * (m5 - m2) + 8) >> 4;
+            if (abs(delta) >= tcUnit * 10)
+                continue;
+
+            delta = x265_clip3(-tcUnit, tcUnit, delta);
+            line[-offset] = x265_clip(m3 + (delta & maskP[unit]));
+            line[0] = x265_clip(m4 - (delta & maskQ[unit]));
+            if (maskP1)
+            {
+                int16_t m1 = (int16_t)line[-offset * 3];
+                line[-offset * 2] = x265_clip(m2 + x265_clip3(-tc2, tc2, (((m1 + m3 + 1) >> 1) - m2 + delta) >> 1));
+            }
+            if (maskQ1)
+            {
+                int16_t m6 = (int16_t)line[offset * 2];
+                line[offset] = x265_clip(m5 + x265_clip3(-tc2, tc2, (((m6 + m4 + 1) >> 1) - m5 - delta) >> 1));
+            }
+        }
+    }
+}
+
+/* MV words differing by 4 quarter pels or more in x or y */
+static inline bool mvDiffers(int32_t a, int32_t b)
+{
+    return abs((int16_t)a - (int16_t)b) >= 4 || abs((a >> 16) - (b >> 16)) >= 4;
+}
+
+static void boundaryStrength_c(const int32_t* refs, const int32_t* mvs, intptr_t stride, uint8_t* bs, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int32_t refP0 = refs[i], refP1 = refs[stride + i], refQ0 = refs[2 * stride + i], refQ1 = refs[3 * stride + i];
+        int32_t mvP0 = mvs[i], mvP1 = mvs[stride + i], mvQ0 = mvs[2 * stride + i], mvQ1 = mvs[3 * stride + i];
+
+        bool sameDirect = refP0 == refQ0 && refP1 == refQ1;
+        bool sameCross = refP0 == refQ1 && refP1 == refQ0;
+        if (!sameDirect && !sameCross)
+        {
+            bs[i] = 1;
+            continue;
+        }
+
+        bool direct = mvDiffers(mvQ0, mvP0) || mvDiffers(mvQ1, mvP1);
+        bool cross = mvDiffers(mvQ1, mvP0) || mvDiffers(mvQ0, mvP1);
+        if (refP0 != refP1) // Different L0 & L1
+            bs[i] = sameDirect ? direct : cross;
+        else // Same L0 & L1
+            bs[i] = direct && cross;
+    }
+}
 }
 
 namespace X265_NS {
@@ -198,5 +297,8 @@ void setupLoopFilterPrimitives_c(EncoderPrimitives &p)
     p.pelFilterLumaStrong[1] = pelFilterLumaStrong_c;
     p.pelFilterChroma[0]     = pelFilterChroma_c;
     p.pelFilterChroma[1]     = pelFilterChroma_c;
+    p.pelFilterLumaEdge[0]   = pelFilterLumaEdge_c;
+    p.pelFilterLumaEdge[1]   = pelFilterLumaEdge_c;
+    p.boundaryStrength       = boundaryStrength_c;
 }
 }
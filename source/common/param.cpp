@@ -107,6 +107,12 @@ void x265_param_default(x265_param* param)
     param->cpuid = X265_NS::cpu_detect();
     param->bEnableWavefront = 1;
     param->frameNumThreads = 0;
+    param->maxSlices = 1;
+    param->numTileColumns = 1;
+    param->numTileRows = 1;
+    param->frameBudget = 0;
+    param->targetFps = 0;
+    param->pmodeMinSize = 16;
 
     param->logLevel = X265_LOG_INFO;
     param->csvfn = NULL;
@@ -117,6 +123,7 @@ void x265_param_default(x265_param* param)
     /* Quality Measurement Metrics */
     param->bEnablePsnr = 0;
     param->bEnableSsim = 0;
+    param->bAsyncMetrics = 0;
 
     /* Source specifications */
     param->internalBitDepth = X265_DEPTH;
@@ -161,9 +168,23 @@ void x265_param_default(x265_param* param)
     param->maxNumMergeCand = 2;
     param->limitReferences = 3;
     param->limitModes = 0;
+    param->bEnableRefMVShare = 0;
+    param->cuDepthPredict = 0;
+    param->cuClassify = 0;
+    param->cuClassifyModel = NULL;
+    param->cuClassifyDump = NULL;
     param->bEnableWeightedPred = 1;
     param->bEnableWeightedBiPred = 0;
     param->bEnableEarlySkip = 0;
+    param->bEarlyChromaSkip = 0;
+    param->nalBufferAlloc = NULL;
+    param->nalBufferFree = NULL;
+    param->nalBufferOpaque = NULL;
+    param->nalOutput = NULL;
+    param->nalOutputOpaque = NULL;
+    param->bStaticSkip = 0;
+    param->bHashME = 0;
+    param->bApproxRate = 0;
     param->bEnableRecursionSkip = 1;
     param->bEnableAMP = 0;
     param->bEnableRectInter = 0;
@@ -577,8 +598,14 @@ int x265_param_parse(x265_param* p, const char* name, const char* value)
         }
     }
     OPT("frame-threads") p->frameNumThreads = atoi(value);
+    OPT("slices") p->maxSlices = atoi(value);
+    OPT("tile-columns") p->numTileColumns = atoi(value);
+    OPT("tile-rows") p->numTileRows = atoi(value);
     OPT("pmode") p->bDistributeModeAnalysis = atobool(value);
     OPT("pme") p->bDistributeMotionEstimation = atobool(value);
+    OPT("pmode-min-size") p->pmodeMinSize = atoi(value);
+    OPT("frame-budget") p->frameBudget = atof(value);
+    OPT("target-fps") p->targetFps = atof(value);
     OPT2("level-idc", "level")
     {
         /* allow "5.1" or "51", both converted to integer 51 */
@@ -619,6 +646,9 @@ int x265_param_parse(x265_param* p, const char* name, const char* value)
     OPT("max-merge") p->maxNumMergeCand = (uint32_t)atoi(value);
     OPT("temporal-mvp") p->bEnableTemporalMvp = atobool(value);
     OPT("early-skip") p->bEnableEarlySkip = atobool(value);
+    OPT("early-chroma-skip") p->bEarlyChromaSkip = atobool(value);
+    OPT("static-skip") p->bStaticSkip = atobool(value);
+    OPT("hash-me") p->bHashME = atobool(value);
     OPT("rskip") p->bEnableRecursionSkip = atobool(value);
     OPT("rdpenalty") p->rdPenalty = atoi(value);
     OPT("tskip") p->bEnableTransformSkip = atobool(value);
@@ -668,11 +698,17 @@ int x265_param_parse(x265_param* p, const char* name, const char* value)
     OPT("ref") p->maxNumReferences = atoi(value);
     OPT("limit-refs") p->limitReferences = atoi(value);
     OPT("limit-modes") p->limitModes = atobool(value);
+    OPT("ref-mv-share") p->bEnableRefMVShare = atobool(value);
+    OPT("depth-predict") p->cuDepthPredict = atoi(value);
+    OPT("cu-classify") p->cuClassify = atoi(value);
+    OPT("cu-classify-model") p->cuClassifyModel = strdup(value);
+    OPT("cu-classify-dump") p->cuClassifyDump = strdup(value);
     OPT("weightp") p->bEnableWeightedPred = atobool(value);
     OPT("weightb") p->bEnableWeightedBiPred = atobool(value);
     OPT("cbqpoffs") p->cbQpOffset = atoi(value);
     OPT("crqpoffs") p->crQpOffset = atoi(value);
     OPT("rd") p->rdLevel = atoi(value);
+    OPT("approx-rate") p->bApproxRate = atobool(value);
     OPT2("rdoq", "rdoq-level")
     {
         int bval = atobool(value);
@@ -730,6 +766,7 @@ int x265_param_parse(x265_param* p, const char* name, const char* value)
     OPT("ssim") p->bEnableSsim = atobool(value);
     OPT("psnr") p->bEnablePsnr = atobool(value);
     OPT("hash") p->decodedPictureHashSEI = atoi(value);
+    OPT("async-metrics") p->bAsyncMetrics = atobool(value);
     OPT("aud") p->bEnableAccessUnitDelimiters = atobool(value);
     OPT("info") p->bEmitInfoSEI = atobool(value);
     OPT("b-pyramid") p->bBPyramid = atobool(value);
@@ -1065,10 +1102,30 @@ int x265_check_params(x265_param* param)
           "subme must be greater than or equal to 0");
     CHECK(param->limitReferences > 3,
           "limitReferences must be 0, 1, 2 or 3");
+    CHECK(param->cuDepthPredict < 0 || param->cuDepthPredict > 2,
+          "depth-predict must be 0, 1 or 2");
+    CHECK(param->cuClassify < 0 || param->cuClassify > 2,
+          "cu-classify must be 0, 1 or 2");
     CHECK(param->limitModes > 1,
           "limitRectAmp must be 0, 1");
+    CHECK(param->pmodeMinSize < 8 || param->pmodeMinSize > 64 || (param->pmodeMinSize & (param->pmodeMinSize - 1)),
+          "pmode-min-size must be 8, 16, 32 or 64");
+    CHECK(param->frameBudget < 0,
+          "frame-budget must be positive or 0 (disabled)");
+    CHECK(param->targetFps < 0,
+          "target-fps must be positive or 0 (disabled)");
     CHECK(param->frameNumThreads < 0 || param->frameNumThreads > X265_MAX_FRAME_THREADS,
           "frameNumThreads (--frame-threads) must be [0 .. X265_MAX_FRAME_THREADS)");
+    CHECK(param->maxSlices < 1 || param->maxSlices > X265_MAX_SLICES,
+          "maxSlices (--slices) must be [1 .. X265_MAX_SLICES]");
+    CHECK(param->numTileColumns < 1 || param->numTileColumns > X265_MAX_TILE_COLUMNS,
+          "numTileColumns (--tile-columns) must be [1 .. X265_MAX_TILE_COLUMNS]");
+    CHECK(param->numTileRows < 1 || param->numTileRows > X265_MAX_TILE_ROWS,
+          "numTileRows (--tile-rows) must be [1 .. X265_MAX_TILE_ROWS]");
+    CHECK(param->maxSlices > 1 && param->numTileColumns * param->numTileRows > 1,
+          "--slices cannot be combined with --tile-columns or --tile-rows");
+    CHECK(param->rc.vbvBufferSize > 0 && param->numTileColumns * param->numTileRows > 1,
+          "Tiles (--tile-columns/--tile-rows) cannot be combined with VBV, which requires wavefront parallelism");
     CHECK(param->cbQpOffset < -12, "Min. Chroma Cb QP Offset is -12");
     CHECK(param->cbQpOffset >  12, "Max. Chroma Cb QP Offset is  12");
     CHECK(param->crQpOffset < -12, "Min. Chroma Cr QP Offset is -12");
@@ -1206,6 +1263,8 @@ int x265_check_params(x265_param* param)
           "Constant QP is incompatible with 2pass");
     CHECK(param->rc.bStrictCbr && (param->rc.bitrate <= 0 || param->rc.vbvBufferSize <=0),
           "Strict-cbr cannot be applied without specifying target bitrate or vbv bufsize");
+    CHECK(!param->nalBufferAlloc != !param->nalBufferFree,
+          "nalBufferAlloc and nalBufferFree must be set together");
     CHECK(param->analysisMode && (param->analysisMode < X265_ANALYSIS_OFF || param->analysisMode > X265_ANALYSIS_LOAD),
         "Invalid analysis mode. Analysis mode 0: OFF 1: SAVE : 2 LOAD");
     return check_failed;
@@ -1310,6 +1369,12 @@ void x265_print_params(x265_param* param)
     if (param->rdPenalty)
         x265_log(param, X265_LOG_INFO, "Intra 32x32 TU penalty type         : %d\n", param->rdPenalty);
 
+    if (param->maxSlices > 1)
+        x265_log(param, X265_LOG_INFO, "Slices                              : %d\n", param->maxSlices);
+
+    if (param->numTileColumns * param->numTileRows > 1)
+        x265_log(param, X265_LOG_INFO, "Tile columns / rows                 : %d / %d\n", param->numTileColumns, param->numTileRows);
+
     x265_log(param, X265_LOG_INFO, "Lookahead / bframes / badapt        : %d / %d / %d\n", param->lookaheadDepth, param->bframes, param->bFrameAdaptive);
     x265_log(param, X265_LOG_INFO, "b-pyramid / weightp / weightb       : %d / %d / %d\n",
              param->bBPyramid, param->bEnableWeightedPred, param->bEnableWeightedBiPred);
@@ -1344,12 +1409,21 @@ void x265_print_params(x265_param* param)
     TOOLOPT(param->bEnableRectInter, "rect");
     TOOLOPT(param->bEnableAMP, "amp");
     TOOLOPT(param->limitModes, "limit-modes");
+    TOOLOPT(param->bEnableRefMVShare, "ref-mv-share");
+    TOOLVAL(param->cuDepthPredict, "depth-predict=%d");
+    TOOLVAL(param->cuClassify, "cu-classify=%d");
+    TOOLVAL(param->frameBudget, "frame-budget=%.1lf");
+    TOOLVAL(param->targetFps, "target-fps=%.2lf");
     TOOLVAL(param->rdLevel, "rd=%d");
     TOOLVAL(param->psyRd, "psy-rd=%.2lf");
     TOOLVAL(param->rdoqLevel, "rdoq=%d");
     TOOLVAL(param->psyRdoq, "psy-rdoq=%.2lf");
+    TOOLOPT(param->bApproxRate, "approx-rate");
     TOOLOPT(param->bEnableRdRefine, "rd-refine");
     TOOLOPT(param->bEnableEarlySkip, "early-skip");
+    TOOLOPT(param->bEarlyChromaSkip, "early-chroma-skip");
+    TOOLOPT(param->bStaticSkip, "static-skip");
+    TOOLOPT(param->bHashME, "hash-me");
     TOOLOPT(param->bEnableRecursionSkip, "rskip");
     TOOLVAL(param->noiseReductionIntra, "nr-intra=%d");
     TOOLVAL(param->noiseReductionInter, "nr-inter=%d");
@@ -1396,6 +1470,9 @@ char *x265_param2string(x265_param* p)
     s += sprintf(s, " fps=%u/%u", p->fpsNum, p->fpsDenom);
     s += sprintf(s, " bitdepth=%d", p->internalBitDepth);
     BOOL(p->bEnableWavefront, "wpp");
+    s += sprintf(s, " slices=%d", p->maxSlices);
+    s += sprintf(s, " tile-columns=%d", p->numTileColumns);
+    s += sprintf(s, " tile-rows=%d", p->numTileRows);
     s += sprintf(s, " ctu=%d", p->maxCUSize);
     s += sprintf(s, " min-cu-size=%d", p->minCUSize);
     s += sprintf(s, " max-tu-size=%d", p->maxTUSize);
@@ -1409,6 +1486,9 @@ char *x265_param2string(x265_param* p)
     s += sprintf(s, " max-merge=%d", p->maxNumMergeCand);
     BOOL(p->bEnableTemporalMvp, "temporal-mvp");
     BOOL(p->bEnableEarlySkip, "early-skip");
+    BOOL(p->bEarlyChromaSkip, "early-chroma-skip");
+    BOOL(p->bStaticSkip, "static-skip");
+    BOOL(p->bHashME, "hash-me");
     BOOL(p->bEnableRecursionSkip, "rskip");
     s += sprintf(s, " rdpenalty=%d", p->rdPenalty);
     BOOL(p->bEnableTransformSkip, "tskip");
@@ -1432,6 +1512,12 @@ char *x265_param2string(x265_param* p)
     s += sprintf(s, " ref=%d", p->maxNumReferences);
     s += sprintf(s, " limit-refs=%d", p->limitReferences);
     BOOL(p->limitModes, "limit-modes");
+    BOOL(p->bEnableRefMVShare, "ref-mv-share");
+    s += sprintf(s, " depth-predict=%d", p->cuDepthPredict);
+    s += sprintf(s, " cu-classify=%d", p->cuClassify);
+    s += sprintf(s, " pmode-min-size=%u", p->pmodeMinSize);
+    s += sprintf(s, " frame-budget=%.2f", p->frameBudget);
+    s += sprintf(s, " target-fps=%.2f", p->targetFps);
     BOOL(p->bEnableWeightedPred, "weightp");
     BOOL(p->bEnableWeightedBiPred, "weightb");
     s += sprintf(s, " aq-mode=%d", p->rc.aqMode);
@@ -1443,6 +1529,7 @@ char *x265_param2string(x265_param* p)
     s += sprintf(s, " psy-rd=%.2f", p->psyRd);
     s += sprintf(s, " rdoq-level=%d", p->rdoqLevel);
     s += sprintf(s, " psy-rdoq=%.2f", p->psyRdoq);
+    BOOL(p->bApproxRate, "approx-rate");
     BOOL(p->bEnableRdRefine, "rd-refine");
     BOOL(p->bEnableSignHiding, "signhide");
     BOOL(p->bEnableLoopFilter, "deblock");
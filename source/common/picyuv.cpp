@@ -382,39 +382,104 @@ static void md5_plane(MD5Context& md5, const pixel* plane, uint32_t width, uint3
     }
 }
 
-void updateCRC(const pixel* plane, uint32_t& crcVal, uint32_t height, uint32_t width, intptr_t stride)
+/* The CRC of the picture hash SEI is the CRC-16/CCITT of the bytes of the
+ * samples, shifted in MSB first. updateCRC() keeps the register of the
+ * bitwise definition, which has the message bits shifted in at the bottom,
+ * but hashes eight bytes per step with the tables of the equivalent
+ * table-driven CRC, whose register is the bitwise one times x^16 */
+static const uint32_t CRC_POLY = 0x1021;
+
+struct CRCTables
 {
-    uint32_t crcMsb;
-    uint32_t bitVal;
-    uint32_t bitIdx;
+    /* table[k][v] = v * x^(8 * k + 16) mod P */
+    uint16_t table[8][256];
 
-    for (uint32_t y = 0; y < height; y++)
+    CRCTables()
     {
-        for (uint32_t x = 0; x < width; x++)
+        for (uint32_t v = 0; v < 256; v++)
         {
-            // take CRC of first pictureData byte
-            for (bitIdx = 0; bitIdx < 8; bitIdx++)
-            {
-                crcMsb = (crcVal >> 15) & 1;
-                bitVal = (plane[y * stride + x] >> (7 - bitIdx)) & 1;
-                crcVal = (((crcVal << 1) + bitVal) & 0xffff) ^ (crcMsb * 0x1021);
-            }
+            uint32_t crc = v << 8;
+            for (int bit = 0; bit < 8; bit++)
+                crc = ((crc << 1) ^ (crc & 0x8000 ? CRC_POLY : 0)) & 0xffff;
+            table[0][v] = (uint16_t)crc;
+        }
+        for (int k = 1; k < 8; k++)
+            for (uint32_t v = 0; v < 256; v++)
+                table[k][v] = (uint16_t)((table[k - 1][v] << 8) ^ table[0][table[k - 1][v] >> 8]);
+    }
+};
+
+static const CRCTables s_crc;
 
-#if _MSC_VER
-#pragma warning(disable: 4127) // conditional expression is constant
+/* a * b mod P */
+static uint32_t crcMulMod(uint32_t a, uint32_t b)
+{
+    uint32_t r = 0;
+    for (int bit = 15; bit >= 0; bit--)
+    {
+        r = (r << 1) ^ (r & 0x8000 ? 0x10000 | CRC_POLY : 0);
+        if ((b >> bit) & 1)
+            r ^= a;
+    }
+    return r;
+}
+
+/* byte i of a row of samples, in hash order (low byte of each sample first) */
+static inline uint32_t crcByte(const pixel* row, uint32_t i)
+{
+#if HIGH_BIT_DEPTH
+    return (row[i >> 1] >> ((i & 1) << 3)) & 0xff;
+#else
+    return row[i];
 #endif
-            // take CRC of second pictureData byte if bit depth is greater than 8-bits
-            if (X265_DEPTH > 8)
-            {
-                for (bitIdx = 0; bitIdx < 8; bitIdx++)
-                {
-                    crcMsb = (crcVal >> 15) & 1;
-                    bitVal = (plane[y * stride + x] >> (15 - bitIdx)) & 1;
-                    crcVal = (((crcVal << 1) + bitVal) & 0xffff) ^ (crcMsb * 0x1021);
-                }
-            }
+}
+
+void updateCRC(const pixel* plane, uint32_t& crcVal, uint32_t height, uint32_t width, intptr_t stride)
+{
+    const uint32_t numBytes = width * (uint32_t)sizeof(pixel);
+    const uint16_t (*t)[256] = s_crc.table;
+
+    /* shift in 16 zero bits to move to the table-driven register */
+    uint32_t crc = crcVal;
+    for (int bitIdx = 0; bitIdx < 16; bitIdx++)
+        crc = ((crc << 1) & 0xffff) ^ ((crc >> 15) * CRC_POLY);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const pixel* row = plane + y * stride;
+        uint32_t i = 0;
+
+        for (; i + 8 <= numBytes; i += 8)
+        {
+            crc = t[7][crcByte(row, i) ^ (crc >> 8)] ^ t[6][crcByte(row, i + 1) ^ (crc & 0xff)] ^
+                  t[5][crcByte(row, i + 2)] ^ t[4][crcByte(row, i + 3)] ^
+                  t[3][crcByte(row, i + 4)] ^ t[2][crcByte(row, i + 5)] ^
+                  t[1][crcByte(row, i + 6)] ^ t[0][crcByte(row, i + 7)];
         }
+        for (; i < numBytes; i++)
+            crc = ((crc << 8) & 0xffff) ^ t[0][crcByte(row, i) ^ (crc >> 8)];
+    }
+
+    /* and shift the 16 bits back out. P(0) = 1, so the low bit tells whether
+     * the polynomial was subtracted */
+    for (int bitIdx = 0; bitIdx < 16; bitIdx++)
+        crc = crc & 1 ? ((crc ^ CRC_POLY) >> 1) | 0x8000 : crc >> 1;
+
+    crcVal = crc;
+}
+
+void crcCombine(uint32_t& crcVal, uint32_t rangeCrc, uint64_t rangeBytes)
+{
+    /* x^(8 * rangeBytes) mod P, by squaring */
+    uint32_t shift = 1;
+    for (uint32_t power = 1 << 8; rangeBytes; rangeBytes >>= 1)
+    {
+        if (rangeBytes & 1)
+            shift = crcMulMod(shift, power);
+        power = crcMulMod(power, power);
     }
+
+    crcVal = crcMulMod(crcVal, shift) ^ rangeCrc;
 }
 
 void crcFinish(uint32_t& crcVal, uint8_t digest[16])
@@ -433,19 +498,9 @@ void crcFinish(uint32_t& crcVal, uint8_t digest[16])
 
 void updateChecksum(const pixel* plane, uint32_t& checksumVal, uint32_t height, uint32_t width, intptr_t stride, int row, uint32_t cuHeight)
 {
-    uint8_t xor_mask;
+    uint32_t startY = row * cuHeight;
 
-    for (uint32_t y = row * cuHeight; y < ((row * cuHeight) + height); y++)
-    {
-        for (uint32_t x = 0; x < width; x++)
-        {
-            xor_mask = (uint8_t)((x & 0xff) ^ (y & 0xff) ^ (x >> 8) ^ (y >> 8));
-            checksumVal = (checksumVal + ((plane[y * stride + x] & 0xff) ^ xor_mask)) & 0xffffffff;
-
-            if (X265_DEPTH > 8)
-                checksumVal = (checksumVal + ((plane[y * stride + x] >> 7 >> 1) ^ xor_mask)) & 0xffffffff;
-        }
-    }
+    checksumVal += primitives.planeChecksum(plane + startY * stride, stride, width, height, startY);
 }
 
 void checksumFinish(uint32_t checksum, uint8_t digest[16])
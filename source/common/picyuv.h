@@ -96,8 +96,12 @@ public:
     const pixel* getChromaAddr(uint32_t chromaId, uint32_t ctuAddr, uint32_t absPartIdx) const { return m_picOrg[chromaId] + m_cuOffsetC[ctuAddr] + m_buOffsetC[absPartIdx]; }
 };
 
+/* The CRC and the checksum of a picture may be computed by parts. A checksum
+ * is the sum of the checksums of its rows. A CRC is chained from the CRCs
+ * of consecutive row ranges, each started from zero, by crcCombine() */
 void updateChecksum(const pixel* plane, uint32_t& checksumVal, uint32_t height, uint32_t width, intptr_t stride, int row, uint32_t cuHeight);
 void updateCRC(const pixel* plane, uint32_t& crcVal, uint32_t height, uint32_t width, intptr_t stride);
+void crcCombine(uint32_t& crcVal, uint32_t rangeCrc, uint64_t rangeBytes);
 void crcFinish(uint32_t & crc, uint8_t digest[16]);
 void checksumFinish(uint32_t checksum, uint8_t digest[16]);
 void updateMD5Plane(MD5Context& md5, const pixel* plane, uint32_t width, uint32_t height, intptr_t stride);
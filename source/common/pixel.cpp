@@ -842,6 +842,27 @@ static void planecopy_sp_shl_c(const uint16_t* src, intptr_t srcStride, pixel* d
     }
 }
 
+static uint32_t planeChecksum_c(const pixel* src, intptr_t stride, int width, int height, int y)
+{
+    uint32_t checksum = 0;
+
+    for (int r = y; r < y + height; r++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            uint8_t xorMask = (uint8_t)((x & 0xff) ^ (r & 0xff) ^ (x >> 8) ^ (r >> 8));
+            checksum += (src[x] & 0xff) ^ xorMask;
+#if HIGH_BIT_DEPTH
+            checksum += (src[x] >> 8) ^ xorMask;
+#endif
+        }
+
+        src += stride;
+    }
+
+    return checksum;
+}
+
 /* Estimate the total amount of influence on future quality that could be had if we
  * were to improve the reference samples used to inter predict any given CU. */
 static void estimateCUPropagateCost(int* dst, const uint16_t* propagateIn, const int32_t* intraCosts, const uint16_t* interCosts,
@@ -1195,6 +1216,7 @@ void setupPixelPrimitives_c(EncoderPrimitives &p)
     p.planecopy_cp = planecopy_cp_c;
     p.planecopy_sp = planecopy_sp_c;
     p.planecopy_sp_shl = planecopy_sp_shl_c;
+    p.planeChecksum = planeChecksum_c;
 #if HIGH_BIT_DEPTH
     p.planeClipAndMax = planeClipAndMax_c;
 #endif
@@ -57,12 +57,22 @@ inline pixel weightBidir(int w0, int16_t P0, int w1, int16_t P1, int round, int
 
 Predict::Predict()
 {
+    for (int i = 0; i < 3; i++)
+    {
+        m_intraPredCache[i].pred = NULL;
+        m_intraPredCache[i].validModes = 0;
+        m_intraPredCache[i].log2TrSize = 0;
+    }
+    m_intraPredCachePlane = -1;
+    m_intraPredCacheHits = m_intraPredCacheLookups = 0;
 }
 
 Predict::~Predict()
 {
     m_predShortYuv[0].destroy();
     m_predShortYuv[1].destroy();
+    for (int i = 0; i < 3; i++)
+        X265_FREE(m_intraPredCache[i].pred);
 }
 
 bool Predict::allocBuffers(int csp)
@@ -71,6 +81,13 @@ bool Predict::allocBuffers(int csp)
     m_hChromaShift = CHROMA_H_SHIFT(csp);
     m_vChromaShift = CHROMA_V_SHIFT(csp);
 
+    for (int i = 0; i < 3; i++)
+    {
+        m_intraPredCache[i].pred = X265_MALLOC(pixel, NUM_INTRA_MODE * 32 * 32);
+        if (!m_intraPredCache[i].pred)
+            return false;
+    }
+
     return m_predShortYuv[0].create(MAX_CU_SIZE, csp) && m_predShortYuv[1].create(MAX_CU_SIZE, csp);
 }
 
@@ -573,22 +590,97 @@ void Predict::addWeightUni(const PredictionUnit& pu, Yuv& predYuv, const ShortYu
 void Predict::predIntraLumaAng(uint32_t dirMode, pixel* dst, intptr_t stride, uint32_t log2TrSize)
 {
     int tuSize = 1 << log2TrSize;
-    int sizeIdx = log2TrSize - 2;
-    X265_CHECK(sizeIdx >= 0 && sizeIdx < 4, "intra block size is out of range\n");
+    X265_CHECK(log2TrSize >= 2 && log2TrSize <= 5, "intra block size is out of range\n");
 
     int filter = !!(g_intraFilterFlags[dirMode] & tuSize);
     bool bFilter = log2TrSize <= 4;
-    primitives.cu[sizeIdx].intra_pred[dirMode](dst, stride, intraNeighbourBuf[filter], dirMode, bFilter);
+    predIntraCached(dirMode, dst, stride, log2TrSize, filter, bFilter);
 }
 
 void Predict::predIntraChromaAng(uint32_t dirMode, pixel* dst, intptr_t stride, uint32_t log2TrSizeC)
 {
     int tuSize = 1 << log2TrSizeC;
-    int sizeIdx = log2TrSizeC - 2;
-    X265_CHECK(sizeIdx >= 0 && sizeIdx < 4, "intra block size is out of range\n");
+    X265_CHECK(log2TrSizeC >= 2 && log2TrSizeC <= 5, "intra block size is out of range\n");
 
     int filter = !!(m_csp == X265_CSP_I444 && (g_intraFilterFlags[dirMode] & tuSize));
-    primitives.cu[sizeIdx].intra_pred[dirMode](dst, stride, intraNeighbourBuf[filter], dirMode, 0);
+    predIntraCached(dirMode, dst, stride, log2TrSizeC, filter, 0);
+}
+
+void Predict::predIntraCached(uint32_t dirMode, pixel* dst, intptr_t stride, uint32_t log2TrSize, int filter, bool bFilter)
+{
+    int sizeIdx = log2TrSize - 2;
+    if (m_intraPredCachePlane < 0 || m_intraPredCache[m_intraPredCachePlane].log2TrSize != log2TrSize)
+    {
+        primitives.cu[sizeIdx].intra_pred[dirMode](dst, stride, intraNeighbourBuf[filter], dirMode, bFilter);
+        return;
+    }
+
+    IntraPredCache& cache = m_intraPredCache[m_intraPredCachePlane];
+    intptr_t tuSize = (intptr_t)1 << log2TrSize;
+    pixel* block = cache.pred + dirMode * tuSize * tuSize;
+    uint64_t modeBit = (uint64_t)1 << dirMode;
+
+    m_intraPredCacheLookups++;
+    if (cache.validModes & modeBit)
+    {
+        m_intraPredCacheHits++;
+        if (cache.transposedModes & modeBit)
+        {
+            /* blocks are transposed in place so the next hit is a plain copy */
+            ALIGN_VAR_32(pixel, tmp[32 * 32]);
+            primitives.cu[sizeIdx].transpose(tmp, block, tuSize);
+            memcpy(block, tmp, tuSize * tuSize * sizeof(pixel));
+            cache.transposedModes &= ~modeBit;
+        }
+    }
+    else
+    {
+        primitives.cu[sizeIdx].intra_pred[dirMode](block, tuSize, intraNeighbourBuf[filter], dirMode, bFilter);
+        cache.validModes |= modeBit;
+    }
+
+    primitives.cu[sizeIdx].copy_pp(dst, stride, block, tuSize);
+}
+
+void Predict::bindIntraPredCache(int plane, uint32_t log2TrSize)
+{
+    if (log2TrSize > 5)
+    {
+        m_intraPredCachePlane = -1;
+        return;
+    }
+
+    IntraPredCache& cache = m_intraPredCache[plane];
+    size_t refSize = ((4 << log2TrSize) + 1) * sizeof(pixel);
+    if (cache.log2TrSize != log2TrSize || memcmp(cache.refs, intraNeighbourBuf[0], refSize))
+    {
+        memcpy(cache.refs, intraNeighbourBuf[0], refSize);
+        cache.log2TrSize = log2TrSize;
+        cache.validModes = 0;
+        cache.transposedModes = 0;
+    }
+    m_intraPredCachePlane = plane;
+}
+
+pixel* Predict::intraPredCacheBlock(uint32_t dirMode) const
+{
+    if (m_intraPredCachePlane < 0)
+        return NULL;
+
+    const IntraPredCache& cache = m_intraPredCache[m_intraPredCachePlane];
+    return cache.pred + (dirMode << (2 * cache.log2TrSize));
+}
+
+void Predict::setIntraPredCached(uint64_t modes, bool bTransposed)
+{
+    X265_CHECK(m_intraPredCachePlane >= 0, "no intra prediction cache bound\n");
+
+    IntraPredCache& cache = m_intraPredCache[m_intraPredCachePlane];
+    cache.validModes |= modes;
+    if (bTransposed)
+        cache.transposedModes |= modes;
+    else
+        cache.transposedModes &= ~modes;
 }
 
 void Predict::initAdiPattern(const CUData& cu, const CUGeom& cuGeom, uint32_t puAbsPartIdx, const IntraNeighbors& intraNeighbors, int dirMode)
@@ -601,6 +693,7 @@ void Predict::initAdiPattern(const CUData& cu, const CUGeom& cuGeom, uint32_t pu
     intptr_t picStride = reconPic->m_stride;
 
     fillReferenceSamples(adiOrigin, picStride, intraNeighbors, intraNeighbourBuf[0]);
+    bindIntraPredCache(0, intraNeighbors.log2TrSize);
 
     pixel* refBuf = intraNeighbourBuf[0];
     pixel* fltBuf = intraNeighbourBuf[1];
@@ -650,6 +743,7 @@ void Predict::initAdiPatternChroma(const CUData& cu, const CUGeom& cuGeom, uint3
     intptr_t picStride = reconPic->m_strideC;
 
     fillReferenceSamples(adiOrigin, picStride, intraNeighbors, intraNeighbourBuf[0]);
+    bindIntraPredCache(chromaId, intraNeighbors.log2TrSize);
 
     if (m_csp == X265_CSP_I444)
         primitives.cu[intraNeighbors.log2TrSize - 2].intra_filter(intraNeighbourBuf[0], intraNeighbourBuf[1]);
@@ -72,8 +72,26 @@ public:
         bool     bNeighborFlags[4 * MAX_NUM_SPU_W + 1];
     };
 
+    /* Intra predictions of the last TU of each plane, valid for the reference
+     * samples they were generated from. Prediction is a function of only the
+     * unfiltered references, mode and TU size, so RD stages which re-predict
+     * a mode already measured by the sa8d mode search copy it from here */
+    struct IntraPredCache
+    {
+        pixel*   pred;            // NUM_INTRA_MODE consecutive blocks of TU size
+        pixel    refs[4 * 32 + 1];
+        uint64_t validModes;      // bitmap of cached modes
+        uint64_t transposedModes; // cached by intra_pred_allangs, stored transposed
+        uint32_t log2TrSize;      // 0 while no TU is bound
+    };
+
     ShortYuv  m_predShortYuv[2]; /* temporary storage for weighted prediction */
 
+    IntraPredCache m_intraPredCache[3];
+    int       m_intraPredCachePlane;  /* plane of the TU last loaded by initAdiPattern*, -1 if not cacheable */
+    uint64_t  m_intraPredCacheHits;
+    uint64_t  m_intraPredCacheLookups;
+
     // Unfiltered/filtered neighbours of the current partition.
     pixel     intraNeighbourBuf[2][258];
 
@@ -105,6 +123,12 @@ public:
     void initAdiPattern(const CUData& cu, const CUGeom& cuGeom, uint32_t puAbsPartIdx, const IntraNeighbors& intraNeighbors, int dirMode);
     void initAdiPatternChroma(const CUData& cu, const CUGeom& cuGeom, uint32_t puAbsPartIdx, const IntraNeighbors& intraNeighbors, uint32_t chromaId);
 
+    /* cache block for a mode of the TU last loaded by initAdiPattern, NULL if
+     * that TU is not cacheable. Callers predicting directly into it must then
+     * mark the modes they wrote with setIntraPredCached() */
+    pixel* intraPredCacheBlock(uint32_t dirMode) const;
+    void   setIntraPredCached(uint64_t modes, bool bTransposed);
+
     /* Intra prediction helper functions */
     static void initIntraNeighbors(const CUData& cu, uint32_t absPartIdx, uint32_t tuDepth, bool isLuma, IntraNeighbors *IntraNeighbors);
     static void fillReferenceSamples(const pixel* adiOrigin, intptr_t picStride, const IntraNeighbors& intraNeighbors, pixel dst[258]);
@@ -118,6 +142,11 @@ public:
     static int  isAboveRightAvailable(const CUData& cu, uint32_t partIdxRT, bool* bValidFlags, uint32_t numUnits);
     template<bool cip>
     static int  isBelowLeftAvailable(const CUData& cu, uint32_t partIdxLB, bool* bValidFlags, uint32_t numUnits);
+
+protected:
+
+    void bindIntraPredCache(int plane, uint32_t log2TrSize);
+    void predIntraCached(uint32_t dirMode, pixel* dst, intptr_t stride, uint32_t log2TrSize, int filter, bool bFilter);
 };
 }
 
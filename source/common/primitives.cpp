@@ -237,6 +237,15 @@ void x265_setup_primitives(x265_param *param)
         for (int i = 0; i < NUM_TR_SIZE; i++)
             primitives.cu[i].intra_pred_allangs = NULL;
 
+        /* Likewise the C reference of the all-types SAO statistics is slower
+         * than the per-type functions, only a vector version is used */
+        primitives.saoCuStatsAll = NULL;
+
+        /* and the C reference of the batched luma edge filter, the per unit
+         * path of the deblocking filter keeps the strong filter kernels */
+        primitives.pelFilterLumaEdge[0] = NULL;
+        primitives.pelFilterLumaEdge[1] = NULL;
+
 #if ENABLE_ASSEMBLY
 #if X265_ARCH_X86
         setupInstrinsicPrimitives(primitives, param->cpuid);
@@ -140,6 +140,8 @@ typedef uint32_t (*nquant_t)(const int16_t* coef, const int32_t* quantCoeff, int
 typedef void (*dequant_scaling_t)(const int16_t* src, const int32_t* dequantCoef, int16_t* dst, int num, int mcqp_miper, int shift);
 typedef void (*dequant_normal_t)(const int16_t* quantCoef, int16_t* coef, int num, int scale, int shift);
 typedef int(*count_nonzero_t)(const int16_t* quantCoeff);
+typedef void (*nonPsyRdoQuant_t)(const int16_t* resiDctCoeff, int64_t* costUncoded, int64_t* totalUncodedCost, int64_t* totalRdCost, uint32_t blkPos);
+typedef void (*psyRdoQuant_t)(const int16_t* resiDctCoeff, const int16_t* fencDctCoeff, int64_t* costUncoded, int64_t* totalUncodedCost, int64_t* totalRdCost, int64_t psyScale, uint32_t blkPos);
 typedef void (*weightp_pp_t)(const pixel* src, pixel* dst, intptr_t stride, int width, int height, int w0, int round, int shift, int offset);
 typedef void (*weightp_sp_t)(const int16_t* src, pixel* dst, intptr_t srcStride, intptr_t dstStride, int width, int height, int w0, int round, int shift, int offset);
 typedef void (*scale1D_t)(pixel* dst, const pixel* src);
@@ -181,11 +183,17 @@ typedef void (*saoCuStatsE0_t)(const int16_t *diff, const pixel *rec, intptr_t s
 typedef void (*saoCuStatsE1_t)(const int16_t *diff, const pixel *rec, intptr_t stride, int8_t *upBuff1, int endX, int endY, int32_t *stats, int32_t *count);
 typedef void (*saoCuStatsE2_t)(const int16_t *diff, const pixel *rec, intptr_t stride, int8_t *upBuff1, int8_t *upBuff, int endX, int endY, int32_t *stats, int32_t *count);
 typedef void (*saoCuStatsE3_t)(const int16_t *diff, const pixel *rec, intptr_t stride, int8_t *upBuff1, int endX, int endY, int32_t *stats, int32_t *count);
+/* Statistics of the BO and all four EO types in one pass over the CTU. bounds holds startX, startY,
+ * endX, endY of each type and stats/count are [type][class], in the order SAO_EO_0..SAO_EO_3, SAO_BO */
+typedef void (*saoCuStatsAll_t)(const int16_t *diff, const pixel *rec, intptr_t stride, const int *bounds, int32_t *stats, int32_t *count);
 
 typedef void (*sign_t)(int8_t *dst, const pixel *src1, const pixel *src2, const int endX);
 typedef void (*planecopy_cp_t) (const uint8_t* src, intptr_t srcStride, pixel* dst, intptr_t dstStride, int width, int height, int shift);
 typedef void (*planecopy_sp_t) (const uint16_t* src, intptr_t srcStride, pixel* dst, intptr_t dstStride, int width, int height, int shift, uint16_t mask);
 typedef pixel (*planeClipAndMax_t)(pixel *src, intptr_t stride, int width, int height, uint64_t *outsum, const pixel minPix, const pixel maxPix);
+/* Decoded picture hash SEI checksum of a block of rows starting at picture row y: the sum of the
+ * bytes of the samples, each XORed with a mask of its picture coordinates */
+typedef uint32_t (*planeChecksum_t)(const pixel *src, intptr_t stride, int width, int height, int y);
 
 typedef void (*cutree_propagate_cost) (int* dst, const uint16_t* propagateIn, const int32_t* intraCosts, const uint16_t* interCosts, const int32_t* invQscales, const double* fpsFactor, int len);
 
@@ -202,6 +210,15 @@ typedef uint32_t (*costC1C2Flag_t)(uint16_t *absCoeff, intptr_t numC1Flag, uint8
 typedef void (*pelFilterLumaStrong_t)(pixel* src, intptr_t srcStep, intptr_t offset, int32_t tcP, int32_t tcQ);
 typedef void (*pelFilterChroma_t)(pixel* src, intptr_t srcStep, intptr_t offset, int32_t tc, int32_t maskP, int32_t maskQ);
 
+/* Luma deblocking of count consecutive 4-line units along one edge, decisions included. Units
+ * with a zero tc are not filtered; maskP and maskQ are 0 for a side which must be left as is */
+typedef void (*pelFilterLumaEdge_t)(pixel* src, intptr_t srcStep, intptr_t offset, const int32_t* tc, const int32_t* beta, const int32_t* maskP, const int32_t* maskQ, int count);
+
+/* Motion part of the deblocking boundary strength, 0 or 1, of count edge units. refs and mvs
+ * are rows of stride entries for P list 0, P list 1, Q list 0 and Q list 1, holding reference
+ * picture identities and packed MV words */
+typedef void (*boundaryStrength_t)(const int32_t* refs, const int32_t* mvs, intptr_t stride, uint8_t* bs, int count);
+
 /* Function pointers to optimized encoder primitives. Each pointer can reference
  * either an assembly routine, a SIMD intrinsic primitive, or a C function */
 struct EncoderPrimitives
@@ -251,6 +268,8 @@ struct EncoderPrimitives
         blockfill_s_t   blockfill_s;   // block fill, for DC transforms
         copy_cnt_t      copy_cnt;      // copy coeff while counting non-zero
         count_nonzero_t count_nonzero;
+        nonPsyRdoQuant_t nonPsyRdoQuant; // RDOQ uncoded cost of one 4x4 coeff group
+        psyRdoQuant_t   psyRdoQuant;     // as above, less the psy-rdoq energy bias
         cpy2Dto1D_shl_t cpy2Dto1D_shl;
         cpy2Dto1D_shr_t cpy2Dto1D_shr;
         cpy1Dto2D_shl_t cpy1Dto2D_shl;
@@ -314,6 +333,7 @@ struct EncoderPrimitives
     saoCuStatsE1_t        saoCuStatsE1;
     saoCuStatsE2_t        saoCuStatsE2;
     saoCuStatsE3_t        saoCuStatsE3;
+    saoCuStatsAll_t       saoCuStatsAll;
 
     downscale_t           frameInitLowres;
     cutree_propagate_cost propagateCost;
@@ -325,6 +345,7 @@ struct EncoderPrimitives
     planecopy_sp_t        planecopy_sp;
     planecopy_sp_t        planecopy_sp_shl;
     planeClipAndMax_t     planeClipAndMax;
+    planeChecksum_t       planeChecksum;
 
     weightp_sp_t          weight_sp;
     weightp_pp_t          weight_pp;
@@ -339,6 +360,8 @@ struct EncoderPrimitives
 
     pelFilterLumaStrong_t pelFilterLumaStrong[2]; // EDGE_VER = 0, EDGE_HOR = 1
     pelFilterChroma_t     pelFilterChroma[2];     // EDGE_VER = 0, EDGE_HOR = 1
+    pelFilterLumaEdge_t   pelFilterLumaEdge[2];   // EDGE_VER = 0, EDGE_HOR = 1
+    boundaryStrength_t    boundaryStrength;
 
     /* There is one set of chroma primitives per color space. An encoder will
      * have just a single color space and thus it will only ever use one entry
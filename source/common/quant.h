@@ -43,6 +43,7 @@ struct QpParam
     int qp;
     int64_t lambda2; /* FIX8 */
     int32_t lambda;  /* FIX8, dynamic range is 18-bits in Main and 20-bits in Main10 */
+    sse_t   zeroSse; /* a quarter of the squared quantizer step size */
 
     QpParam() : qp(MAX_INT) {}
 
@@ -55,6 +56,7 @@ struct QpParam
             qp  = qpScaled;
             lambda2 = (int64_t)(x265_lambda2_tab[qp - QP_BD_OFFSET] * 256. + 0.5);
             lambda  = (int32_t)(x265_lambda_tab[qp - QP_BD_OFFSET] * 256. + 0.5);
+            zeroSse = (sse_t)(pow(2.0, (qp - 4) / 3.0) / 4);
             X265_CHECK((x265_lambda_tab[qp - QP_BD_OFFSET] * 256. + 0.5) < (double)MAX_INT, "x265_lambda_tab[] value too large\n");
         }
     }
@@ -106,6 +108,14 @@ public:
     /* CU setup */
     void setQPforQuant(const CUData& ctu, int qp);
 
+    /* A residual with less energy than this quantizes to all zero coefficients,
+     * since no coefficient of the (near orthonormal) transform can exceed the
+     * square root of the energy and levels below half a quantizer step are
+     * never rounded up. Scaling lists may reduce the step size */
+    sse_t zeroResidualSse(TextType ttype) const { return m_scalingList->m_bEnabled ? 0 : m_qpParam[ttype].zeroSse; }
+
+    int   qp(TextType ttype) const { return m_qpParam[ttype].qp; }
+
     uint32_t transformNxN(const CUData& cu, const pixel* fenc, uint32_t fencStride, const int16_t* residual, uint32_t resiStride, coeff_t* coeff,
                           uint32_t log2TrSize, TextType ttype, uint32_t absPartIdx, bool useTransformSkip);
 
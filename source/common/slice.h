@@ -279,6 +279,11 @@ struct PPS
 
     bool     bDeblockingFilterControlPresent;
     bool     bPicDisableDeblockingFilter;
+
+    int      numTileColumns;            // use param
+    int      numTileRows;               // use param
+    uint32_t tileColBd[X265_MAX_TILE_COLUMNS + 1]; // first CTU column of each tile column, numCuInWidth at the end
+    uint32_t tileRowBd[X265_MAX_TILE_ROWS + 1];    // first CTU row of each tile row, numCuInHeight at the end
 };
 
 struct WeightParam
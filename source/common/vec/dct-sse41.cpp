@@ -100,9 +100,101 @@ static void dequant_scaling(const int16_t* quantCoef, const int32_t *deQuantCoef
     }
 }
 
+/* squared residual coefficients of one row of a 4x4 coeff group, scaled and
+ * widened to 64 bits in two registers */
+static inline void rdoQuantSquares(const int16_t* resiDctCoeff, __m128i& resi, __m128i& cost01, __m128i& cost23, __m128i scaleBits)
+{
+    resi = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)resiDctCoeff));
+    __m128i sq = _mm_mullo_epi32(resi, resi); /* at most 2^30 */
+    cost01 = _mm_sll_epi64(_mm_cvtepu32_epi64(sq), scaleBits);
+    cost23 = _mm_sll_epi64(_mm_cvtepu32_epi64(_mm_srli_si128(sq, 8)), scaleBits);
+}
+
+static inline void rdoQuantStore(int64_t* costUncoded, __m128i cost01, __m128i cost23, __m128i& sum)
+{
+    _mm_storeu_si128((__m128i*)costUncoded, cost01);
+    _mm_storeu_si128((__m128i*)(costUncoded + 2), cost23);
+    sum = _mm_add_epi64(sum, _mm_add_epi64(cost01, cost23));
+}
+
+template<int log2TrSize>
+static void nonPsyRdoQuant(const int16_t* resiDctCoeff, int64_t* costUncoded, int64_t* totalUncodedCost, int64_t* totalRdCost, uint32_t blkPos)
+{
+    const int transformShift = MAX_TR_DYNAMIC_RANGE - X265_DEPTH - log2TrSize;
+    const __m128i scaleBits = _mm_cvtsi32_si128(SCALE_BITS - 2 * transformShift);
+    const uint32_t trSize = 1 << log2TrSize;
+
+    __m128i sum = _mm_setzero_si128();
+    for (int y = 0; y < MLS_CG_SIZE; y++)
+    {
+        __m128i resi, cost01, cost23;
+        rdoQuantSquares(resiDctCoeff + blkPos, resi, cost01, cost23, scaleBits);
+        rdoQuantStore(costUncoded + blkPos, cost01, cost23, sum);
+        blkPos += trSize;
+    }
+
+    int64_t total = _mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1);
+    *totalUncodedCost += total;
+    *totalRdCost += total;
+}
+
+template<int log2TrSize>
+static void psyRdoQuant(const int16_t* resiDctCoeff, const int16_t* fencDctCoeff, int64_t* costUncoded, int64_t* totalUncodedCost, int64_t* totalRdCost, int64_t psyScale, uint32_t blkPos)
+{
+    const int transformShift = MAX_TR_DYNAMIC_RANGE - X265_DEPTH - log2TrSize;
+    const __m128i scaleBits = _mm_cvtsi32_si128(SCALE_BITS - 2 * transformShift);
+    const __m128i psyShift = _mm_cvtsi32_si128(X265_MAX(0, 2 * transformShift + 1));
+    const uint32_t trSize = 1 << log2TrSize;
+
+    /* psyScale exceeds 32 bits, the 64-bit product is built from its 16-bit
+     * low part and signed high part with the signed 32x32 multiply */
+    const __m128i psyHi = _mm_set1_epi32((int32_t)(psyScale >> 16));
+    const __m128i psyLo = _mm_set1_epi32((int32_t)(psyScale & 0xFFFF));
+
+    /* SSE has no 64-bit arithmetic shift, bias the products to unsigned */
+    const __m128i bias = _mm_set1_epi64x((int64_t)1 << 63);
+    const __m128i biasShifted = _mm_srl_epi64(bias, psyShift);
+
+    __m128i sum = _mm_setzero_si128();
+    for (int y = 0; y < MLS_CG_SIZE; y++)
+    {
+        __m128i resi, cost01, cost23;
+        rdoQuantSquares(resiDctCoeff + blkPos, resi, cost01, cost23, scaleBits);
+
+        __m128i fenc = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)(fencDctCoeff + blkPos)));
+        __m128i pred02 = _mm_sub_epi32(fenc, resi);
+        __m128i pred13 = _mm_srli_epi64(pred02, 32);
+
+        __m128i psy02 = _mm_add_epi64(_mm_slli_epi64(_mm_mul_epi32(pred02, psyHi), 16), _mm_mul_epi32(pred02, psyLo));
+        __m128i psy13 = _mm_add_epi64(_mm_slli_epi64(_mm_mul_epi32(pred13, psyHi), 16), _mm_mul_epi32(pred13, psyLo));
+        psy02 = _mm_sub_epi64(_mm_srl_epi64(_mm_xor_si128(psy02, bias), psyShift), biasShifted);
+        psy13 = _mm_sub_epi64(_mm_srl_epi64(_mm_xor_si128(psy13, bias), psyShift), biasShifted);
+
+        cost01 = _mm_sub_epi64(cost01, _mm_unpacklo_epi64(psy02, psy13));
+        cost23 = _mm_sub_epi64(cost23, _mm_unpackhi_epi64(psy02, psy13));
+        rdoQuantStore(costUncoded + blkPos, cost01, cost23, sum);
+        blkPos += trSize;
+    }
+
+    int64_t total = _mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1);
+    *totalUncodedCost += total;
+    *totalRdCost += total;
+}
+
 namespace X265_NS {
 void setupIntrinsicDCT_sse41(EncoderPrimitives &p)
 {
     p.dequant_scaling = dequant_scaling;
+
+#if X86_64
+    p.cu[BLOCK_4x4].nonPsyRdoQuant   = nonPsyRdoQuant<2>;
+    p.cu[BLOCK_8x8].nonPsyRdoQuant   = nonPsyRdoQuant<3>;
+    p.cu[BLOCK_16x16].nonPsyRdoQuant = nonPsyRdoQuant<4>;
+    p.cu[BLOCK_32x32].nonPsyRdoQuant = nonPsyRdoQuant<5>;
+    p.cu[BLOCK_4x4].psyRdoQuant   = psyRdoQuant<2>;
+    p.cu[BLOCK_8x8].psyRdoQuant   = psyRdoQuant<3>;
+    p.cu[BLOCK_16x16].psyRdoQuant = psyRdoQuant<4>;
+    p.cu[BLOCK_32x32].psyRdoQuant = psyRdoQuant<5>;
+#endif
 }
 }
@@ -0,0 +1,91 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "primitives.h"
+#include <pmmintrin.h> // SSE3
+
+using namespace X265_NS;
+
+namespace {
+
+/* The mask of a sample is (x & 0xff) ^ (x >> 8) ^ (y & 0xff) ^ (y >> 8). Within
+ * a vector starting at a multiple of its width only the low bits of x change,
+ * so the mask is one byte for the vector XORed with the lane index. The
+ * masked bytes are summed by SAD against zero */
+uint32_t planeChecksum_sse3(const pixel* src, intptr_t stride, int width, int height, int y)
+{
+    const __m128i zero = _mm_setzero_si128();
+#if HIGH_BIT_DEPTH
+    const __m128i lanes = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m128i lowByte = _mm_set1_epi16(0xff);
+    const int step = 8;
+#else
+    const __m128i lanes = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const int step = 16;
+#endif
+    __m128i sum = zero;
+    uint32_t checksum = 0;
+
+    for (int r = y; r < y + height; r++)
+    {
+        const int rowMask = (r & 0xff) ^ (r >> 8);
+        int x = 0;
+
+        for (; x + step <= width; x += step)
+        {
+            const int mask = (uint8_t)(rowMask ^ (x & 0xff) ^ (x >> 8));
+            const __m128i pix = _mm_loadu_si128((const __m128i*)(src + x));
+#if HIGH_BIT_DEPTH
+            const __m128i xorMask = _mm_xor_si128(_mm_set1_epi16((int16_t)mask), lanes);
+            const __m128i lo = _mm_xor_si128(_mm_and_si128(pix, lowByte), xorMask);
+            const __m128i hi = _mm_xor_si128(_mm_srli_epi16(pix, 8), xorMask);
+            sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_packus_epi16(lo, hi), zero));
+#else
+            const __m128i xorMask = _mm_xor_si128(_mm_set1_epi8((char)mask), lanes);
+            sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_xor_si128(pix, xorMask), zero));
+#endif
+        }
+
+        for (; x < width; x++)
+        {
+            uint8_t xorMask = (uint8_t)((x & 0xff) ^ (x >> 8) ^ rowMask);
+            checksum += (src[x] & 0xff) ^ xorMask;
+#if HIGH_BIT_DEPTH
+            checksum += (src[x] >> 8) ^ xorMask;
+#endif
+        }
+
+        src += stride;
+    }
+
+    sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+    return checksum + (uint32_t)_mm_cvtsi128_si32(sum);
+}
+
+}
+
+namespace X265_NS {
+void setupIntrinsicHash_sse3(EncoderPrimitives &p)
+{
+    p.planeChecksum = planeChecksum_sse3;
+}
+}
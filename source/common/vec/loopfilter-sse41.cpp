@@ -0,0 +1,222 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+
+#include "common.h"
+#include "primitives.h"
+#include <smmintrin.h> // SSE4.1
+
+using namespace X265_NS;
+
+namespace {
+
+/* MV words differing by 4 quarter pels or more in x or y, as 32-bit lane
+ * masks. The differences saturate, which keeps them at 4 or more */
+inline __m128i mvDiffers(__m128i a, __m128i b)
+{
+    const __m128i absDiff = _mm_abs_epi16(_mm_subs_epi16(a, b));
+    const __m128i small = _mm_cmpeq_epi16(_mm_min_epu16(absDiff, _mm_set1_epi16(3)), absDiff);
+    return _mm_xor_si128(_mm_cmpeq_epi32(small, _mm_set1_epi32(-1)), _mm_set1_epi32(-1));
+}
+
+void boundaryStrength_sse41(const int32_t* refs, const int32_t* mvs, intptr_t stride, uint8_t* bs, int count)
+{
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i refP0 = _mm_loadu_si128((const __m128i*)(refs + i));
+        const __m128i refP1 = _mm_loadu_si128((const __m128i*)(refs + stride + i));
+        const __m128i refQ0 = _mm_loadu_si128((const __m128i*)(refs + 2 * stride + i));
+        const __m128i refQ1 = _mm_loadu_si128((const __m128i*)(refs + 3 * stride + i));
+        const __m128i mvP0 = _mm_loadu_si128((const __m128i*)(mvs + i));
+        const __m128i mvP1 = _mm_loadu_si128((const __m128i*)(mvs + stride + i));
+        const __m128i mvQ0 = _mm_loadu_si128((const __m128i*)(mvs + 2 * stride + i));
+        const __m128i mvQ1 = _mm_loadu_si128((const __m128i*)(mvs + 3 * stride + i));
+
+        const __m128i sameDirect = _mm_and_si128(_mm_cmpeq_epi32(refP0, refQ0), _mm_cmpeq_epi32(refP1, refQ1));
+        const __m128i sameCross = _mm_and_si128(_mm_cmpeq_epi32(refP0, refQ1), _mm_cmpeq_epi32(refP1, refQ0));
+        const __m128i direct = _mm_or_si128(mvDiffers(mvQ0, mvP0), mvDiffers(mvQ1, mvP1));
+        const __m128i cross = _mm_or_si128(mvDiffers(mvQ1, mvP0), mvDiffers(mvQ0, mvP1));
+
+        /* different L0 & L1 refs compare the matching pairing, same refs need both */
+        __m128i moved = _mm_blendv_epi8(cross, direct, sameDirect);
+        moved = _mm_blendv_epi8(moved, _mm_and_si128(direct, cross), _mm_cmpeq_epi32(refP0, refP1));
+
+        __m128i res = _mm_or_si128(_mm_cmpeq_epi32(_mm_or_si128(sameDirect, sameCross), _mm_setzero_si128()), moved);
+        res = _mm_and_si128(res, _mm_set1_epi32(1));
+        res = _mm_packus_epi16(_mm_packs_epi32(res, res), res);
+        *(int32_t*)(bs + i) = _mm_cvtsi128_si32(res);
+    }
+
+    for (; i < count; i++)
+    {
+        int32_t refP0 = refs[i], refP1 = refs[stride + i], refQ0 = refs[2 * stride + i], refQ1 = refs[3 * stride + i];
+        const __m128i mvP = _mm_setr_epi32(mvs[i], mvs[stride + i], mvs[stride + i], mvs[i]);
+        const __m128i mvQ = _mm_setr_epi32(mvs[2 * stride + i], mvs[3 * stride + i], mvs[2 * stride + i], mvs[3 * stride + i]);
+        int moved = _mm_movemask_ps(_mm_castsi128_ps(mvDiffers(mvQ, mvP)));
+        bool direct = !!(moved & 3), cross = !!(moved & 12);
+
+        bool sameDirect = refP0 == refQ0 && refP1 == refQ1;
+        bool sameCross = refP0 == refQ1 && refP1 == refQ0;
+        if (!sameDirect && !sameCross)
+            bs[i] = 1;
+        else if (refP0 != refP1)
+            bs[i] = sameDirect ? direct : cross;
+        else
+            bs[i] = direct && cross;
+    }
+}
+
+/* 8 pixels of a row widened to 16 bits */
+inline __m128i load8(const pixel* src)
+{
+#if HIGH_BIT_DEPTH
+    return _mm_loadu_si128((const __m128i*)src);
+#else
+    return _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)src));
+#endif
+}
+
+inline void store8(pixel* dst, __m128i v)
+{
+#if HIGH_BIT_DEPTH
+    _mm_storeu_si128((__m128i*)dst, v);
+#else
+    _mm_storel_epi64((__m128i*)dst, _mm_packus_epi16(v, v));
+#endif
+}
+
+/* the values of lanes 0 and 3 of each unit spread to its 4 lanes */
+inline __m128i firstLine(__m128i v) { return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0x00), 0x00); }
+inline __m128i lastLine(__m128i v)  { return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xff), 0xff); }
+
+/* the 16-bit value of two units, 4 lanes each */
+inline __m128i unitPair(const int32_t* v)
+{
+    return _mm_unpacklo_epi64(_mm_set1_epi16((int16_t)v[0]), _mm_set1_epi16((int16_t)v[1]));
+}
+
+/* m clipped to within t of ref */
+inline __m128i clipDelta(__m128i m, __m128i ref, __m128i t)
+{
+    const __m128i d = _mm_min_epi16(_mm_max_epi16(_mm_sub_epi16(m, ref), _mm_sub_epi16(_mm_setzero_si128(), t)), t);
+    return _mm_add_epi16(ref, d);
+}
+
+/* Horizontal edges: the columns of two units are filtered together, one row
+ * of the edge per vector. The decisions are made on lanes 0 and 3 of a unit */
+void pelFilterLumaEdgeH_sse41(pixel* src, intptr_t srcStep, intptr_t offset, const int32_t* tc, const int32_t* beta,
+                              const int32_t* maskP, const int32_t* maskQ, int count)
+{
+    X265_CHECK(srcStep == 1, "horizontal edge step\n");
+    X265_CHECK(!(count & 1), "odd number of edge units\n");
+    (void)srcStep;
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i pixMax = _mm_set1_epi16((1 << X265_DEPTH) - 1);
+    const __m128i two = _mm_set1_epi16(2), four = _mm_set1_epi16(4);
+
+    for (int unit = 0; unit < count; unit += 2, src += 2 * UNIT_SIZE)
+    {
+        if (!(tc[unit] | tc[unit + 1]))
+            continue;
+
+        const __m128i p3 = load8(src - offset * 4), p2 = load8(src - offset * 3);
+        const __m128i p1 = load8(src - offset * 2), p0 = load8(src - offset);
+        const __m128i q0 = load8(src), q1 = load8(src + offset);
+        const __m128i q2 = load8(src + offset * 2), q3 = load8(src + offset * 3);
+
+        const __m128i tcV = unitPair(tc + unit);
+        const __m128i betaV = unitPair(beta + unit);
+
+        const __m128i dp = _mm_abs_epi16(_mm_sub_epi16(_mm_add_epi16(p2, p0), _mm_add_epi16(p1, p1)));
+        const __m128i dq = _mm_abs_epi16(_mm_sub_epi16(_mm_add_epi16(q2, q0), _mm_add_epi16(q1, q1)));
+        const __m128i dpq = _mm_add_epi16(dp, dq);
+        const __m128i d0 = firstLine(dpq), d3 = lastLine(dpq);
+
+        const __m128i filter = _mm_and_si128(_mm_cmpgt_epi16(betaV, _mm_adds_epi16(d0, d3)), _mm_cmpgt_epi16(tcV, zero));
+        if (_mm_testz_si128(filter, filter))
+            continue;
+
+        const __m128i maskPV = unitPair(maskP + unit);
+        const __m128i maskQV = unitPair(maskQ + unit);
+
+        /* strong filter decision */
+        const __m128i beta2 = _mm_srai_epi16(betaV, 2);
+        const __m128i tc52 = _mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(tcV, _mm_set1_epi16(5)), _mm_set1_epi16(1)), 1);
+        __m128i strong = _mm_cmpgt_epi16(_mm_srai_epi16(betaV, 3),
+                                         _mm_add_epi16(_mm_abs_epi16(_mm_sub_epi16(p3, p0)), _mm_abs_epi16(_mm_sub_epi16(q3, q0))));
+        strong = _mm_and_si128(strong, _mm_cmpgt_epi16(tc52, _mm_abs_epi16(_mm_sub_epi16(p0, q0))));
+        strong = _mm_and_si128(strong, _mm_cmpgt_epi16(beta2, _mm_add_epi16(dpq, dpq)));
+        strong = _mm_and_si128(_mm_and_si128(firstLine(strong), lastLine(strong)), filter);
+
+        /* strong filter */
+        const __m128i tcS = _mm_add_epi16(tcV, tcV);
+        const __m128i tcP = _mm_and_si128(tcS, maskPV), tcQ = _mm_and_si128(tcS, maskQV);
+        const __m128i p1p0q0 = _mm_add_epi16(_mm_add_epi16(p1, p0), q0);
+        const __m128i p0q0q1 = _mm_add_epi16(_mm_add_epi16(p0, q0), q1);
+        const __m128i sp2 = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(_mm_add_epi16(p3, p3), _mm_mullo_epi16(p2, _mm_set1_epi16(3))), _mm_add_epi16(p1p0q0, four)), 3);
+        const __m128i sp1 = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(p2, p1p0q0), two), 2);
+        const __m128i sp0 = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(_mm_add_epi16(p2, q1), _mm_add_epi16(p1p0q0, p1p0q0)), four), 3);
+        const __m128i sq0 = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(_mm_add_epi16(p1, q2), _mm_add_epi16(p0q0q1, p0q0q1)), four), 3);
+        const __m128i sq1 = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(q2, p0q0q1), two), 2);
+        const __m128i sq2 = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(_mm_add_epi16(q3, q3), _mm_mullo_epi16(q2, _mm_set1_epi16(3))), _mm_add_epi16(p0q0q1, four)), 3);
+
+        /* weak filter, delta = (9 * (q0 - p0) - 3 * (q1 - p1) + 8) >> 4 */
+        const __m128i dq0p0 = _mm_sub_epi16(q0, p0), dq1p1 = _mm_sub_epi16(q1, p1);
+        const __m128i taps = _mm_set1_epi32((-3 << 16) | 9);
+        const __m128i round = _mm_set1_epi32(8);
+        const __m128i deltaLo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(dq0p0, dq1p1), taps), round), 4);
+        const __m128i deltaHi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(dq0p0, dq1p1), taps), round), 4);
+        const __m128i delta = _mm_packs_epi32(deltaLo, deltaHi);
+
+        const __m128i weak = _mm_andnot_si128(strong, _mm_and_si128(filter, _mm_cmpgt_epi16(_mm_mullo_epi16(tcV, _mm_set1_epi16(10)), _mm_abs_epi16(delta))));
+        const __m128i dl = _mm_min_epi16(_mm_max_epi16(delta, _mm_sub_epi16(zero, tcV)), tcV);
+        const __m128i wp0 = _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(p0, _mm_and_si128(dl, maskPV)), zero), pixMax);
+        const __m128i wq0 = _mm_min_epi16(_mm_max_epi16(_mm_sub_epi16(q0, _mm_and_si128(dl, maskQV)), zero), pixMax);
+
+        const __m128i tc2 = _mm_srai_epi16(tcV, 1);
+        const __m128i sideThreshold = _mm_srai_epi16(_mm_add_epi16(betaV, _mm_srai_epi16(betaV, 1)), 3);
+        const __m128i weakP1 = _mm_and_si128(_mm_and_si128(weak, maskPV), _mm_cmpgt_epi16(sideThreshold, _mm_add_epi16(firstLine(dp), lastLine(dp))));
+        const __m128i weakQ1 = _mm_and_si128(_mm_and_si128(weak, maskQV), _mm_cmpgt_epi16(sideThreshold, _mm_add_epi16(firstLine(dq), lastLine(dq))));
+        const __m128i dp1 = _mm_srai_epi16(_mm_add_epi16(_mm_sub_epi16(_mm_avg_epu16(p2, p0), p1), dl), 1);
+        const __m128i dq1 = _mm_srai_epi16(_mm_sub_epi16(_mm_sub_epi16(_mm_avg_epu16(q2, q0), q1), dl), 1);
+        const __m128i wp1 = _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(p1, _mm_min_epi16(_mm_max_epi16(dp1, _mm_sub_epi16(zero, tc2)), tc2)), zero), pixMax);
+        const __m128i wq1 = _mm_min_epi16(_mm_max_epi16(_mm_add_epi16(q1, _mm_min_epi16(_mm_max_epi16(dq1, _mm_sub_epi16(zero, tc2)), tc2)), zero), pixMax);
+
+        store8(src - offset * 3, _mm_blendv_epi8(p2, clipDelta(sp2, p2, tcP), strong));
+        store8(src - offset * 2, _mm_blendv_epi8(_mm_blendv_epi8(p1, wp1, weakP1), clipDelta(sp1, p1, tcP), strong));
+        store8(src - offset,     _mm_blendv_epi8(_mm_blendv_epi8(p0, wp0, weak), clipDelta(sp0, p0, tcP), strong));
+        store8(src,              _mm_blendv_epi8(_mm_blendv_epi8(q0, wq0, weak), clipDelta(sq0, q0, tcQ), strong));
+        store8(src + offset,     _mm_blendv_epi8(_mm_blendv_epi8(q1, wq1, weakQ1), clipDelta(sq1, q1, tcQ), strong));
+        store8(src + offset * 2, _mm_blendv_epi8(q2, clipDelta(sq2, q2, tcQ), strong));
+    }
+}
+
+}
+
+namespace X265_NS {
+void setupIntrinsicLoopFilter_sse41(EncoderPrimitives &p)
+{
+    p.boundaryStrength = boundaryStrength_sse41;
+    p.pelFilterLumaEdge[1] = pelFilterLumaEdgeH_sse41;
+}
+}
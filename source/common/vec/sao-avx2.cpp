@@ -0,0 +1,165 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "primitives.h"
+#include <immintrin.h> // AVX2
+
+using namespace X265_NS;
+
+namespace {
+
+enum { NUM_EO_TYPE = 4, SAO_BO_TYPE = 4, NUM_EDGETYPE = 5, NUM_SAO_CLASS = 32, SAO_BO_BITS = 5 };
+
+/* edge type to class index, as SAO::s_eoTable */
+const int eoTable[NUM_EDGETYPE] = { 1, 2, 0, 3, 4 };
+
+/* 16 pixels widened to 16 bits */
+inline __m256i load16(const pixel* src)
+{
+#if HIGH_BIT_DEPTH
+    return _mm256_loadu_si256((const __m256i*)src);
+#else
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)src));
+#endif
+}
+
+/* edge type, 0..4, of the pixels against the two neighbors */
+inline __m256i edgeType(__m256i cur, __m256i a, __m256i b)
+{
+    /* compares give -1 for true: signOf(cur - a) = (a > cur) - (cur > a) */
+    __m256i sign = _mm256_sub_epi16(_mm256_cmpgt_epi16(a, cur), _mm256_cmpgt_epi16(cur, a));
+    sign = _mm256_add_epi16(sign, _mm256_sub_epi16(_mm256_cmpgt_epi16(b, cur), _mm256_cmpgt_epi16(cur, b)));
+    return _mm256_add_epi16(_mm256_set1_epi16(2), sign);
+}
+
+inline int32_t sum32(__m256i v)
+{
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+    return _mm_cvtsi128_si32(s);
+}
+
+/* One pass over the rows of the CTU: the rec and diff of each 16 pixels are
+ * loaded once and classified for the four EO types, the band of each pixel is
+ * counted while the row is in L1. Sums of diff are kept in 32 bits, counts in
+ * 16 bit lanes, at most 64 rows of 4 vectors per lane */
+void saoCuStatsAll_avx2(const int16_t *diff, const pixel *rec, intptr_t stride, const int *bounds, int32_t *stats, int32_t *count)
+{
+    const int boShift = X265_DEPTH - SAO_BO_BITS;
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i lane = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    __m256i sum[NUM_EO_TYPE][NUM_EDGETYPE];
+    __m256i cnt[NUM_EO_TYPE][NUM_EDGETYPE];
+    __m256i startX[NUM_EO_TYPE], endX[NUM_EO_TYPE];
+    int startY = MAX_CU_SIZE, endY = 0;
+
+    for (int type = 0; type <= SAO_BO_TYPE; type++)
+    {
+        const int* b = bounds + 4 * type;
+        if (b[0] < b[2] && b[1] < b[3])
+        {
+            startY = X265_MIN(startY, b[1]);
+            endY = X265_MAX(endY, b[3]);
+        }
+        if (type < NUM_EO_TYPE)
+        {
+            startX[type] = _mm256_set1_epi16((int16_t)(b[0] - 1));
+            endX[type] = _mm256_set1_epi16((int16_t)b[2]);
+            for (int edge = 0; edge < NUM_EDGETYPE; edge++)
+                sum[type][edge] = cnt[type][edge] = _mm256_setzero_si256();
+        }
+    }
+
+    const int* bo = bounds + 4 * SAO_BO_TYPE;
+    for (int y = startY; y < endY; y++)
+    {
+        const pixel* r = rec + y * stride;
+        const int16_t* d = diff + y * MAX_CU_SIZE;
+
+        if (y >= bo[1] && y < bo[3])
+        {
+            for (int x = bo[0]; x < bo[2]; x++)
+            {
+                int classIdx = r[x] >> boShift;
+                stats[SAO_BO_TYPE * NUM_SAO_CLASS + classIdx] += d[x];
+                count[SAO_BO_TYPE * NUM_SAO_CLASS + classIdx]++;
+            }
+        }
+
+        bool bActive[NUM_EO_TYPE];
+        int rowEnd = 0;
+        for (int type = 0; type < NUM_EO_TYPE; type++)
+        {
+            const int* b = bounds + 4 * type;
+            bActive[type] = y >= b[1] && y < b[3] && b[0] < b[2];
+            if (bActive[type])
+                rowEnd = X265_MAX(rowEnd, b[2]);
+        }
+
+        for (int x = 0; x < rowEnd; x += 16)
+        {
+            const __m256i cur = load16(r + x);
+            const __m256i dif = _mm256_loadu_si256((const __m256i*)(d + x));
+            const __m256i pos = _mm256_add_epi16(lane, _mm256_set1_epi16((int16_t)x));
+
+            __m256i edges[NUM_EO_TYPE];
+            edges[0] = edgeType(cur, load16(r + x - 1), load16(r + x + 1));
+            edges[1] = edgeType(cur, load16(r + x - stride), load16(r + x + stride));
+            edges[2] = edgeType(cur, load16(r + x - stride - 1), load16(r + x + stride + 1));
+            edges[3] = edgeType(cur, load16(r + x - stride + 1), load16(r + x + stride - 1));
+
+            for (int type = 0; type < NUM_EO_TYPE; type++)
+            {
+                if (!bActive[type])
+                    continue;
+
+                const __m256i inside = _mm256_and_si256(_mm256_cmpgt_epi16(pos, startX[type]), _mm256_cmpgt_epi16(endX[type], pos));
+                for (int edge = 0; edge < NUM_EDGETYPE; edge++)
+                {
+                    __m256i mask = _mm256_and_si256(_mm256_cmpeq_epi16(edges[type], _mm256_set1_epi16((int16_t)edge)), inside);
+                    sum[type][edge] = _mm256_add_epi32(sum[type][edge], _mm256_madd_epi16(_mm256_and_si256(dif, mask), ones));
+                    cnt[type][edge] = _mm256_sub_epi16(cnt[type][edge], mask);
+                }
+            }
+        }
+    }
+
+    for (int type = 0; type < NUM_EO_TYPE; type++)
+    {
+        for (int edge = 0; edge < NUM_EDGETYPE; edge++)
+        {
+            stats[type * NUM_SAO_CLASS + eoTable[edge]] += sum32(sum[type][edge]);
+            count[type * NUM_SAO_CLASS + eoTable[edge]] += sum32(_mm256_madd_epi16(cnt[type][edge], ones));
+        }
+    }
+}
+
+}
+
+namespace X265_NS {
+void setupIntrinsicSao_avx2(EncoderPrimitives &p)
+{
+    p.saoCuStatsAll = saoCuStatsAll_avx2;
+}
+}
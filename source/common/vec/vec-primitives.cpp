@@ -55,8 +55,11 @@ namespace X265_NS {
 // private x265 namespace
 
 void setupIntrinsicDCT_sse3(EncoderPrimitives&);
+void setupIntrinsicHash_sse3(EncoderPrimitives&);
 void setupIntrinsicDCT_ssse3(EncoderPrimitives&);
 void setupIntrinsicDCT_sse41(EncoderPrimitives&);
+void setupIntrinsicLoopFilter_sse41(EncoderPrimitives&);
+void setupIntrinsicSao_avx2(EncoderPrimitives&);
 
 /* Use primitives for the best available vector architecture */
 void setupInstrinsicPrimitives(EncoderPrimitives &p, int cpuMask)
@@ -65,6 +68,7 @@ void setupInstrinsicPrimitives(EncoderPrimitives &p, int cpuMask)
     if (cpuMask & X265_CPU_SSE3)
     {
         setupIntrinsicDCT_sse3(p);
+        setupIntrinsicHash_sse3(p);
     }
 #endif
 #ifdef HAVE_SSSE3
@@ -77,6 +81,13 @@ void setupInstrinsicPrimitives(EncoderPrimitives &p, int cpuMask)
     if (cpuMask & X265_CPU_SSE4)
     {
         setupIntrinsicDCT_sse41(p);
+        setupIntrinsicLoopFilter_sse41(p);
+    }
+#endif
+#ifdef HAVE_AVX2
+    if (cpuMask & X265_CPU_AVX2)
+    {
+        setupIntrinsicSao_avx2(p);
     }
 #endif
     (void)p;
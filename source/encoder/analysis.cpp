@@ -33,6 +33,7 @@
 #include "analysis.h"
 #include "rdcost.h"
 #include "encoder.h"
+#include "slicetype.h"
 
 using namespace X265_NS;
 
@@ -75,6 +76,9 @@ Analysis::Analysis()
     m_reuseInterDataCTU = NULL;
     m_reuseRef = NULL;
     m_bHD = false;
+    m_cuDepthRange[0] = 0;
+    m_cuDepthRange[1] = NUM_CU_DEPTH - 1;
+    m_cuClassifier = NULL;
 }
 bool Analysis::create(ThreadLocalData *tld)
 {
@@ -143,6 +147,7 @@ Mode& Analysis::compressCTU(CUData& ctu, Frame& frame, const CUGeom& cuGeom, con
 
     m_rqt[0].cur.load(initialContext);
     m_modeDepth[0].fencYuv.copyFromPicYuv(*m_frame->m_fencPic, ctu.m_cuAddr, 0);
+    resetApproxRate();
 
     uint32_t numPartition = ctu.m_numPartitions;
     if (m_param->analysisMode && m_slice->m_sliceType != I_SLICE)
@@ -174,10 +179,14 @@ Mode& Analysis::compressCTU(CUData& ctu, Frame& frame, const CUGeom& cuGeom, con
     }
     else
     {
+        predictCUDepthRange(ctu, cuGeom);
+
         if (m_param->bIntraRefresh && m_slice->m_sliceType == P_SLICE &&
             ctu.m_cuPelX / g_maxCUSize >= frame.m_encData->m_pir.pirStartCol
             && ctu.m_cuPelX / g_maxCUSize < frame.m_encData->m_pir.pirEndCol)
             compressIntraCU(ctu, cuGeom, qp);
+        else if (m_param->bStaticSkip && compressStaticCTU(ctu, cuGeom, qp))
+            return *m_modeDepth[0].bestMode;
         else if (!m_param->rdLevel)
         {
             /* In RD Level 0/1, copy source pixels into the reconstructed block so
@@ -203,6 +212,99 @@ Mode& Analysis::compressCTU(CUData& ctu, Frame& frame, const CUGeom& cuGeom, con
     return *m_modeDepth[0].bestMode;
 }
 
+/* a CTU whose source is identical to the co-located block of the source of a
+ * reference picture is coded as a single 2Nx2N skip CU, using the first merge
+ * candidate with zero motion towards such references. Returns false, leaving
+ * the CTU to the regular analysis, when the CTU is not static or no merge
+ * candidate qualifies */
+bool Analysis::compressStaticCTU(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp)
+{
+    if (cuGeom.flags & CUGeom::SPLIT_MANDATORY)
+        return false;
+
+    /* the co-located block of the reference may not be refreshed yet */
+    if (m_param->bIntraRefresh && m_slice->m_sliceType == P_SLICE &&
+        parentCTU.m_cuPelX / g_maxCUSize < m_frame->m_encData->m_pir.pirEndCol)
+        return false;
+
+    /* per reference: 1 static, 0 not static, -1 not yet measured */
+    int8_t staticRef[2][MAX_NUM_REF];
+    memset(staticRef, -1, sizeof(staticRef));
+    if (m_frame->m_bDuplicate)
+        staticRef[0][0] = 1;
+
+    ModeDepth& md = m_modeDepth[0];
+    Mode& skip = md.pred[PRED_SKIP];
+    skip.initCosts();
+    skip.cu.initSubCU(parentCTU, cuGeom, qp);
+    skip.cu.setPartSizeSubParts(SIZE_2Nx2N);
+    skip.cu.setPredModeSubParts(MODE_INTER);
+    skip.cu.m_mergeFlag[0] = true;
+
+    MVField candMvField[MRG_MAX_NUM_CANDS][2];
+    uint8_t candDir[MRG_MAX_NUM_CANDS];
+    uint32_t numMergeCand = skip.cu.getInterMergeCandidates(0, 0, candMvField, candDir);
+
+    int bestCand = -1;
+    for (uint32_t i = 0; i < numMergeCand && bestCand < 0; i++)
+    {
+        bool bStatic = true;
+        for (int list = 0; list < 2 && bStatic; list++)
+        {
+            if (!(candDir[i] & (1 << list)))
+                continue;
+
+            int refIdx = candMvField[i][list].refIdx;
+            if (candMvField[i][list].mv.notZero())
+                bStatic = false;
+            else
+            {
+                if (staticRef[list][refIdx] < 0)
+                    staticRef[list][refIdx] = isStaticRef(*m_slice->m_refFrameList[list][refIdx], parentCTU.m_cuAddr, cuGeom);
+                bStatic = staticRef[list][refIdx] == 1;
+            }
+        }
+        if (bStatic)
+            bestCand = i;
+    }
+
+    if (bestCand < 0)
+        return false;
+
+    skip.cu.m_mvpIdx[0][0] = (uint8_t)bestCand; // merge candidate ID is stored in L0 MVP idx
+    skip.cu.setPUInterDir(candDir[bestCand], 0, 0);
+    skip.cu.setPUMv(0, candMvField[bestCand][0].mv, 0, 0);
+    skip.cu.setPUMv(1, candMvField[bestCand][1].mv, 0, 0);
+    skip.cu.setPURefIdx(0, (int8_t)candMvField[bestCand][0].refIdx, 0, 0);
+    skip.cu.setPURefIdx(1, (int8_t)candMvField[bestCand][1].refIdx, 0, 0);
+
+    PredictionUnit pu(skip.cu, cuGeom, 0);
+    motionCompensation(skip.cu, pu, skip.predYuv, true, m_csp != X265_CSP_I400 && m_frame->m_fencPic->m_picCsp != X265_CSP_I400);
+    encodeResAndCalcRdSkipCU(skip);
+    checkDQP(skip, cuGeom);
+
+    md.bestMode = &skip;
+    skip.cu.copyToPic(0);
+    skip.reconYuv.copyToPicYuv(*m_frame->m_reconPic, parentCTU.m_cuAddr, 0);
+    return true;
+}
+
+/* compare the CTU source with the co-located block of a reference's source */
+bool Analysis::isStaticRef(const Frame& refFrame, uint32_t cuAddr, const CUGeom& cuGeom) const
+{
+    const Yuv& fencYuv = m_modeDepth[0].fencYuv;
+    const PicYuv& refPic = *refFrame.m_fencPic;
+    int part = partitionFromLog2Size(cuGeom.log2CUSize);
+
+    if (primitives.cu[part].sse_pp(fencYuv.m_buf[0], fencYuv.m_size, refPic.getLumaAddr(cuAddr), refPic.m_stride))
+        return false;
+    if (m_csp == X265_CSP_I400 || m_frame->m_fencPic->m_picCsp == X265_CSP_I400)
+        return true;
+
+    return !primitives.chroma[m_csp].cu[part].sse_pp(fencYuv.m_buf[1], fencYuv.m_csize, refPic.getCbAddr(cuAddr), refPic.m_strideC) &&
+           !primitives.chroma[m_csp].cu[part].sse_pp(fencYuv.m_buf[2], fencYuv.m_csize, refPic.getCrAddr(cuAddr), refPic.m_strideC);
+}
+
 void Analysis::tryLossless(const CUGeom& cuGeom)
 {
     ModeDepth& md = m_modeDepth[cuGeom.depth];
@@ -294,6 +396,8 @@ void Analysis::compressIntraCU(const CUData& parentCTU, const CUGeom& cuGeom, in
 
     bool bAlreadyDecided = parentCTU.m_lumaIntraDir[cuGeom.absPartIdx] != (uint8_t)ALL_IDX;
     bool bDecidedDepth = parentCTU.m_cuDepth[cuGeom.absPartIdx] == depth;
+    uint32_t minDepth = 0, maxDepth = NUM_CU_DEPTH - 1;
+    applyAnalysisHints(parentCTU, cuGeom, minDepth, maxDepth);
 
     if (bAlreadyDecided)
     {
@@ -313,7 +417,7 @@ void Analysis::compressIntraCU(const CUData& parentCTU, const CUGeom& cuGeom, in
                 addSplitFlagCost(*md.bestMode, cuGeom.depth);
         }
     }
-    else if (cuGeom.log2CUSize != MAX_LOG2_CU_SIZE && mightNotSplit)
+    else if (cuGeom.log2CUSize != MAX_LOG2_CU_SIZE && mightNotSplit && depth >= minDepth)
     {
         md.pred[PRED_INTRA].cu.initSubCU(parentCTU, cuGeom, qp);
         checkIntra(md.pred[PRED_INTRA], cuGeom, SIZE_2Nx2N);
@@ -335,6 +439,8 @@ void Analysis::compressIntraCU(const CUData& parentCTU, const CUGeom& cuGeom, in
 
     // stop recursion if we reach the depth of previous analysis decision
     mightSplit &= !(bAlreadyDecided && bDecidedDepth);
+    if (!bAlreadyDecided && md.bestMode && depth >= maxDepth)
+        mightSplit = false;
 
     if (mightSplit)
     {
@@ -409,23 +515,34 @@ void Analysis::PMODE::processTasks(int workerThreadId)
 #endif
     ProfileScopeEvent(pmode);
     master.processPmode(*this, master.m_tld[workerThreadId].analysis);
+#if DETAILED_CU_STATS
+    master.m_tld[workerThreadId].analysis.flushIntraPredCacheStats(fe);
+#endif
 }
 
 /* process pmode jobs until none remain; may be called by the master thread or by
  * a bonded peer (slave) thread via pmodeTasks() */
 void Analysis::processPmode(PMODE& pmode, Analysis& slave)
 {
+    /* when the master did not bond any peers it owns all the jobs and no
+     * peer can join later, so the job counter needs no lock. Peers always
+     * lock, they may run before the master has counted them */
+    bool bLocked = &slave != this || pmode.m_bondedPeerCount;
+
     /* acquire a mode task, else exit early */
     int task;
-    pmode.m_lock.acquire();
+    if (bLocked)
+        pmode.m_lock.acquire();
     if (pmode.m_jobTotal > pmode.m_jobAcquired)
     {
         task = pmode.m_jobAcquired++;
-        pmode.m_lock.release();
+        if (bLocked)
+            pmode.m_lock.release();
     }
     else
     {
-        pmode.m_lock.release();
+        if (bLocked)
+            pmode.m_lock.release();
         return;
     }
 
@@ -448,6 +565,7 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
     {
         uint32_t refMasks[2] = { 0, 0 };
 
+        slave.resetApproxRate();
         if (m_param->rdLevel <= 4)
         {
             switch (pmode.modes[task])
@@ -583,10 +701,12 @@ void Analysis::processPmode(PMODE& pmode, Analysis& slave)
         }
 
         task = -1;
-        pmode.m_lock.acquire();
+        if (bLocked)
+            pmode.m_lock.acquire();
         if (pmode.m_jobTotal > pmode.m_jobAcquired)
             task = pmode.m_jobAcquired++;
-        pmode.m_lock.release();
+        if (bLocked)
+            pmode.m_lock.release();
     }
     while (task >= 0);
 }
@@ -601,6 +721,9 @@ uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& c
     bool mightSplit = !(cuGeom.flags & CUGeom::LEAF);
     bool mightNotSplit = !(cuGeom.flags & CUGeom::SPLIT_MANDATORY);
     uint32_t minDepth = m_param->rdLevel <= 4 ? topSkipMinDepth(parentCTU, cuGeom) : 0;
+    minDepth = X265_MAX(minDepth, m_cuDepthRange[0]);
+    uint32_t maxDepth = m_cuDepthRange[1];
+    bool bHintIntra = applyAnalysisHints(parentCTU, cuGeom, minDepth, maxDepth);
     uint32_t splitRefs[4] = { 0, 0, 0, 0 };
 
     X265_CHECK(m_param->rdLevel >= 2, "compressInterCU_dist does not support RD 0 or 1\n");
@@ -627,6 +750,8 @@ uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& c
         if (mightSplit && depth && depth >= minDepth && !bNoSplit && m_param->rdLevel <= 4)
             bNoSplit = recursionDepthCheck(parentCTU, cuGeom, *md.bestMode);
     }
+    if (mightNotSplit && depth >= minDepth && depth >= maxDepth)
+        bNoSplit = true;
 
     if (mightSplit && !bNoSplit)
     {
@@ -679,7 +804,7 @@ uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& c
     if (mightNotSplit && depth >= minDepth)
     {
         int bTryAmp = m_slice->m_sps->maxAMPDepth > depth;
-        int bTryIntra = (m_slice->m_sliceType != B_SLICE || m_param->bIntraInBFrames) && (!m_param->limitReferences || splitIntra) && (cuGeom.log2CUSize != MAX_LOG2_CU_SIZE);
+        int bTryIntra = (m_slice->m_sliceType != B_SLICE || m_param->bIntraInBFrames) && (!m_param->limitReferences || splitIntra) && (cuGeom.log2CUSize != MAX_LOG2_CU_SIZE) && bHintIntra;
 
         if (m_slice->m_pps->bUseDQP && depth <= m_slice->m_pps->maxCuDQPDepth && m_slice->m_pps->maxCuDQPDepth != 0)
             setLambdaFromQP(parentCTU, qp);
@@ -708,10 +833,15 @@ uint32_t Analysis::compressInterCU_dist(const CUData& parentCTU, const CUGeom& c
 
         m_splitRefIdx[0] = splitRefs[0]; m_splitRefIdx[1] = splitRefs[1]; m_splitRefIdx[2] = splitRefs[2]; m_splitRefIdx[3] = splitRefs[3];
 
-        pmode.tryBondPeers(*m_frame->m_encData->m_jobProvider, pmode.m_jobTotal);
+        /* this thread takes jobs as well, so one peer fewer than the job count
+         * is enough. The modes of small CUs are cheaper to analyze here than
+         * to hand over to peers */
+        if (pmode.m_jobTotal > 1 && (1u << cuGeom.log2CUSize) >= m_param->pmodeMinSize)
+            pmode.tryBondPeers(*m_frame->m_encData->m_jobProvider, pmode.m_jobTotal - 1);
 
         /* participate in processing jobs, until all are distributed */
         processPmode(pmode, *this);
+        resetApproxRate();
 
         /* the master worker thread (this one) does merge analysis. By doing
          * merge after all the other jobs are at least started, we usually avoid
@@ -887,7 +1017,9 @@ SplitData Analysis::compressInterCU_rd0_4(const CUData& parentCTU, const CUGeom&
 
     bool mightSplit = !(cuGeom.flags & CUGeom::LEAF);
     bool mightNotSplit = !(cuGeom.flags & CUGeom::SPLIT_MANDATORY);
-    uint32_t minDepth = topSkipMinDepth(parentCTU, cuGeom);
+    uint32_t minDepth = X265_MAX(topSkipMinDepth(parentCTU, cuGeom), m_cuDepthRange[0]);
+    uint32_t maxDepth = m_cuDepthRange[1];
+    bool bHintIntra = applyAnalysisHints(parentCTU, cuGeom, minDepth, maxDepth);
     bool skipModes = false; /* Skip any remaining mode analyses at current depth */
     bool skipRecursion = false; /* Skip recursion */
     bool splitIntra = true;
@@ -955,6 +1087,26 @@ SplitData Analysis::compressInterCU_rd0_4(const CUData& parentCTU, const CUGeom&
                 skipRecursion = complexityCheckCU(*md.bestMode);
         }
     }
+    if (mightNotSplit && depth >= minDepth && depth >= maxDepth)
+        skipRecursion = true;
+
+    /* learned early-outs, predicted from the merge/skip analysis */
+    double cuFeatures[CUClassifier::NUM_FEATURES];
+    bool bClassified = false;
+    if ((m_param->cuClassify || m_cuClassifier->isDumping()) && m_param->rdLevel &&
+        mightSplit && mightNotSplit && depth >= minDepth && md.bestMode)
+    {
+        getClassifierFeatures(parentCTU, cuGeom, *md.bestMode, cuFeatures);
+        bClassified = true;
+        if (m_param->cuClassify)
+        {
+            double thresh = m_param->cuClassify == 1 ? 0.05 : 0.15;
+            if (m_cuClassifier->predict(CUClassifier::SPLIT, depth, cuFeatures) < thresh)
+                skipRecursion = true;
+            if (m_cuClassifier->predict(CUClassifier::MERGE, depth, cuFeatures) > 1 - thresh)
+                skipModes = true;
+        }
+    }
 
     /* Step 2. Evaluate each of the 4 split sub-blocks in series */
     if (mightSplit && !skipRecursion)
@@ -1198,7 +1350,7 @@ SplitData Analysis::compressInterCU_rd0_4(const CUData& parentCTU, const CUGeom&
                     }
                 }
             }
-            bool bTryIntra = (m_slice->m_sliceType != B_SLICE || m_param->bIntraInBFrames) && cuGeom.log2CUSize != MAX_LOG2_CU_SIZE;
+            bool bTryIntra = (m_slice->m_sliceType != B_SLICE || m_param->bIntraInBFrames) && cuGeom.log2CUSize != MAX_LOG2_CU_SIZE && bHintIntra;
             if (m_param->rdLevel >= 3)
             {
                 /* Calculate RD cost of best inter option */
@@ -1351,6 +1503,7 @@ SplitData Analysis::compressInterCU_rd0_4(const CUData& parentCTU, const CUGeom&
     if (mightSplit && !skipRecursion)
     {
         Mode* splitPred = &md.pred[PRED_SPLIT];
+        Mode* bestNonSplit = md.bestMode;
         if (!md.bestMode)
             md.bestMode = splitPred;
         else if (m_param->rdLevel > 1)
@@ -1359,6 +1512,9 @@ SplitData Analysis::compressInterCU_rd0_4(const CUData& parentCTU, const CUGeom&
             md.bestMode = splitPred;
 
         checkDQPForSplitPred(*md.bestMode, cuGeom);
+
+        if (bClassified && bestNonSplit && !m_param->cuClassify && m_cuClassifier->isDumping())
+            dumpClassifierSample(cuGeom, cuFeatures, *bestNonSplit);
     }
 
     /* determine which motion references the parent CU should search */
@@ -1411,6 +1567,9 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
 
     bool mightSplit = !(cuGeom.flags & CUGeom::LEAF);
     bool mightNotSplit = !(cuGeom.flags & CUGeom::SPLIT_MANDATORY);
+    uint32_t minDepth = m_cuDepthRange[0];
+    uint32_t maxDepth = m_cuDepthRange[1];
+    bool bHintIntra = applyAnalysisHints(parentCTU, cuGeom, minDepth, maxDepth);
     bool skipRecursion = false;
     bool skipModes = false;
     bool splitIntra = true;
@@ -1455,11 +1614,18 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
     }
 
     /* Step 1. Evaluate Merge/Skip candidates for likely early-outs */
-    if (mightNotSplit && !md.bestMode)
+    double cuFeatures[CUClassifier::NUM_FEATURES];
+    bool bClassified = false;
+    if (mightNotSplit && depth >= minDepth && !md.bestMode)
     {
         md.pred[PRED_SKIP].cu.initSubCU(parentCTU, cuGeom, qp);
         md.pred[PRED_MERGE].cu.initSubCU(parentCTU, cuGeom, qp);
         checkMerge2Nx2N_rd5_6(md.pred[PRED_SKIP], md.pred[PRED_MERGE], cuGeom);
+        if ((m_param->cuClassify || m_cuClassifier->isDumping()) && mightSplit && md.bestMode)
+        {
+            getClassifierFeatures(parentCTU, cuGeom, *md.bestMode, cuFeatures);
+            bClassified = true;
+        }
         skipModes = m_param->bEnableEarlySkip && md.bestMode && !md.bestMode->cu.getQtRootCbf(0);
         refMasks[0] = allSplitRefs;
         md.pred[PRED_2Nx2N].cu.initSubCU(parentCTU, cuGeom, qp);
@@ -1469,6 +1635,18 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
         if (m_param->bEnableRecursionSkip && depth && m_modeDepth[depth - 1].bestMode)
             skipRecursion = md.bestMode && !md.bestMode->cu.getQtRootCbf(0);
     }
+    if (mightNotSplit && depth >= minDepth && depth >= maxDepth)
+        skipRecursion = true;
+
+    /* learned early-outs, predicted from the merge/skip analysis */
+    if (bClassified && m_param->cuClassify)
+    {
+        double thresh = m_param->cuClassify == 1 ? 0.05 : 0.15;
+        if (m_cuClassifier->predict(CUClassifier::SPLIT, depth, cuFeatures) < thresh)
+            skipRecursion = true;
+        if (m_cuClassifier->predict(CUClassifier::MERGE, depth, cuFeatures) > 1 - thresh)
+            skipModes = true;
+    }
 
     // estimate split cost
     /* Step 2. Evaluate each of the 4 split sub-blocks in series */
@@ -1525,7 +1703,7 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
      *   2  3 */
     allSplitRefs = splitData[0].splitRefs | splitData[1].splitRefs | splitData[2].splitRefs | splitData[3].splitRefs;
     /* Step 3. Evaluate ME (2Nx2N, rect, amp) and intra modes at current depth */
-    if (mightNotSplit)
+    if (mightNotSplit && depth >= minDepth)
     {
         if (m_slice->m_pps->bUseDQP && depth <= m_slice->m_pps->maxCuDQPDepth && m_slice->m_pps->maxCuDQPDepth != 0)
             setLambdaFromQP(parentCTU, qp);
@@ -1710,7 +1888,7 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
                 }
             }
 
-            if ((m_slice->m_sliceType != B_SLICE || m_param->bIntraInBFrames) && cuGeom.log2CUSize != MAX_LOG2_CU_SIZE)
+            if ((m_slice->m_sliceType != B_SLICE || m_param->bIntraInBFrames) && cuGeom.log2CUSize != MAX_LOG2_CU_SIZE && bHintIntra)
             {
                 if (!m_param->limitReferences || splitIntra)
                 {
@@ -1753,8 +1931,14 @@ SplitData Analysis::compressInterCU_rd5_6(const CUData& parentCTU, const CUGeom&
 
     /* compare split RD cost against best cost */
     if (mightSplit && !skipRecursion)
+    {
+        Mode* bestNonSplit = md.bestMode;
         checkBestMode(md.pred[PRED_SPLIT], depth);
 
+        if (bClassified && bestNonSplit && !m_param->cuClassify && m_cuClassifier->isDumping())
+            dumpClassifierSample(cuGeom, cuFeatures, *bestNonSplit);
+    }
+
     if (m_param->bEnableRdRefine && depth <= m_slice->m_pps->maxCuDQPDepth)
     {
         int cuIdx = (cuGeom.childOffset - 1) / 3;
@@ -2551,6 +2735,203 @@ uint32_t Analysis::topSkipMinDepth(const CUData& parentCTU, const CUGeom& cuGeom
     return minDepth;
 }
 
+void Analysis::predictCUDepthRange(const CUData& ctu, const CUGeom& cuGeom)
+{
+    m_cuDepthRange[0] = 0;
+    m_cuDepthRange[1] = g_maxCUDepth;
+
+    /* picture boundary CTUs have forced splits, their depths are not a
+     * useful prediction for whole CTUs and vice versa */
+    if (!m_param->cuDepthPredict || (cuGeom.flags & CUGeom::SPLIT_MANDATORY))
+        return;
+
+    const CUData* neighbours[4];
+    int numNeighbours = 0;
+    for (int list = 0; list < 2; list++)
+        if (m_slice->m_numRefIdx[list])
+            neighbours[numNeighbours++] = m_slice->m_refFrameList[list][0]->m_encData->getPicCTU(ctu.m_cuAddr);
+    if (ctu.m_cuLeft)
+        neighbours[numNeighbours++] = ctu.m_cuLeft;
+    if (ctu.m_cuAbove)
+        neighbours[numNeighbours++] = ctu.m_cuAbove;
+
+    uint32_t minDepth = g_maxCUDepth, maxDepth = 0;
+    for (int n = 0; n < numNeighbours; n++)
+    {
+        /* depth is constant within an 8x8 (4 partitions) */
+        for (uint32_t i = 0; i < ctu.m_numPartitions; i += 4)
+        {
+            uint32_t d = neighbours[n]->m_cuDepth[i];
+            minDepth = X265_MIN(d, minDepth);
+            maxDepth = X265_MAX(d, maxDepth);
+        }
+    }
+    if (!numNeighbours)
+        return;
+
+    if (m_param->cuDepthPredict == 1)
+    {
+        minDepth = minDepth ? minDepth - 1 : 0;
+        maxDepth = X265_MIN(maxDepth + 1, g_maxCUDepth);
+    }
+
+    /* the lookahead's intra costs tell us whether this CTU is flatter or more
+     * detailed than its neighbours were; they may only widen the range */
+    const Lowres& lowres = m_frame->m_lowres;
+    if (lowres.costEst[0][0] >= 0)
+    {
+        const uint32_t lowresCUSize = X265_LOWRES_CU_SIZE * 2; /* in full resolution pels */
+        uint32_t x0 = ctu.m_cuPelX / lowresCUSize, y0 = ctu.m_cuPelY / lowresCUSize;
+        uint32_t x1 = X265_MIN(x0 + (g_maxCUSize + lowresCUSize - 1) / lowresCUSize, lowres.maxBlocksInRow);
+        uint32_t y1 = X265_MIN(y0 + (g_maxCUSize + lowresCUSize - 1) / lowresCUSize, lowres.maxBlocksInCol);
+
+        uint64_t sum = 0, sumSq = 0;
+        uint32_t count = 0;
+        for (uint32_t y = y0; y < y1; y++)
+        {
+            for (uint32_t x = x0; x < x1; x++)
+            {
+                uint64_t cost = lowres.intraCost[y * lowres.maxBlocksInRow + x];
+                sum += cost;
+                sumSq += cost * cost;
+                count++;
+            }
+        }
+
+        if (count)
+        {
+            /* compare the variance of the block costs against the mean squared:
+             * stddev < mean / 4 is flat, stddev > mean is highly varied */
+            uint64_t meanSq = (sum * sum) / count;
+            uint64_t var = sumSq - meanSq;
+            if (var * 16 < meanSq)
+                minDepth = minDepth ? minDepth - 1 : 0;
+            else if (var > meanSq)
+                maxDepth = g_maxCUDepth;
+        }
+    }
+
+    m_cuDepthRange[0] = minDepth;
+    m_cuDepthRange[1] = X265_MAX(minDepth, maxDepth);
+}
+
+/* Narrow the CU depth range to the depths hinted by another encode of the
+ * picture, allowing CUs up to one depth larger. Returns false when that
+ * encode chose no intra CU over this CU's area, so intra need not be tried */
+bool Analysis::applyAnalysisHints(const CUData& parentCTU, const CUGeom& cuGeom, uint32_t& minDepth, uint32_t& maxDepth)
+{
+    const AnalysisHints& hints = m_frame->m_analysisHints;
+    if (!hints.bValid)
+        return true;
+
+    uint32_t offset = parentCTU.m_cuAddr * hints.numPartitions + cuGeom.absPartIdx;
+    const uint8_t* depth = hints.depth + offset;
+    const uint8_t* predMode = hints.predMode + offset;
+    uint32_t hintMin = g_maxCUDepth, hintMax = 0;
+    bool bIntra = false;
+    for (uint32_t i = 0; i < cuGeom.numPartitions; i++)
+    {
+        hintMin = X265_MIN(hintMin, (uint32_t)depth[i]);
+        hintMax = X265_MAX(hintMax, (uint32_t)depth[i]);
+        bIntra |= predMode[i] == MODE_INTRA;
+    }
+
+    if (hintMin)
+        minDepth = X265_MAX(minDepth, hintMin - 1);
+    maxDepth = X265_MIN(maxDepth, hintMax);
+    return bIntra;
+}
+
+void Analysis::getClassifierFeatures(const CUData& parentCTU, const CUGeom& cuGeom, const Mode& mergeMode, double features[])
+{
+    uint32_t depth = cuGeom.depth;
+    uint32_t cuSize = 1 << cuGeom.log2CUSize;
+    double numPixels = (double)(cuSize * cuSize);
+
+    /* luma variance, accumulated over 8x8 blocks so the sums cannot overflow */
+    const Yuv& fencYuv = m_modeDepth[depth].fencYuv;
+    uint64_t sum = 0, ssd = 0;
+    for (uint32_t y = 0; y < cuSize; y += 8)
+    {
+        for (uint32_t x = 0; x < cuSize; x += 8)
+        {
+            uint64_t sumSsd = primitives.cu[BLOCK_8x8].var(fencYuv.m_buf[0] + y * fencYuv.m_size + x, fencYuv.m_size);
+            sum += (uint32_t)sumSsd;
+            ssd += sumSsd >> 32;
+        }
+    }
+    double mean = sum / numPixels;
+    features[CUClassifier::FEAT_VARIANCE] = X265_LOG2(1 + X265_MAX(ssd / numPixels - mean * mean, 0.0));
+
+    int64_t mergeCost = m_param->rdLevel ? (int64_t)mergeMode.rdCost : (int64_t)mergeMode.sa8dCost;
+    features[CUClassifier::FEAT_MERGE_COST] = X265_LOG2(1 + mergeCost / numPixels);
+
+    /* lookahead costs of the lowres blocks covering this CU */
+    const Lowres& lowres = m_frame->m_lowres;
+    const uint32_t lowresCUSize = X265_LOWRES_CU_SIZE * 2; /* in full resolution pels */
+    uint32_t cuPelX = parentCTU.m_cuPelX + g_zscanToPelX[cuGeom.absPartIdx];
+    uint32_t cuPelY = parentCTU.m_cuPelY + g_zscanToPelY[cuGeom.absPartIdx];
+    uint32_t x0 = X265_MIN(cuPelX / lowresCUSize, lowres.maxBlocksInRow - 1);
+    uint32_t y0 = X265_MIN(cuPelY / lowresCUSize, lowres.maxBlocksInCol - 1);
+    uint32_t x1 = X265_MIN((cuPelX + cuSize - 1) / lowresCUSize, lowres.maxBlocksInRow - 1);
+    uint32_t y1 = X265_MIN((cuPelY + cuSize - 1) / lowresCUSize, lowres.maxBlocksInCol - 1);
+
+    int d0 = m_slice->m_poc - m_slice->m_refPOCList[0][0];
+    int d1 = m_slice->m_sliceType == B_SLICE ? m_slice->m_refPOCList[1][0] - m_slice->m_poc : 0;
+    bool bInterCost = d0 > 0 && d0 <= X265_BFRAME_MAX + 1 && d1 >= 0 && d1 <= X265_BFRAME_MAX + 1 &&
+                      lowres.costEst[d0][d1] >= 0;
+
+    uint64_t intraCost = 0, interCost = 0;
+    uint32_t numBlocks = 0;
+    for (uint32_t y = y0; y <= y1; y++)
+    {
+        for (uint32_t x = x0; x <= x1; x++)
+        {
+            uint32_t idx = y * lowres.maxBlocksInRow + x;
+            intraCost += lowres.intraCost[idx];
+            interCost += bInterCost ? (lowres.lowresCosts[d0][d1][idx] & LOWRES_COST_MASK) : lowres.intraCost[idx];
+            numBlocks++;
+        }
+    }
+    double lowresPixels = (double)numBlocks * X265_LOWRES_CU_SIZE * X265_LOWRES_CU_SIZE;
+    features[CUClassifier::FEAT_LOWRES_INTRA] = X265_LOG2(1 + intraCost / lowresPixels);
+    features[CUClassifier::FEAT_LOWRES_RATIO] = X265_LOG2((1.0 + interCost) / (1.0 + intraCost));
+
+    /* CU depths already chosen around this CU, and in the first reference */
+    uint32_t depthSum = 0, numDepths = 0;
+    uint32_t partIdx;
+    const CUData* cuLeft = parentCTU.getPULeft(partIdx, cuGeom.absPartIdx);
+    if (cuLeft)
+    {
+        depthSum += cuLeft->m_cuDepth[partIdx];
+        numDepths++;
+    }
+    const CUData* cuAbove = parentCTU.getPUAbove(partIdx, cuGeom.absPartIdx);
+    if (cuAbove)
+    {
+        depthSum += cuAbove->m_cuDepth[partIdx];
+        numDepths++;
+    }
+    if (m_slice->m_numRefIdx[0])
+    {
+        const CUData* colCU = m_slice->m_refFrameList[0][0]->m_encData->getPicCTU(parentCTU.m_cuAddr);
+        depthSum += colCU->m_cuDepth[cuGeom.absPartIdx];
+        numDepths++;
+    }
+    features[CUClassifier::FEAT_NEIGH_DEPTH] = numDepths ? (double)depthSum / numDepths - depth : 0.0;
+
+    features[CUClassifier::FEAT_QP] = (double)mergeMode.cu.m_qp[0] / QP_MAX_SPEC;
+}
+
+void Analysis::dumpClassifierSample(const CUGeom& cuGeom, const double features[], const Mode& bestNonSplit)
+{
+    const CUData& cu = bestNonSplit.cu;
+    bool bSplit = m_modeDepth[cuGeom.depth].bestMode == &m_modeDepth[cuGeom.depth].pred[PRED_SPLIT];
+    bool bMerge = !cu.isIntra(0) && cu.m_partSize[0] == SIZE_2Nx2N && cu.m_mergeFlag[0];
+
+    m_cuClassifier->dump(cuGeom.depth, features, bSplit, bMerge);
+}
+
 /* returns true if recursion should be stopped */
 bool Analysis::recursionDepthCheck(const CUData& parentCTU, const CUGeom& cuGeom, const Mode& bestMode)
 {
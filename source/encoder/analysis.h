@@ -35,6 +35,7 @@
 
 #include "entropy.h"
 #include "search.h"
+#include "cuclassifier.h"
 
 namespace X265_NS {
 // private namespace
@@ -110,6 +111,8 @@ public:
     bool      m_bChromaSa8d;
     bool      m_bHD;
 
+    CUClassifier* m_cuClassifier;
+
     Analysis();
 
     bool create(ThreadLocalData* tld);
@@ -129,9 +132,16 @@ protected:
     uint32_t m_splitRefIdx[4];
     uint64_t* cacheCost;
 
+    /* min and max CU depth worth analyzing in the current inter CTU */
+    uint32_t m_cuDepthRange[2];
+
     /* refine RD based on QP for rd-levels 5 and 6 */
     void qprdRefine(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp, int32_t lqp);
 
+    /* --static-skip: code a CTU identical to a reference as one skip CU */
+    bool compressStaticCTU(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp);
+    bool isStaticRef(const Frame& refFrame, uint32_t cuAddr, const CUGeom& cuGeom) const;
+
     /* full analysis for an I-slice CU */
     void compressIntraCU(const CUData& parentCTU, const CUGeom& cuGeom, int32_t qp);
 
@@ -163,6 +173,14 @@ protected:
     bool recursionDepthCheck(const CUData& parentCTU, const CUGeom& cuGeom, const Mode& bestMode);
     bool complexityCheckCU(const Mode& bestMode);
 
+    /* content-adaptive CU depth range for the current CTU (--depth-predict) */
+    void predictCUDepthRange(const CUData& ctu, const CUGeom& cuGeom);
+    bool applyAnalysisHints(const CUData& parentCTU, const CUGeom& cuGeom, uint32_t& minDepth, uint32_t& maxDepth);
+
+    /* learned split and merge predictions (--cu-classify) */
+    void getClassifierFeatures(const CUData& parentCTU, const CUGeom& cuGeom, const Mode& mergeMode, double features[]);
+    void dumpClassifierSample(const CUGeom& cuGeom, const double features[], const Mode& bestNonSplit);
+
     /* generate residual and recon pixels for an entire CTU recursively (RD0) */
     void encodeResidue(const CUData& parentCTU, const CUGeom& cuGeom);
 
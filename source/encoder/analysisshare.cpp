@@ -0,0 +1,161 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "frame.h"
+#include "framedata.h"
+#include "picyuv.h"
+#include "cudata.h"
+#include "analysisshare.h"
+
+using namespace X265_NS;
+
+AnalysisShare::AnalysisShare(const x265_param& masterParam)
+{
+    m_head = m_tail = NULL;
+    m_refCount = 1;
+    m_numDependents = 0;
+    m_width = masterParam.sourceWidth;
+    m_height = masterParam.sourceHeight;
+    m_numCUsInFrame = ((m_width + g_maxCUSize - 1) >> g_maxLog2CUSize) * ((m_height + g_maxCUSize - 1) >> g_maxLog2CUSize);
+}
+
+AnalysisShare::~AnalysisShare()
+{
+    while (m_head)
+    {
+        Record* rec = m_head;
+        m_head = rec->next;
+        rec->hints.destroy();
+        delete rec;
+    }
+}
+
+bool AnalysisShare::isCompatible(const x265_param& master, const x265_param& dependent)
+{
+    return master.maxCUSize == dependent.maxCUSize &&
+           master.keyframeMax == dependent.keyframeMax &&
+           master.bOpenGOP == dependent.bOpenGOP &&
+           master.bframes == dependent.bframes &&
+           master.bBPyramid == dependent.bBPyramid &&
+           master.internalCsp == dependent.internalCsp;
+}
+
+void AnalysisShare::addDependent()
+{
+    ScopedLock lock(m_lock);
+    m_refCount++;
+    m_numDependents++;
+}
+
+void AnalysisShare::release()
+{
+    m_lock.acquire();
+    bool bLast = !--m_refCount;
+    m_lock.release();
+
+    if (bLast)
+        delete this;
+}
+
+void AnalysisShare::publish(Frame& frame)
+{
+    if (!m_numDependents)
+        return;
+
+    Record* rec = new Record;
+    if (!rec->hints.create(m_numCUsInFrame, NUM_4x4_PARTITIONS))
+    {
+        /* dependents encode this picture without hints */
+        delete rec;
+        return;
+    }
+    rec->poc = frame.m_poc;
+    rec->sliceType = frame.m_lowres.sliceType;
+    rec->next = NULL;
+
+    uint32_t numPartitions = NUM_4x4_PARTITIONS;
+    for (uint32_t cuAddr = 0; cuAddr < m_numCUsInFrame; cuAddr++)
+    {
+        const CUData* ctu = frame.m_encData->getPicCTU(cuAddr);
+        uint32_t base = cuAddr * numPartitions;
+        memcpy(rec->hints.depth + base, ctu->m_cuDepth, numPartitions);
+        memcpy(rec->hints.predMode + base, ctu->m_predMode, numPartitions);
+        memcpy(rec->hints.lumaIntraDir + base, ctu->m_lumaIntraDir, numPartitions);
+        for (int l = 0; l < 2; l++)
+        {
+            memcpy(rec->hints.mv[l] + base, ctu->m_mv[l], numPartitions * sizeof(MV));
+            for (uint32_t i = 0; i < numPartitions; i++)
+                rec->hints.refIdx[l][base + i] = ctu->isInter(i) ? ctu->m_refIdx[l][i] : REF_NOT_VALID;
+        }
+    }
+
+    ScopedLock lock(m_lock);
+    rec->numPending = m_numDependents;
+    if (m_tail)
+        m_tail->next = rec;
+    else
+        m_head = rec;
+    m_tail = rec;
+}
+
+bool AnalysisShare::consume(Frame& frame, int& sliceType)
+{
+    Record* rec;
+    {
+        ScopedLock lock(m_lock);
+        for (rec = m_head; rec && rec->poc != frame.m_poc; rec = rec->next)
+        {}
+    }
+    if (!rec)
+        return false;
+
+    /* the record cannot be released while this dependent has not consumed it,
+     * so it may be mapped without holding the lock */
+    sliceType = rec->sliceType;
+    AnalysisHints& hints = frame.m_analysisHints;
+    uint32_t dstWidth = frame.m_fencPic->m_picWidth;
+    uint32_t dstHeight = frame.m_fencPic->m_picHeight;
+    uint32_t dstNumCUs = ((dstWidth + g_maxCUSize - 1) >> g_maxLog2CUSize) * ((dstHeight + g_maxCUSize - 1) >> g_maxLog2CUSize);
+    if (hints.depth || hints.create(dstNumCUs, NUM_4x4_PARTITIONS))
+    {
+        hints.scale(rec->hints, m_width, m_height, dstWidth, dstHeight);
+        hints.bValid = true;
+    }
+
+    ScopedLock lock(m_lock);
+    if (!--rec->numPending)
+    {
+        Record** prev = &m_head;
+        Record* last = NULL;
+        while (*prev != rec)
+        {
+            last = *prev;
+            prev = &(*prev)->next;
+        }
+        *prev = rec->next;
+        if (m_tail == rec)
+            m_tail = last;
+        rec->hints.destroy();
+        delete rec;
+    }
+    return true;
+}
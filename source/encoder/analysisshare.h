@@ -0,0 +1,88 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#ifndef X265_ANALYSISSHARE_H
+#define X265_ANALYSISSHARE_H
+
+#include "common.h"
+#include "threading.h"
+#include "frame.h"
+
+namespace X265_NS {
+// private x265 namespace
+
+/* In-process analysis sharing between the renditions of an ABR ladder. The
+ * master encoder publishes the slice type and CU decisions of each picture
+ * it outputs; every dependent encoder consumes them for the same picture,
+ * mapped onto its own resolution, before the picture enters its lookahead.
+ * A record is released once all dependents have consumed it. The object is
+ * reference counted by the master and its dependents, whichever closes last
+ * deletes it. */
+class AnalysisShare
+{
+public:
+
+    AnalysisShare(const x265_param& masterParam);
+
+    /* attach one more dependent encoder */
+    void addDependent();
+
+    /* drop a reference, the last one deletes the object */
+    void release();
+
+    /* master: publish the decisions of an encoded picture */
+    void publish(Frame& frame);
+
+    /* dependent: map the decisions of the picture with the given POC into
+     * frame.m_analysisHints and return the master's slice type. Returns
+     * false if the master has not yet output that picture */
+    bool consume(Frame& frame, int& sliceType);
+
+    /* analysis is only shared between encoders using the same GOP structure
+     * and CTU size (the CTU size is process wide in any case) */
+    static bool isCompatible(const x265_param& master, const x265_param& dependent);
+
+protected:
+
+    struct Record
+    {
+        AnalysisHints hints;
+        int           poc;
+        int           sliceType;
+        int           numPending;      // dependents yet to consume this record
+        Record*       next;
+    };
+
+    Lock     m_lock;
+    Record*  m_head;
+    Record*  m_tail;
+    int      m_refCount;
+    int      m_numDependents;
+
+    uint32_t m_width;                  // master picture size
+    uint32_t m_height;
+    uint32_t m_numCUsInFrame;
+
+    ~AnalysisShare();
+};
+}
+
+#endif // ifndef X265_ANALYSISSHARE_H
@@ -260,6 +260,15 @@ int x265_encoder_intra_refresh(x265_encoder *enc)
     return 0;
 }
 
+int x265_encoder_share_analysis(x265_encoder *master, x265_encoder *dependent)
+{
+    if (!master || !dependent)
+        return -1;
+
+    Encoder *encoder = static_cast<Encoder*>(master);
+    return encoder->shareAnalysis(*static_cast<Encoder*>(dependent));
+}
+
 void x265_cleanup(void)
 {
     if (!g_ctuSizeConfigured)
@@ -333,6 +342,7 @@ static const x265_api libapi =
 
     sizeof(x265_frame_stats),
     &x265_encoder_intra_refresh,
+    &x265_encoder_share_analysis,
 };
 
 typedef const x265_api* (*api_get_func)(int bitDepth);
@@ -0,0 +1,164 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "cuclassifier.h"
+
+using namespace X265_NS;
+
+namespace {
+
+/* compiled-in default model, generated by cutrain --c-table */
+const double s_defaultModel[CUClassifier::NUM_DECISIONS][NUM_CU_DEPTH][CUClassifier::NUM_FEATURES + 1] =
+{
+    { /* split */
+        { -2.467926, 0.396400, 0.582612, -0.749366, -0.112244, 1.787822, -4.510544 },
+        { -6.168518, 0.761780, 0.696593, -0.442076, 0.150189, 2.682168, -5.572454 },
+        { -3.981393, 0.536786, 0.915601, -0.286490, 0.318804, 2.351890, -8.755921 },
+        { 0.000000, 0.000000, 0.000000, 0.000000, 0.000000, 0.000000, 0.000000 },
+    },
+    { /* merge */
+        { 2.133084, -0.538758, -1.153780, 1.489344, 0.383548, -0.747686, 8.208230 },
+        { 1.731814, -0.572855, -1.138976, 1.255645, 0.155857, -0.972140, 9.577051 },
+        { -0.791782, -0.461351, -1.399162, 1.165327, -0.082974, -0.889094, 14.295743 },
+        { 0.000000, 0.000000, 0.000000, 0.000000, 0.000000, 0.000000, 0.000000 },
+    },
+};
+
+const char* const s_decisionNames[CUClassifier::NUM_DECISIONS] = { "split", "merge" };
+
+}
+
+CUClassifier::CUClassifier()
+{
+    memcpy(m_weights, s_defaultModel, sizeof(m_weights));
+    m_dumpFile = NULL;
+}
+
+bool CUClassifier::init(const x265_param& param)
+{
+    if (param.cuClassifyModel && !loadModel(param.cuClassifyModel))
+        return false;
+
+    if (param.cuClassifyDump)
+    {
+        m_dumpFile = fopen(param.cuClassifyDump, "w");
+        if (!m_dumpFile)
+        {
+            x265_log(&param, X265_LOG_ERROR, "CU classifier: unable to open dump file %s\n", param.cuClassifyDump);
+            return false;
+        }
+        fprintf(m_dumpFile, "depth,variance,mergeCost,lowresIntra,lowresRatio,neighDepth,qp,split,merge\n");
+    }
+
+    return true;
+}
+
+void CUClassifier::destroy()
+{
+    if (m_dumpFile)
+        fclose(m_dumpFile);
+    m_dumpFile = NULL;
+}
+
+/* models missing from the file keep their compiled-in weights */
+bool CUClassifier::loadModel(const char* filename)
+{
+    FILE* fp = fopen(filename, "r");
+    if (!fp)
+    {
+        x265_log(NULL, X265_LOG_ERROR, "CU classifier: unable to open model file %s\n", filename);
+        return false;
+    }
+
+    char line[2048];
+    int lineNum = 0;
+    bool bError = false;
+    while (!bError && fgets(line, sizeof(line), fp))
+    {
+        lineNum++;
+        char* comment = strchr(line, '#');
+        if (comment)
+            *comment = 0;
+
+        char* tok = strtok(line, " \t\r\n");
+        if (!tok)
+            continue;
+
+        int decision = -1;
+        for (int i = 0; i < NUM_DECISIONS; i++)
+            if (!strcmp(tok, s_decisionNames[i]))
+                decision = i;
+
+        tok = strtok(NULL, " \t\r\n");
+        int depth = tok ? atoi(tok) : -1;
+        if (decision < 0 || depth < 0 || depth >= NUM_CU_DEPTH)
+        {
+            bError = true;
+            break;
+        }
+
+        for (int i = 0; i <= NUM_FEATURES; i++)
+        {
+            tok = strtok(NULL, " \t\r\n");
+            if (!tok)
+            {
+                bError = true;
+                break;
+            }
+            m_weights[decision][depth][i] = atof(tok);
+        }
+        if (!bError && strtok(NULL, " \t\r\n"))
+            bError = true;
+    }
+    fclose(fp);
+
+    if (bError)
+    {
+        x265_log(NULL, X265_LOG_ERROR, "CU classifier: malformed model file %s at line %d\n", filename, lineNum);
+        return false;
+    }
+
+    return true;
+}
+
+double CUClassifier::predict(Decision decision, uint32_t depth, const double features[NUM_FEATURES]) const
+{
+    const double* w = m_weights[decision][depth];
+    double score = w[0];
+    for (int i = 0; i < NUM_FEATURES; i++)
+        score += w[i + 1] * features[i];
+
+    return 1.0 / (1.0 + exp(-score));
+}
+
+void CUClassifier::dump(uint32_t depth, const double features[NUM_FEATURES], bool bSplit, bool bMerge)
+{
+    char line[256];
+    char* s = line;
+    s += sprintf(s, "%u", depth);
+    for (int i = 0; i < NUM_FEATURES; i++)
+        s += sprintf(s, ",%.4f", features[i]);
+    sprintf(s, ",%d,%d\n", bSplit, bMerge);
+
+    ScopedLock lock(m_dumpLock);
+    fputs(line, m_dumpFile);
+}
@@ -0,0 +1,86 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#ifndef X265_CUCLASSIFIER_H
+#define X265_CUCLASSIFIER_H
+
+#include "common.h"
+#include "threading.h"
+
+namespace X265_NS {
+// private x265 namespace
+
+/* Logistic classifiers predicting, from cheap per-CU features, whether a
+ * CU will end up split and whether its best unsplit mode will be merge or
+ * skip. There is one linear model per decision and CU depth. The models
+ * are trained offline by the cutrain tool from the CSV files written by
+ * --cu-classify-dump; a model trained on a mix of content is compiled in.
+ *
+ * Model file format, one model per line ('#' starts a comment):
+ *   <split|merge> <depth> <bias> <w0> .. <w(NUM_FEATURES-1)> */
+class CUClassifier
+{
+public:
+
+    enum Feature
+    {
+        FEAT_VARIANCE,     // log2(1 + luma variance per pixel)
+        FEAT_MERGE_COST,   // log2(1 + best merge/skip cost per pixel)
+        FEAT_LOWRES_INTRA, // log2(1 + lookahead intra cost per lowres pixel)
+        FEAT_LOWRES_RATIO, // log2 of lookahead inter/intra cost ratio
+        FEAT_NEIGH_DEPTH,  // mean depth of neighbour and co-located CUs minus CU depth
+        FEAT_QP,           // QP / QP_MAX_SPEC
+        NUM_FEATURES
+    };
+
+    enum Decision
+    {
+        SPLIT,
+        MERGE,
+        NUM_DECISIONS
+    };
+
+    /* bias followed by one weight per feature */
+    double m_weights[NUM_DECISIONS][NUM_CU_DEPTH][NUM_FEATURES + 1];
+
+    CUClassifier();
+
+    bool init(const x265_param& param);
+    void destroy();
+
+    /* probability in [0, 1] that the decision is taken */
+    double predict(Decision decision, uint32_t depth, const double features[NUM_FEATURES]) const;
+
+    bool isDumping() const { return !!m_dumpFile; }
+
+    /* append one training sample to the dump file, thread safe */
+    void dump(uint32_t depth, const double features[NUM_FEATURES], bool bSplit, bool bMerge);
+
+protected:
+
+    FILE* m_dumpFile;
+    Lock  m_dumpLock;
+
+    bool loadModel(const char* filename);
+};
+}
+
+#endif // ifndef X265_CUCLASSIFIER_H
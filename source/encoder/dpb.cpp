@@ -58,6 +58,25 @@ DPB::~DPB()
         delete m_frameDataFreeList;
         m_frameDataFreeList = next;
     }
+
+    while (m_blockHashFreeList)
+    {
+        BlockHash* next = m_blockHashFreeList->m_freeListNext;
+        m_blockHashFreeList->destroy();
+        delete m_blockHashFreeList;
+        m_blockHashFreeList = next;
+    }
+}
+
+BlockHash* DPB::getBlockHash()
+{
+    BlockHash* hash = m_blockHashFreeList;
+    if (hash)
+        m_blockHashFreeList = hash->m_freeListNext;
+    else
+        hash = new BlockHash;
+    hash->reset();
+    return hash;
 }
 
 // move unreferenced pictures from picList to freeList for recycle
@@ -85,6 +104,15 @@ void DPB::recycleUnreferenced()
             iterFrame = m_picList.first();
 
             m_freeList.pushBack(*curFrame);
+
+            /* the block hash is only kept while the picture is referenced */
+            if (curFrame->m_encData->m_blockHash)
+            {
+                curFrame->m_encData->m_blockHash->m_freeListNext = m_blockHashFreeList;
+                m_blockHashFreeList = curFrame->m_encData->m_blockHash;
+                curFrame->m_encData->m_blockHash = NULL;
+            }
+
             curFrame->m_encData->m_freeListNext = m_frameDataFreeList;
             m_frameDataFreeList = curFrame->m_encData;
             curFrame->m_encData = NULL;
@@ -167,7 +195,9 @@ void DPB::prepareEncode(Frame *newFrame)
         slice->m_colFromL0Flag = true;
         slice->m_colRefIdx = 0;
     }
-    slice->m_sLFaseFlag = (SLFASE_CONSTANT & (1 << (pocCurr % 31))) > 0;
+    /* with multiple slices, each slice is deblocked and SAO filtered without
+     * the pixels of its neighboring slices */
+    slice->m_sLFaseFlag = newFrame->m_param->maxSlices > 1 ? false : ((SLFASE_CONSTANT & (1 << (pocCurr % 31))) > 0);
 
     /* Increment reference count of all motion-referenced frames to prevent them
      * from being recycled. These counts are decremented at the end of
@@ -29,6 +29,7 @@
 namespace X265_NS {
 // private namespace for x265
 
+class BlockHash;
 class Frame;
 class FrameData;
 class Slice;
@@ -45,6 +46,7 @@ public:
     PicList            m_picList;
     PicList            m_freeList;
     FrameData*         m_frameDataFreeList;
+    BlockHash*         m_blockHashFreeList;
 
     DPB(x265_param *param)
     {
@@ -52,6 +54,7 @@ public:
         m_pocCRA = 0;
         m_bRefreshPending = false;
         m_frameDataFreeList = NULL;
+        m_blockHashFreeList = NULL;
         m_bOpenGOP = param->bOpenGOP;
         m_bTemporalSublayer = !!param->bEnableTemporalSubLayers;
     }
@@ -62,6 +65,9 @@ public:
 
     void recycleUnreferenced();
 
+    /* a block hash table from the free list, or a new one */
+    BlockHash* getBlockHash();
+
 protected:
 
     void computeRPS(int curPoc, bool isRAP, RPS * rps, unsigned int maxDecPicBuffer);
@@ -37,6 +37,7 @@
 #include "ratecontrol.h"
 #include "dpb.h"
 #include "nal.h"
+#include "analysisshare.h"
 
 #include "x265.h"
 
@@ -50,6 +51,21 @@ const char g_sliceTypeToChar[] = {'B', 'P', 'I'};
 
 static const char* defaultAnalysisFileName = "x265_analysis.dat";
 
+/* analysis files begin with a magic word and the version of the frame record
+ * layout, which must be bumped whenever that layout changes */
+static const uint32_t analysisFileMagic = 0x41353632; // "265A"
+static const uint32_t analysisFileVersion = 1;
+static const uint32_t analysisFileHeaderSize = 2 * sizeof(uint32_t);
+
+static bool readAnalysisFileHeader(FILE* fp, uint32_t& version)
+{
+    uint32_t header[2];
+    if (fread(header, sizeof(uint32_t), 2, fp) != 2 || header[0] != analysisFileMagic)
+        return false;
+    version = header[1];
+    return true;
+}
+
 using namespace X265_NS;
 
 Encoder::Encoder()
@@ -73,6 +89,10 @@ Encoder::Encoder()
     m_latestParam = NULL;
     m_threadPool = NULL;
     m_analysisFile = NULL;
+    m_analysisShare = NULL;
+    m_bAnalysisShareMaster = false;
+    m_bAnalysisLoadScaled = false;
+    m_analysisFileWidth = m_analysisFileHeight = 0;
     m_offsetEmergency = NULL;
     for (int i = 0; i < X265_MAX_FRAME_THREADS; i++)
         m_frameEncoder[i] = NULL;
@@ -101,10 +121,47 @@ void Encoder::create()
         p->bEnableWavefront = 0;
     }
 
+    if (p->maxSlices > rows)
+    {
+        x265_log(p, X265_LOG_WARNING, "Too few CTU rows, --slices reduced to %d\n", rows);
+        p->maxSlices = rows;
+    }
+
+    /* every tile column is at least 256 luma samples wide and every tile row
+     * at least 64 luma samples high, in all profiles */
+    int maxTileColumns = X265_MAX(cols / (int)(256 / p->maxCUSize), 1);
+    int maxTileRows = X265_MAX(rows / (int)(64 / p->maxCUSize), 1);
+    if (p->numTileColumns > maxTileColumns)
+    {
+        x265_log(p, X265_LOG_WARNING, "Picture too narrow, --tile-columns reduced to %d\n", maxTileColumns);
+        p->numTileColumns = maxTileColumns;
+    }
+    if (p->numTileRows > maxTileRows)
+    {
+        x265_log(p, X265_LOG_WARNING, "Picture too short, --tile-rows reduced to %d\n", maxTileRows);
+        p->numTileRows = maxTileRows;
+    }
+    if (p->numTileColumns * p->numTileRows > 1)
+    {
+        if (p->bEnableWavefront)
+        {
+            x265_log(p, X265_LOG_WARNING, "Tiles are in use, --wpp disabled\n");
+            p->bEnableWavefront = 0;
+        }
+        /* the non-deblocked statistics of a CTU read pixels of the CTUs to its
+         * right and left, which may belong to tiles not yet encoded */
+        if (p->bEnableSAO && p->bSaoNonDeblocked)
+        {
+            x265_log(p, X265_LOG_WARNING, "Tiles are in use, --sao-non-deblock disabled\n");
+            p->bSaoNonDeblocked = 0;
+        }
+    }
+    bool bTiles = p->numTileColumns * p->numTileRows > 1;
+
     bool allowPools = !p->numaPools || strcmp(p->numaPools, "none");
 
-    // Trim the thread pool if --wpp, --pme, and --pmode are disabled
-    if (!p->bEnableWavefront && !p->bDistributeModeAnalysis && !p->bDistributeMotionEstimation && !p->lookaheadSlices)
+    // Trim the thread pool if tiles, --wpp, --pme, and --pmode are disabled
+    if (!bTiles && !p->bEnableWavefront && !p->bDistributeModeAnalysis && !p->bDistributeMotionEstimation && !p->lookaheadSlices)
         allowPools = false;
 
     if (!p->frameNumThreads)
@@ -125,6 +182,13 @@ void Encoder::create()
             p->frameNumThreads = 1;
     }
 
+    // Sub-frame output hands out the NAL units of one picture before the next starts
+    if (p->nalOutput && p->frameNumThreads > 1)
+    {
+        x265_log(p, X265_LOG_WARNING, "Sub-frame NAL output is in use, --frame-threads reduced to 1\n");
+        p->frameNumThreads = 1;
+    }
+
     m_numPools = 0;
     if (allowPools)
         m_threadPool = ThreadPool::allocThreadPools(p, m_numPools);
@@ -155,6 +219,8 @@ void Encoder::create()
     int len = 0;
     if (p->bEnableWavefront)
         len += sprintf(buf + len, "wpp(%d rows)", rows);
+    if (bTiles && m_numPools)
+        len += sprintf(buf + len, "%stiles(%dx%d)", len ? "+" : "", p->numTileColumns, p->numTileRows);
     if (p->bDistributeModeAnalysis)
         len += sprintf(buf + len, "%spmode", len ? "+" : "");
     if (p->bDistributeMotionEstimation)
@@ -167,7 +233,7 @@ void Encoder::create()
     for (int i = 0; i < m_param->frameNumThreads; i++)
     {
         m_frameEncoder[i] = new FrameEncoder;
-        m_frameEncoder[i]->m_nalList.m_annexB = !!m_param->bAnnexB;
+        m_frameEncoder[i]->m_nalList.init(*m_param);
     }
 
     if (m_numPools)
@@ -292,6 +358,12 @@ void Encoder::create()
     else
         m_scalingList.setupQuantMatrices();
 
+    if (!m_cuClassifier.init(*m_param))
+        m_aborted = true;
+
+    if (m_param->targetFps > 0)
+        m_speedControl.init(*m_param);
+
     int numRows = (m_param->sourceHeight + g_maxCUSize - 1) / g_maxCUSize;
     int numCols = (m_param->sourceWidth  + g_maxCUSize - 1) / g_maxCUSize;
     for (int i = 0; i < m_param->frameNumThreads; i++)
@@ -316,18 +388,42 @@ void Encoder::create()
     if (!m_lookahead->create())
         m_aborted = true;
 
-    if (m_param->analysisMode)
+    if (m_param->analysisMode || m_bAnalysisLoadScaled)
     {
         const char* name = m_param->analysisFileName;
         if (!name)
             name = defaultAnalysisFileName;
-        const char* mode = m_param->analysisMode == X265_ANALYSIS_LOAD ? "rb" : "wb";
+        const char* mode = m_param->analysisMode == X265_ANALYSIS_SAVE ? "wb" : "rb";
         m_analysisFile = fopen(name, mode);
         if (!m_analysisFile)
         {
             x265_log(NULL, X265_LOG_ERROR, "Analysis load/save: failed to open file %s\n", name);
             m_aborted = true;
         }
+        else if (m_param->analysisMode == X265_ANALYSIS_SAVE)
+        {
+            const uint32_t header[2] = { analysisFileMagic, analysisFileVersion };
+            if (fwrite(header, sizeof(uint32_t), 2, m_analysisFile) != 2)
+            {
+                x265_log(NULL, X265_LOG_ERROR, "Analysis save: failed to write file %s\n", name);
+                m_aborted = true;
+            }
+        }
+        else
+        {
+            uint32_t version = 0;
+            if (!readAnalysisFileHeader(m_analysisFile, version))
+            {
+                x265_log(NULL, X265_LOG_ERROR, "Analysis load: %s is not an analysis file of this encoder\n", name);
+                m_aborted = true;
+            }
+            else if (version != analysisFileVersion)
+            {
+                x265_log(NULL, X265_LOG_ERROR, "Analysis load: file %s has version %u, version %u is required\n",
+                         name, version, analysisFileVersion);
+                m_aborted = true;
+            }
+        }
     }
 
     m_bZeroLatency = !m_param->bframes && !m_param->lookaheadDepth && m_param->frameNumThreads == 1;
@@ -336,7 +432,7 @@ void Encoder::create()
 
     m_encodeStartTime = x265_mdate();
 
-    m_nalList.m_annexB = !!m_param->bAnnexB;
+    m_nalList.init(*m_param);
 
     m_emitCLLSEI = p->maxCLL || p->maxFALL;
 }
@@ -406,12 +502,25 @@ void Encoder::destroy()
     if (m_analysisFile)
         fclose(m_analysisFile);
 
+    m_cuClassifier.destroy();
+
+    while (!m_analysisSharePending.empty())
+    {
+        Frame* frame = m_analysisSharePending.popFront();
+        frame->destroy();
+        delete frame;
+    }
+    if (m_analysisShare)
+        m_analysisShare->release();
+
     if (m_param)
     {
         /* release string arguments that were strdup'd */
         free((char*)m_param->rc.lambdaFileName);
         free((char*)m_param->rc.statFileName);
         free((char*)m_param->analysisFileName);
+        free((char*)m_param->cuClassifyModel);
+        free((char*)m_param->cuClassifyDump);
         free((char*)m_param->scalingLists);
         free((char*)m_param->numaPools);
         free((char*)m_param->masteringDisplayColorVolume);
@@ -479,6 +588,51 @@ void Encoder::calcRefreshInterval(Frame* frameEnc)
     }
 }
 
+/* Attach another encoder of the same content (a lower rendition of an ABR
+ * ladder) as a dependent of this one. Both must be idle: no picture may have
+ * been passed to either encoder yet */
+int Encoder::shareAnalysis(Encoder& dependent)
+{
+    if (&dependent == this || m_pocLast >= 0 || dependent.m_pocLast >= 0 ||
+        dependent.m_analysisShare || (m_analysisShare && !m_bAnalysisShareMaster))
+    {
+        x265_log(m_param, X265_LOG_ERROR, "analysis share: encoders must be idle and not already sharing\n");
+        return -1;
+    }
+    if (!AnalysisShare::isCompatible(*m_param, *dependent.m_param))
+    {
+        x265_log(m_param, X265_LOG_ERROR, "analysis share: dependent must use the same CTU size and GOP structure\n");
+        return -1;
+    }
+
+    if (!m_analysisShare)
+    {
+        m_analysisShare = new AnalysisShare(*m_param);
+        m_bAnalysisShareMaster = true;
+    }
+    m_analysisShare->addDependent();
+    dependent.m_analysisShare = m_analysisShare;
+    return 0;
+}
+
+/* Pass held pictures to the lookahead, in input order, as soon as the master
+ * has published their analysis; they take the master's slice type. When
+ * flushing, pictures the master never output are encoded without hints */
+void Encoder::feedSharedAnalysis(bool bFlush)
+{
+    while (!m_analysisSharePending.empty())
+    {
+        Frame* frame = m_analysisSharePending.first();
+        int sliceType = X265_TYPE_AUTO;
+        frame->m_analysisHints.bValid = false;
+        if (!m_analysisShare->consume(*frame, sliceType) && !bFlush)
+            break;
+
+        m_analysisSharePending.popFront();
+        m_lookahead->addPicture(*frame, sliceType);
+    }
+}
+
 /**
  * Feed one new input frame into the encoder, get one frame out. If pic_in is
  * NULL, a flush condition is implied and pic_in must be NULL for all subsequent
@@ -636,11 +790,21 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
             inFrame->m_lowres.bScenecut = !!inFrame->m_analysisData.bScenecut;
             inFrame->m_lowres.satdCost = inFrame->m_analysisData.satdCost;
         }
+        else if (m_bAnalysisLoadScaled)
+            sliceType = loadAnalysisHints(*inFrame);
 
-        m_lookahead->addPicture(*inFrame, sliceType);
+        /* a dependent of an analysis share holds pictures back until the
+         * master has encoded them, see feedSharedAnalysis() */
+        if (m_analysisShare && !m_bAnalysisShareMaster)
+            m_analysisSharePending.pushBack(*inFrame);
+        else
+            m_lookahead->addPicture(*inFrame, sliceType);
         m_numDelayedPic++;
     }
-    else
+
+    if (m_analysisShare && !m_bAnalysisShareMaster)
+        feedSharedAnalysis(!pic_in);
+    if (!pic_in)
         m_lookahead->flush();
 
     FrameEncoder *curEncoder = m_frameEncoder[m_curEncoder];
@@ -670,6 +834,9 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
             if (m_param->analysisMode == X265_ANALYSIS_LOAD)
                 freeAnalysis(&outFrame->m_analysisData);
 
+            if (m_bAnalysisShareMaster)
+                m_analysisShare->publish(*outFrame);
+
             if (pic_out)
             {
                 PicYuv *recpic = outFrame->m_reconPic;
@@ -828,6 +995,22 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
                 m_reconfigure = false;
             }
 
+            /* --target-fps moves between speed levels at keyframes */
+            if (m_param->targetFps > 0 && !m_reconfigure && IS_X265_TYPE_I(frameEnc->m_lowres.sliceType))
+            {
+                bool bInputBound = m_lookahead->m_inputQueue.size() < m_lookahead->m_fullQueueSize;
+                x265_param* level = m_speedControl.update(m_analyzeAll.m_numPics, bInputBound);
+                if (level)
+                {
+                    x265_param save;
+                    memcpy(&save, m_latestParam, sizeof(x265_param));
+                    if (reconfigureParam(m_latestParam, level))
+                        memcpy(m_latestParam, &save, sizeof(x265_param));
+                    else
+                        m_reconfigure = true;
+                }
+            }
+
             /* Initiate reconfigure for this FE if necessary */
             curEncoder->m_param = m_reconfigure ? m_latestParam : m_param;
             curEncoder->m_reconfigure = m_reconfigure;
@@ -851,6 +1034,11 @@ int Encoder::encode(const x265_picture* pic_in, x265_picture* pic_out)
                 slice->m_endCUAddr = slice->realEndAddress(m_sps.numCUsInFrame * NUM_4x4_PARTITIONS);
             }
 
+            /* --hash-me: pictures which will be referenced get a block hash
+             * table, it returns to the DPB with the picture's FrameData */
+            if (m_param->bHashME && IS_REFERENCED(frameEnc))
+                frameEnc->m_encData->m_blockHash = m_dpb->getBlockHash();
+
             curEncoder->m_rce.encodeOrder = frameEnc->m_encodeOrder = m_encodedFrameNum++;
             if (m_bframeDelay)
             {
@@ -904,6 +1092,14 @@ int Encoder::reconfigureParam(x265_param* encParam, x265_param* param)
     encParam->bEnableFastIntra = param->bEnableFastIntra;
     encParam->bEnableEarlySkip = param->bEnableEarlySkip;
     encParam->bEnableRecursionSkip = param->bEnableRecursionSkip;
+    encParam->bEnableRefMVShare = param->bEnableRefMVShare;
+    encParam->cuDepthPredict = param->cuDepthPredict;
+    encParam->cuClassify = param->cuClassify;
+    encParam->frameBudget = param->frameBudget;
+    encParam->limitModes = param->limitModes;
+    encParam->limitReferences = param->limitReferences;
+    if (encParam->bDistributeModeAnalysis && (encParam->limitReferences >> 1))
+        encParam->limitReferences = 0;
     encParam->searchMethod = param->searchMethod;
     /* Scratch buffer prevents me_range from being increased for esa/tesa */
     if (param->searchRange < encParam->searchRange)
@@ -1118,6 +1314,10 @@ void Encoder::printSummary()
     x265_log(m_param, X265_LOG_INFO, "CU: %%%05.2lf time spent in intra RDO, measuring %.3lf intra predictions per CTU\n",
              100.0 * intraRDOTotalTime / totalWorkerTime,
              (double)intraRDOTotalCount / cuStats.totalCTUs);
+    if (cuStats.intraPredCacheLookups)
+        x265_log(m_param, X265_LOG_INFO, "CU: %%%05.2lf intra prediction cache hit rate, %.3lf cacheable intra predictions per CTU\n",
+                 100.0 * cuStats.intraPredCacheHits / cuStats.intraPredCacheLookups,
+                 (double)cuStats.intraPredCacheLookups / cuStats.totalCTUs);
     x265_log(m_param, X265_LOG_INFO, "CU: %%%05.2lf time spent in loop filters, average %.3lf ms per call\n",
              100.0 * cuStats.loopFilterElapsedTime / totalWorkerTime,
              ELAPSED_MSEC(cuStats.loopFilterElapsedTime) / cuStats.countLoopFilter);
@@ -1369,6 +1569,8 @@ void Encoder::finishFrameStats(Frame* curFrame, FrameEncoder *curEncoder, x265_f
         else
             frameStats->avgWPP = 1;
         frameStats->countRowBlocks = curEncoder->m_countRowBlocks;
+        frameStats->maxDegradeLevel = curFrame->m_encData->m_frameStats.maxDegradeLevel;
+        frameStats->percentDegradedCTU = curFrame->m_encData->m_frameStats.percentDegradedCtu;
 
         frameStats->cuStats.percentIntraNxN = curFrame->m_encData->m_frameStats.percentIntraNxN;
         frameStats->avgChromaDistortion     = curFrame->m_encData->m_frameStats.avgChromaDistortion;
@@ -1594,6 +1796,44 @@ void Encoder::initPPS(PPS *pps)
     pps->deblockingFilterTcOffsetDiv2 = m_param->deblockingFilterTCOffset;
 
     pps->bEntropyCodingSyncEnabled = m_param->bEnableWavefront;
+
+    /* uniform spacing, as derived by (6-3) and (6-4) */
+    pps->numTileColumns = m_param->numTileColumns;
+    pps->numTileRows = m_param->numTileRows;
+    for (int i = 0; i <= pps->numTileColumns; i++)
+        pps->tileColBd[i] = i * m_sps.numCuInWidth / pps->numTileColumns;
+    for (int i = 0; i <= pps->numTileRows; i++)
+        pps->tileRowBd[i] = i * m_sps.numCuInHeight / pps->numTileRows;
+}
+
+/* Read the source resolution from the first record of an analysis file */
+static bool peekAnalysisFileSize(const char* name, int& width, int& height, int& numPartitions)
+{
+    FILE* fp = fopen(name, "rb");
+    if (!fp)
+        return false;
+
+    /* a file of another version is rejected when it is opened for loading */
+    uint32_t version;
+    if (!readAnalysisFileHeader(fp, version) || version != analysisFileVersion)
+    {
+        fclose(fp);
+        return false;
+    }
+
+    /* frameRecordSize, depthBytes, poc, sliceType, bScenecut, satdCost(int64), numCUsInFrame, numPartitions */
+    uint8_t header[7 * sizeof(int) + sizeof(int64_t)];
+    int picSize[2];
+    bool bOk = fread(header, 1, sizeof(header), fp) == sizeof(header) &&
+               fread(picSize, sizeof(int), 2, fp) == 2;
+    fclose(fp);
+    if (!bOk)
+        return false;
+
+    memcpy(&numPartitions, header + sizeof(header) - sizeof(int), sizeof(int));
+    width = picSize[0];
+    height = picSize[1];
+    return true;
 }
 
 void Encoder::configure(x265_param *p)
@@ -1639,6 +1879,8 @@ void Encoder::configure(x265_param *p)
         p->bBPyramid = 0;
     if (!p->rdoqLevel)
         p->psyRdoq = 0;
+    if (!p->rdoqLevel || p->rdLevel < 2 || p->rdLevel > 4)
+        p->bApproxRate = 0;
 
     /* Disable features which are not supported by the current RD level */
     if (p->rdLevel < 3)
@@ -1758,6 +2000,38 @@ void Encoder::configure(x265_param *p)
         p->rc.rfConstantMin = 0;
     }
 
+    if (p->analysisMode == X265_ANALYSIS_LOAD)
+    {
+        const char* name = p->analysisFileName ? p->analysisFileName : defaultAnalysisFileName;
+        int width, height, numPartitions;
+        if (peekAnalysisFileSize(name, width, height, numPartitions) &&
+            (width != p->sourceWidth || height != p->sourceHeight))
+        {
+            if (numPartitions != (int)NUM_4x4_PARTITIONS)
+            {
+                x265_log(p, X265_LOG_ERROR, "Analysis load: file %s was saved with a different CTU size\n", name);
+                m_aborted = true;
+            }
+            else
+            {
+                /* decisions made at another resolution cannot be reused as-is,
+                 * they only seed and bound the CU and mode search */
+                x265_log(p, X265_LOG_INFO, "Analysis load: file %s is %dx%d, using its decisions as analysis hints\n",
+                         name, width, height);
+                m_bAnalysisLoadScaled = true;
+                m_analysisFileWidth = width;
+                m_analysisFileHeight = height;
+                p->analysisMode = X265_ANALYSIS_OFF;
+            }
+        }
+    }
+
+    if (p->analysisMode && p->bStaticSkip)
+    {
+        x265_log(p, X265_LOG_WARNING, "Analysis load/save options incompatible with static-skip, Disabling static-skip\n");
+        p->bStaticSkip = 0;
+    }
+
     if (p->analysisMode && (p->bDistributeModeAnalysis || p->bDistributeMotionEstimation))
     {
         x265_log(p, X265_LOG_WARNING, "Analysis load/save options incompatible with pmode/pme, Disabling pmode/pme\n");
@@ -2005,6 +2279,11 @@ void Encoder::allocAnalysis(x265_analysis_data* analysis)
         CHECKED_MALLOC(interData->modes, uint8_t, analysis->numPartitions * analysis->numCUsInFrame);
         CHECKED_MALLOC(interData->partSize, uint8_t, analysis->numPartitions * analysis->numCUsInFrame);
         CHECKED_MALLOC(interData->mergeFlag, uint8_t, analysis->numPartitions * analysis->numCUsInFrame);
+        for (int dir = 0; dir < numDir; dir++)
+        {
+            CHECKED_MALLOC(interData->mv[dir], MV, analysis->numPartitions * analysis->numCUsInFrame);
+            CHECKED_MALLOC(interData->refIdx[dir], int8_t, analysis->numPartitions * analysis->numCUsInFrame);
+        }
         CHECKED_MALLOC_ZERO(interData->wt, WeightParam, 3 * numDir);
         analysis->interData = interData;
     }
@@ -2024,8 +2303,9 @@ void Encoder::freeAnalysis(x265_analysis_data* analysis)
         X265_FREE(((analysis_intra_data*)analysis->intraData)->partSizes);
         X265_FREE(((analysis_intra_data*)analysis->intraData)->chromaModes);
         X265_FREE(analysis->intraData);
+        analysis->intraData = NULL;
     }
-    else
+    else if (analysis->interData)
     {
         X265_FREE(((analysis_inter_data*)analysis->interData)->ref);
         X265_FREE(((analysis_inter_data*)analysis->interData)->depth);
@@ -2033,7 +2313,13 @@ void Encoder::freeAnalysis(x265_analysis_data* analysis)
         X265_FREE(((analysis_inter_data*)analysis->interData)->mergeFlag);
         X265_FREE(((analysis_inter_data*)analysis->interData)->partSize);
         X265_FREE(((analysis_inter_data*)analysis->interData)->wt);
+        for (int dir = 0; dir < 2; dir++)
+        {
+            X265_FREE(((analysis_inter_data*)analysis->interData)->mv[dir]);
+            X265_FREE(((analysis_inter_data*)analysis->interData)->refIdx[dir]);
+        }
         X265_FREE(analysis->interData);
+        analysis->interData = NULL;
     }
 }
 
@@ -2049,8 +2335,8 @@ void Encoder::readAnalysisFile(x265_analysis_data* analysis, int curPoc)
         return;\
     }\
 
-    static uint64_t consumedBytes = 0;
-    static uint64_t totalConsumedBytes = 0;
+    static uint64_t consumedBytes = analysisFileHeaderSize;
+    static uint64_t totalConsumedBytes = analysisFileHeaderSize;
     uint32_t depthBytes = 0;
     fseeko(m_analysisFile, totalConsumedBytes, SEEK_SET);
 
@@ -2086,6 +2372,8 @@ void Encoder::readAnalysisFile(x265_analysis_data* analysis, int curPoc)
     X265_FREAD(&analysis->satdCost, sizeof(int64_t), 1, m_analysisFile);
     X265_FREAD(&analysis->numCUsInFrame, sizeof(int), 1, m_analysisFile);
     X265_FREAD(&analysis->numPartitions, sizeof(int), 1, m_analysisFile);
+    int picSize[2]; // source resolution, checked by configure()
+    X265_FREAD(picSize, sizeof(int), 2, m_analysisFile);
 
     /* Memory is allocated for inter and intra analysis data based on the slicetype */
     allocAnalysis(analysis);
@@ -2139,12 +2427,41 @@ void Encoder::readAnalysisFile(x265_analysis_data* analysis, int curPoc)
             count += bytes;
         }
 
-        X265_FREE(tempBuf);
-
         int numDir = analysis->sliceType == X265_TYPE_P ? 1 : 2;
-        X265_FREAD(((analysis_inter_data *)analysis->interData)->ref, sizeof(int32_t), analysis->numCUsInFrame * X265_MAX_PRED_MODE_PER_CTU * numDir, m_analysisFile);
+        /* read errors are handled once tempBuf is no longer needed */
+        size_t refCount = analysis->numCUsInFrame * X265_MAX_PRED_MODE_PER_CTU * numDir;
         uint32_t numPlanes = m_param->internalCsp == X265_CSP_I400 ? 1 : 3;
-        X265_FREAD(((analysis_inter_data *)analysis->interData)->wt, sizeof(WeightParam), numPlanes * numDir, m_analysisFile);
+        bool bReadError = fread(((analysis_inter_data *)analysis->interData)->ref, sizeof(int32_t), refCount, m_analysisFile) != refCount ||
+                          fread(((analysis_inter_data *)analysis->interData)->wt, sizeof(WeightParam), numPlanes * numDir, m_analysisFile) != numPlanes * numDir;
+
+        /* one motion vector and reference index per CU and list */
+        MV* mvBuf = X265_MALLOC(MV, depthBytes);
+        int8_t* refBuf = X265_MALLOC(int8_t, depthBytes);
+        for (int dir = 0; dir < numDir && !bReadError; dir++)
+        {
+            bReadError = fread(mvBuf, sizeof(MV), depthBytes, m_analysisFile) != depthBytes ||
+                         fread(refBuf, sizeof(int8_t), depthBytes, m_analysisFile) != depthBytes;
+            count = 0;
+            for (uint32_t d = 0; d < depthBytes && !bReadError; d++)
+            {
+                int bytes = analysis->numPartitions >> (depthBuf[d] * 2);
+                for (int i = 0; i < bytes; i++)
+                    ((analysis_inter_data *)analysis->interData)->mv[dir][count + i] = mvBuf[d];
+                memset(&((analysis_inter_data *)analysis->interData)->refIdx[dir][count], refBuf[d], bytes);
+                count += bytes;
+            }
+        }
+        X265_FREE(mvBuf);
+        X265_FREE(refBuf);
+        X265_FREE(tempBuf);
+        if (bReadError)
+        {
+            x265_log(NULL, X265_LOG_ERROR, "Error reading analysis data\n");
+            freeAnalysis(analysis);
+            m_aborted = true;
+            return;
+        }
+
         consumedBytes += frameRecordSize;
         if (numDir == 1)
             totalConsumedBytes = consumedBytes;
@@ -2152,6 +2469,69 @@ void Encoder::readAnalysisFile(x265_analysis_data* analysis, int curPoc)
 #undef X265_FREAD
 }
 
+/* Map the decisions of an analysis file saved at another resolution onto
+ * frame.m_analysisHints and return the slice type of the saved picture */
+int Encoder::loadAnalysisHints(Frame& frame)
+{
+    AnalysisHints& hints = frame.m_analysisHints;
+    hints.bValid = false;
+
+    x265_analysis_data analysis;
+    memset(&analysis, 0, sizeof(analysis));
+    readAnalysisFile(&analysis, frame.m_poc);
+    if (!analysis.intraData && !analysis.interData)
+        return X265_TYPE_AUTO;
+
+    AnalysisHints src;
+    uint32_t numParts = analysis.numPartitions;
+    uint32_t numSrcParts = analysis.numCUsInFrame * numParts;
+    if (src.create(analysis.numCUsInFrame, numParts))
+    {
+        if (analysis.sliceType == X265_TYPE_I)
+        {
+            analysis_intra_data* intraData = (analysis_intra_data*)analysis.intraData;
+            memcpy(src.depth, intraData->depth, numSrcParts);
+            memset(src.predMode, MODE_INTRA, numSrcParts);
+            memcpy(src.lumaIntraDir, intraData->modes, numSrcParts);
+            for (int l = 0; l < 2; l++)
+                memset(src.refIdx[l], REF_NOT_VALID, numSrcParts);
+        }
+        else
+        {
+            analysis_inter_data* interData = (analysis_inter_data*)analysis.interData;
+            int numDir = analysis.sliceType == X265_TYPE_P ? 1 : 2;
+            memcpy(src.depth, interData->depth, numSrcParts);
+            for (uint32_t i = 0; i < numSrcParts; i++)
+                src.predMode[i] = interData->modes[i] == 4 ? (uint8_t)MODE_INTER : interData->modes[i];
+            memset(src.lumaIntraDir, ALL_IDX, numSrcParts);
+            for (int l = 0; l < 2; l++)
+            {
+                if (l < numDir)
+                {
+                    memcpy(src.mv[l], interData->mv[l], numSrcParts * sizeof(MV));
+                    memcpy(src.refIdx[l], interData->refIdx[l], numSrcParts);
+                }
+                else
+                    memset(src.refIdx[l], REF_NOT_VALID, numSrcParts);
+            }
+        }
+
+        uint32_t widthInCU = (m_param->sourceWidth + g_maxCUSize - 1) >> g_maxLog2CUSize;
+        uint32_t heightInCU = (m_param->sourceHeight + g_maxCUSize - 1) >> g_maxLog2CUSize;
+        if (hints.depth || hints.create(widthInCU * heightInCU, NUM_4x4_PARTITIONS))
+        {
+            hints.scale(src, m_analysisFileWidth, m_analysisFileHeight, m_param->sourceWidth, m_param->sourceHeight);
+            hints.bValid = true;
+        }
+        src.destroy();
+    }
+
+    int sliceType = analysis.sliceType;
+    frame.m_lowres.bScenecut = !!analysis.bScenecut;
+    freeAnalysis(&analysis);
+    return sliceType;
+}
+
 void Encoder::writeAnalysisFile(x265_analysis_data* analysis, FrameData &curEncData)
 {
 
@@ -2203,6 +2583,7 @@ void Encoder::writeAnalysisFile(x265_analysis_data* analysis, FrameData &curEncD
 
             CUData* ctu = curEncData.getPicCTU(cuAddr);
             analysis_inter_data* interDataCTU = (analysis_inter_data*)analysis->interData;
+            int numDir = analysis->sliceType == X265_TYPE_P ? 1 : 2;
 
             for (uint32_t absPartIdx = 0; absPartIdx < ctu->m_numPartitions; depthBytes++)
             {
@@ -2221,6 +2602,13 @@ void Encoder::writeAnalysisFile(x265_analysis_data* analysis, FrameData &curEncD
                 mergeFlag = ctu->m_mergeFlag[absPartIdx];
                 interDataCTU->mergeFlag[depthBytes] = mergeFlag;
 
+                for (int dir = 0; dir < numDir; dir++)
+                {
+                    bool bUsed = ctu->isInter(absPartIdx) && ctu->m_refIdx[dir][absPartIdx] >= 0;
+                    interDataCTU->mv[dir][depthBytes] = bUsed ? ctu->m_mv[dir][absPartIdx] : MV(0, 0);
+                    interDataCTU->refIdx[dir][depthBytes] = bUsed ? ctu->m_refIdx[dir][absPartIdx] : REF_NOT_VALID;
+                }
+
                 absPartIdx += ctu->m_numPartitions >> (depth * 2);
             }
         }
@@ -2228,7 +2616,8 @@ void Encoder::writeAnalysisFile(x265_analysis_data* analysis, FrameData &curEncD
 
     /* calculate frameRecordSize */
     analysis->frameRecordSize = sizeof(analysis->frameRecordSize) + sizeof(depthBytes) + sizeof(analysis->poc) + sizeof(analysis->sliceType) +
-                      sizeof(analysis->numCUsInFrame) + sizeof(analysis->numPartitions) + sizeof(analysis->bScenecut) + sizeof(analysis->satdCost);
+                      sizeof(analysis->numCUsInFrame) + sizeof(analysis->numPartitions) + sizeof(analysis->bScenecut) + sizeof(analysis->satdCost) +
+                      sizeof(int) * 2;
     if (analysis->sliceType == X265_TYPE_IDR || analysis->sliceType == X265_TYPE_I)
         analysis->frameRecordSize += sizeof(uint8_t)* analysis->numCUsInFrame * analysis->numPartitions + depthBytes * 3;
     else
@@ -2237,6 +2626,7 @@ void Encoder::writeAnalysisFile(x265_analysis_data* analysis, FrameData &curEncD
         analysis->frameRecordSize += depthBytes * 4;
         analysis->frameRecordSize += sizeof(int32_t)* analysis->numCUsInFrame * X265_MAX_PRED_MODE_PER_CTU * numDir;
         analysis->frameRecordSize += sizeof(WeightParam)* 3 * numDir;
+        analysis->frameRecordSize += (sizeof(MV) + sizeof(int8_t)) * depthBytes * numDir;
     }
     X265_FWRITE(&analysis->frameRecordSize, sizeof(uint32_t), 1, m_analysisFile);
     X265_FWRITE(&depthBytes, sizeof(uint32_t), 1, m_analysisFile);
@@ -2246,6 +2636,8 @@ void Encoder::writeAnalysisFile(x265_analysis_data* analysis, FrameData &curEncD
     X265_FWRITE(&analysis->satdCost, sizeof(int64_t), 1, m_analysisFile);
     X265_FWRITE(&analysis->numCUsInFrame, sizeof(int), 1, m_analysisFile);
     X265_FWRITE(&analysis->numPartitions, sizeof(int), 1, m_analysisFile);
+    int picSize[2] = { m_param->sourceWidth, m_param->sourceHeight };
+    X265_FWRITE(picSize, sizeof(int), 2, m_analysisFile);
 
     if (analysis->sliceType == X265_TYPE_IDR || analysis->sliceType == X265_TYPE_I)
     {
@@ -2264,6 +2656,11 @@ void Encoder::writeAnalysisFile(x265_analysis_data* analysis, FrameData &curEncD
         X265_FWRITE(((analysis_inter_data*)analysis->interData)->ref, sizeof(int32_t), analysis->numCUsInFrame * X265_MAX_PRED_MODE_PER_CTU * numDir, m_analysisFile);
         uint32_t numPlanes = m_param->internalCsp == X265_CSP_I400 ? 1 : 3;
         X265_FWRITE(((analysis_inter_data*)analysis->interData)->wt, sizeof(WeightParam), numPlanes * numDir, m_analysisFile);
+        for (int dir = 0; dir < numDir; dir++)
+        {
+            X265_FWRITE(((analysis_inter_data*)analysis->interData)->mv[dir], sizeof(MV), depthBytes, m_analysisFile);
+            X265_FWRITE(((analysis_inter_data*)analysis->interData)->refIdx[dir], sizeof(int8_t), depthBytes, m_analysisFile);
+        }
     }
 #undef X265_FWRITE
 }
@@ -2283,6 +2680,12 @@ void Encoder::printReconfigureParams()
     TOOLCMP(oldParam->bEnableFastIntra, newParam->bEnableFastIntra, "fast-intra=%d to %d\n");
     TOOLCMP(oldParam->bEnableEarlySkip, newParam->bEnableEarlySkip, "early-skip=%d to %d\n");
     TOOLCMP(oldParam->bEnableRecursionSkip, newParam->bEnableRecursionSkip, "rskip=%d to %d\n");
+    TOOLCMP(oldParam->bEnableRefMVShare, newParam->bEnableRefMVShare, "ref-mv-share=%d to %d\n");
+    TOOLCMP(oldParam->cuDepthPredict, newParam->cuDepthPredict, "depth-predict=%d to %d\n");
+    TOOLCMP(oldParam->cuClassify, newParam->cuClassify, "cu-classify=%d to %d\n");
+    TOOLCMP(oldParam->frameBudget, newParam->frameBudget, "frame-budget=%.1f to %.1f\n");
+    TOOLCMP(oldParam->limitModes, newParam->limitModes, "limit-modes=%d to %d\n");
+    TOOLCMP(oldParam->limitReferences, newParam->limitReferences, "limit-refs=%d to %d\n");
     TOOLCMP(oldParam->searchMethod, newParam->searchMethod, "me=%d to %d\n");
     TOOLCMP(oldParam->searchRange, newParam->searchRange, "merange=%d to %d\n");
     TOOLCMP(oldParam->subpelRefine, newParam->subpelRefine, "subme= %d to %d\n");
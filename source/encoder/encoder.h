@@ -29,6 +29,9 @@
 #include "scalinglist.h"
 #include "x265.h"
 #include "nal.h"
+#include "piclist.h"
+#include "cuclassifier.h"
+#include "speedcontrol.h"
 
 struct x265_encoder {};
 
@@ -75,6 +78,7 @@ class Lookahead;
 class RateControl;
 class ThreadPool;
 class FrameData;
+class AnalysisShare;
 
 class Encoder : public x265_encoder
 {
@@ -114,6 +118,10 @@ public:
     x265_param*        m_latestParam;     // Holds latest param during a reconfigure
     RateControl*       m_rateControl;
     Lookahead*         m_lookahead;
+    CUClassifier       m_cuClassifier;
+    SpeedControl       m_speedControl;     // --target-fps
+    AnalysisShare*     m_analysisShare;    // analysis shared between the renditions of an ABR ladder
+    PicList            m_analysisSharePending; // dependent: pictures waiting for the master's analysis
 
     /* Collect statistics globally */
     EncStats           m_analyzeAll;
@@ -131,6 +139,10 @@ public:
     bool               m_bZeroLatency;     // x265_encoder_encode() returns NALs for the input picture, zero lag
     bool               m_aborted;          // fatal error detected
     bool               m_reconfigure;      // Encoder reconfigure in progress
+    bool               m_bAnalysisShareMaster; // publishes its analysis to m_analysisShare
+    bool               m_bAnalysisLoadScaled;  // analysis file saved at another resolution, loaded as hints
+    int                m_analysisFileWidth;
+    int                m_analysisFileHeight;
 
     /* Begin intra refresh when one not in progress or else begin one as soon as the current 
      * one is done. Requires bIntraRefresh to be set.*/
@@ -169,10 +181,16 @@ public:
 
     void writeAnalysisFile(x265_analysis_data* pic, FrameData &curEncData);
 
+    int loadAnalysisHints(Frame& frame);
+
     void finishFrameStats(Frame* pic, FrameEncoder *curEncoder, x265_frame_stats* frameStats, int inPoc);
 
     void calcRefreshInterval(Frame* frameEnc);
 
+    int shareAnalysis(Encoder& dependent);
+
+    void feedSharedAnalysis(bool bFlush);
+
 protected:
 
     void initVPS(VPS *vps);
@@ -226,6 +226,7 @@ Entropy::Entropy()
     markValid();
     m_fracBits = 0;
     m_pad = 0;
+    m_estBitsCache = NULL;
     X265_CHECK(sizeof(m_contextState) >= sizeof(m_contextState[0]) * MAX_OFF_CTX_MOD, "context state table is too small\n");
 }
 
@@ -351,8 +352,15 @@ void Entropy::codePPS(const PPS& pps)
     WRITE_FLAG(pps.bUseWeightPred,            "weighted_pred_flag");
     WRITE_FLAG(pps.bUseWeightedBiPred,        "weighted_bipred_flag");
     WRITE_FLAG(pps.bTransquantBypassEnabled,  "transquant_bypass_enable_flag");
-    WRITE_FLAG(0,                             "tiles_enabled_flag");
+    WRITE_FLAG(pps.numTileColumns * pps.numTileRows > 1, "tiles_enabled_flag");
     WRITE_FLAG(pps.bEntropyCodingSyncEnabled, "entropy_coding_sync_enabled_flag");
+    if (pps.numTileColumns * pps.numTileRows > 1)
+    {
+        WRITE_UVLC(pps.numTileColumns - 1,    "num_tile_columns_minus1");
+        WRITE_UVLC(pps.numTileRows - 1,       "num_tile_rows_minus1");
+        WRITE_FLAG(1,                         "uniform_spacing_flag");
+        WRITE_FLAG(1,                         "loop_filter_across_tiles_enabled_flag");
+    }
     WRITE_FLAG(1,                             "loop_filter_across_slices_enabled_flag");
 
     WRITE_FLAG(pps.bDeblockingFilterControlPresent, "deblocking_filter_control_present_flag");
@@ -570,14 +578,23 @@ void Entropy::codeAUD(const Slice& slice)
     WRITE_CODE(picType, 3, "pic_type");
 }
 
-void Entropy::codeSliceHeader(const Slice& slice, FrameData& encData)
+void Entropy::codeSliceHeader(const Slice& slice, FrameData& encData, uint32_t sliceAddr)
 {
-    WRITE_FLAG(1, "first_slice_segment_in_pic_flag");
+    WRITE_FLAG(!sliceAddr, "first_slice_segment_in_pic_flag");
     if (slice.getRapPicFlag())
         WRITE_FLAG(0, "no_output_of_prior_pics_flag");
 
     WRITE_UVLC(0, "slice_pic_parameter_set_id");
 
+    if (sliceAddr)
+    {
+        /* Ceil(Log2(PicSizeInCtbsY)) bits */
+        uint32_t addrBits = 0;
+        while ((1U << addrBits) < slice.m_sps->numCUsInFrame)
+            addrBits++;
+        WRITE_CODE(sliceAddr, addrBits, "slice_segment_address");
+    }
+
     /* x265 does not use dependent slices, so always write all this data */
 
     WRITE_UVLC(slice.m_sliceType, "slice_type");
@@ -667,8 +684,8 @@ void Entropy::codeSliceHeader(const Slice& slice, FrameData& encData)
         WRITE_FLAG(slice.m_sLFaseFlag, "slice_loop_filter_across_slices_enabled_flag");
 }
 
-/** write wavefront substreams sizes for the slice header */
-void Entropy::codeSliceHeaderWPPEntryPoints(const Slice& slice, const uint32_t *substreamSizes, uint32_t maxOffset)
+/** write wavefront or tile substreams sizes for the slice header */
+void Entropy::codeSliceHeaderWPPEntryPoints(const uint32_t *substreamSizes, uint32_t numSubStreams, uint32_t maxOffset)
 {
     uint32_t offsetLen = 1;
     while (maxOffset >= (1U << offsetLen))
@@ -677,12 +694,12 @@ void Entropy::codeSliceHeaderWPPEntryPoints(const Slice& slice, const uint32_t *
         X265_CHECK(offsetLen < 32, "offsetLen is too large\n");
     }
 
-    uint32_t numRows = slice.m_sps->numCuInHeight - 1;
-    WRITE_UVLC(numRows, "num_entry_point_offsets");
-    if (numRows > 0)
+    uint32_t numEntryPoints = numSubStreams - 1;
+    WRITE_UVLC(numEntryPoints, "num_entry_point_offsets");
+    if (numEntryPoints > 0)
         WRITE_UVLC(offsetLen - 1, "offset_len_minus1");
 
-    for (uint32_t i = 0; i < numRows; i++)
+    for (uint32_t i = 0; i < numEntryPoints; i++)
         WRITE_CODE(substreamSizes[i] - 1, offsetLen, "entry_point_offset_minus1");
 }
 
@@ -839,9 +856,7 @@ uint32_t Entropy::bitsInterMode(const CUData& cu, uint32_t absPartIdx, uint32_t
 void Entropy::finishCU(const CUData& ctu, uint32_t absPartIdx, uint32_t depth, bool bCodeDQP)
 {
     const Slice* slice = ctu.m_slice;
-    uint32_t realEndAddress = slice->m_endCUAddr;
     uint32_t cuAddr = ctu.getSCUAddr() + absPartIdx;
-    X265_CHECK(realEndAddress == slice->realEndAddress(slice->m_endCUAddr), "real end address expected\n");
 
     uint32_t granularityMask = g_maxCUSize - 1;
     uint32_t cuSize = 1 << ctu.m_log2CUSize[absPartIdx];
@@ -855,9 +870,9 @@ void Entropy::finishCU(const CUData& ctu, uint32_t absPartIdx, uint32_t depth, b
 
     if (granularityBoundary)
     {
-        // Encode slice finish
+        // Encode slice finish, the slice ends with the last coded CU of its last CTU
         bool bTerminateSlice = false;
-        if (cuAddr + (NUM_4x4_PARTITIONS >> (depth << 1)) == realEndAddress)
+        if (ctu.m_bLastCuInSlice && cuAddr + (NUM_4x4_PARTITIONS >> (depth << 1)) == slice->realEndAddress((ctu.m_cuAddr + 1) * NUM_4x4_PARTITIONS))
             bTerminateSlice = true;
 
         // The 1-terminating bit is added to all streams, so don't add it here when it's 1.
@@ -2158,8 +2173,52 @@ void Entropy::codeSaoMaxUvlc(uint32_t code, uint32_t maxSymbol)
     }
 }
 
+/* returns true if no state has moved further than maxDrift probability steps */
+static bool similarContexts(const uint8_t* a, const uint8_t* b, int numCtx, int maxDrift)
+{
+    for (int i = 0; i < numCtx; i++)
+    {
+        /* the low bit of a state is the MPS, which must not change */
+        int delta = a[i] - b[i];
+        if ((delta & 1) || abs(delta) > 2 * maxDrift)
+            return false;
+    }
+
+    return true;
+}
+
 /* estimate bit cost for CBP, significant map and significant coefficients */
 void Entropy::estBit(EstBitsSbac& estBitsSbac, uint32_t log2TrSize, bool bIsLuma) const
+{
+    if (m_estBitsCache && &estBitsSbac == &m_estBitsSbac)
+    {
+        EstBitsSbacCache& cache = *m_estBitsCache;
+        EstBitsSbacCache::Entry& entry = cache.entry[bIsLuma][log2TrSize - 2];
+        const uint8_t* ctx = &m_contextState[EstBitsSbacCache::CTX_BEGIN];
+        const int numCtx = EstBitsSbacCache::CTX_END - EstBitsSbacCache::CTX_BEGIN;
+
+        if (entry.bValid && (cache.maxStateDrift ? similarContexts(entry.contextState, ctx, numCtx, cache.maxStateDrift)
+                                                 : !memcmp(entry.contextState, ctx, numCtx)))
+        {
+            if (cache.loaded != &entry)
+            {
+                memcpy(&estBitsSbac, &entry.bits, sizeof(EstBitsSbac));
+                cache.loaded = &entry;
+            }
+            return;
+        }
+
+        estBitNoCache(estBitsSbac, log2TrSize, bIsLuma);
+        memcpy(&entry.bits, &estBitsSbac, sizeof(EstBitsSbac));
+        memcpy(entry.contextState, ctx, numCtx);
+        entry.bValid = true;
+        cache.loaded = &entry;
+    }
+    else
+        estBitNoCache(estBitsSbac, log2TrSize, bIsLuma);
+}
+
+void Entropy::estBitNoCache(EstBitsSbac& estBitsSbac, uint32_t log2TrSize, bool bIsLuma) const
 {
     estCBFBit(estBitsSbac);
 
@@ -2349,6 +2408,9 @@ void Entropy::start()
 
 void Entropy::finish()
 {
+    if (m_bitsLeft >= 0)
+        writeOut();
+
     if (m_low >> (21 + m_bitsLeft))
     {
         m_bitIf->writeByte(m_bufferedByte + 1);
@@ -2371,7 +2433,7 @@ void Entropy::finish()
             m_numBufferedBytes--;
         }
     }
-    m_bitIf->write(m_low >> 8, 13 + m_bitsLeft);
+    m_bitIf->write((uint32_t)(m_low >> 8), 13 + m_bitsLeft);
 }
 
 void Entropy::copyState(const Entropy& other)
@@ -2395,102 +2457,6 @@ void Entropy::resetBits()
         m_bitIf->resetBits();
 }
 
-/** Encode bin */
-void Entropy::encodeBin(uint32_t binValue, uint8_t &ctxModel)
-{
-    uint32_t mstate = ctxModel;
-
-    ctxModel = sbacNext(mstate, binValue);
-
-    if (!m_bitIf)
-    {
-        m_fracBits += sbacGetEntropyBits(mstate, binValue);
-        return;
-    }
-
-    uint32_t range = m_range;
-    uint32_t state = sbacGetState(mstate);
-    uint32_t lps = g_lpsTable[state][((uint8_t)range >> 6)];
-    range -= lps;
-
-    X265_CHECK(lps >= 2, "lps is too small\n");
-
-    int numBits = (uint32_t)(range - 256) >> 31;
-    uint32_t low = m_low;
-
-    // NOTE: MPS must be LOWEST bit in mstate
-    X265_CHECK((uint32_t)((binValue ^ mstate) & 1) == (uint32_t)(binValue != sbacGetMps(mstate)), "binValue failure\n");
-    if ((binValue ^ mstate) & 1)
-    {
-        // NOTE: lps is non-zero and the maximum of idx is 8 because lps less than 256
-        //numBits = g_renormTable[lps >> 3];
-        unsigned long idx;
-        CLZ(idx, lps);
-        X265_CHECK(state != 63 || idx == 1, "state failure\n");
-
-        numBits = 8 - idx;
-        if (state >= 63)
-            numBits = 6;
-        X265_CHECK(numBits <= 6, "numBits failure\n");
-
-        low += range;
-        range = lps;
-    }
-    m_low = (low << numBits);
-    m_range = (range << numBits);
-    m_bitsLeft += numBits;
-
-    if (m_bitsLeft >= 0)
-        writeOut();
-}
-
-/** Encode equiprobable bin */
-void Entropy::encodeBinEP(uint32_t binValue)
-{
-    if (!m_bitIf)
-    {
-        m_fracBits += 32768;
-        return;
-    }
-    m_low <<= 1;
-    if (binValue)
-        m_low += m_range;
-    m_bitsLeft++;
-
-    if (m_bitsLeft >= 0)
-        writeOut();
-}
-
-/** Encode equiprobable bins */
-void Entropy::encodeBinsEP(uint32_t binValues, int numBins)
-{
-    if (!m_bitIf)
-    {
-        m_fracBits += 32768 * numBins;
-        return;
-    }
-
-    while (numBins > 8)
-    {
-        numBins -= 8;
-        uint32_t pattern = binValues >> numBins;
-        m_low <<= 8;
-        m_low += m_range * pattern;
-        binValues -= pattern << numBins;
-        m_bitsLeft += 8;
-
-        if (m_bitsLeft >= 0)
-            writeOut();
-    }
-
-    m_low <<= numBins;
-    m_low += m_range * binValues;
-    m_bitsLeft += numBins;
-
-    if (m_bitsLeft >= 0)
-        writeOut();
-}
-
 /** Encode terminating bin */
 void Entropy::encodeBinTrm(uint32_t binValue)
 {
@@ -2517,40 +2483,59 @@ void Entropy::encodeBinTrm(uint32_t binValue)
         m_bitsLeft++;
     }
 
-    if (m_bitsLeft >= 0)
+    if (m_bitsLeft >= CABAC_FLUSH_BITS)
         writeOut();
 }
 
-/** Move bits from register into bitstream */
-void Entropy::writeOut()
+/* gather output bytes so they reach the bitstream four at a time */
+inline void Entropy::writeOutByte(uint32_t byte, uint32_t& pending, int& numPending)
 {
-    uint32_t leadByte = m_low >> (13 + m_bitsLeft);
-    uint32_t low_mask = (uint32_t)(~0) >> (11 + 8 - m_bitsLeft);
+    pending = (pending << 8) | (byte & 0xff);
+    if (++numPending == 4)
+    {
+        m_bitIf->write(pending, 32);
+        pending = 0;
+        numPending = 0;
+    }
+}
 
-    m_bitsLeft -= 8;
-    m_low &= low_mask;
+/** Move all resolved bytes from register into bitstream */
+void Entropy::writeOut()
+{
+    uint32_t pending = 0;
+    int numPending = 0;
 
-    if (leadByte == 0xff)
-        m_numBufferedBytes++;
-    else
+    do
     {
-        uint32_t numBufferedBytes = m_numBufferedBytes;
-        if (numBufferedBytes > 0)
-        {
-            uint32_t carry = leadByte >> 8;
-            uint32_t byteTowrite = m_bufferedByte + carry;
-            m_bitIf->writeByte(byteTowrite);
+        uint32_t leadByte = (uint32_t)(m_low >> (13 + m_bitsLeft));
+        m_low &= ((uint64_t)1 << (13 + m_bitsLeft)) - 1;
+        m_bitsLeft -= 8;
 
-            byteTowrite = (0xff + carry) & 0xff;
-            while (numBufferedBytes > 1)
+        if (leadByte == 0xff)
+            m_numBufferedBytes++;
+        else
+        {
+            int numBufferedBytes = m_numBufferedBytes;
+            if (numBufferedBytes > 0)
             {
-                m_bitIf->writeByte(byteTowrite);
-                numBufferedBytes--;
+                uint32_t carry = leadByte >> 8;
+                writeOutByte(m_bufferedByte + carry, pending, numPending);
+
+                uint32_t byteTowrite = (0xff + carry) & 0xff;
+                while (numBufferedBytes > 1)
+                {
+                    writeOutByte(byteTowrite, pending, numPending);
+                    numBufferedBytes--;
+                }
             }
+            m_numBufferedBytes = 1;
+            m_bufferedByte = (uint8_t)leadByte;
         }
-        m_numBufferedBytes = 1;
-        m_bufferedByte = (uint8_t)leadByte;
     }
+    while (m_bitsLeft >= 0);
+
+    if (numPending)
+        m_bitIf->write(pending, numPending * 8);
 }
 
 const uint32_t g_entropyBits[128] =
@@ -96,6 +96,36 @@ struct EstBitsSbac
     int blockRootCbpBits[2];
 };
 
+/* estBit() tables of each TU size and plane type, with the residual coding
+ * context states each was estimated from. A table is re-estimated only when
+ * those contexts have changed; by any amount, or in approximate mode only
+ * once some state has moved more than maxStateDrift probability steps */
+struct EstBitsSbacCache
+{
+    enum { CTX_BEGIN = OFF_QT_CBF_CTX, CTX_END = OFF_MVP_IDX_CTX };
+
+    struct Entry
+    {
+        EstBitsSbac bits;
+        uint8_t     contextState[CTX_END - CTX_BEGIN];
+        bool        bValid;
+    };
+
+    Entry        entry[2][4];   // [bIsLuma][log2TrSize - 2]
+    const Entry* loaded;        // entry last copied to the destination table
+    int          maxStateDrift; // 0 for exact estimates
+
+    EstBitsSbacCache() { memset(this, 0, sizeof(*this)); }
+
+    void invalidate()
+    {
+        for (int i = 0; i < 2; i++)
+            for (int j = 0; j < 4; j++)
+                entry[i][j].bValid = false;
+        loaded = NULL;
+    }
+};
+
 class Entropy : public SyntaxElementWriter
 {
 public:
@@ -103,14 +133,19 @@ public:
     uint64_t      m_pad;
     uint8_t       m_contextState[160]; // MAX_OFF_CTX_MOD + padding
 
-    /* CABAC state */
-    uint32_t      m_low;
+    /* CABAC state, bytes are resolved from m_low once m_bitsLeft reaches
+     * CABAC_FLUSH_BITS so several are written out together. m_low never
+     * exceeds 2^(22 + m_bitsLeft), so the 16 bypass bins encodeBinsEP adds at
+     * once keep it within 64 bits */
+    enum { CABAC_FLUSH_BITS = 24 };
+    uint64_t      m_low;
     uint32_t      m_range;
     uint32_t      m_bufferedByte;
     int           m_numBufferedBytes;
     int           m_bitsLeft;
     uint64_t      m_fracBits;
     EstBitsSbac   m_estBitsSbac;
+    EstBitsSbacCache* m_estBitsCache; /* optional, owned by the user of m_estBitsSbac */
 
     Entropy();
 
@@ -147,8 +182,8 @@ public:
     void codeAUD(const Slice& slice);
     void codeHrdParameters(const HRDInfo& hrd, int maxSubTLayers);
 
-    void codeSliceHeader(const Slice& slice, FrameData& encData);
-    void codeSliceHeaderWPPEntryPoints(const Slice& slice, const uint32_t *substreamSizes, uint32_t maxOffset);
+    void codeSliceHeader(const Slice& slice, FrameData& encData, uint32_t sliceAddr);
+    void codeSliceHeaderWPPEntryPoints(const uint32_t *substreamSizes, uint32_t numSubStreams, uint32_t maxOffset);
     void codeShortTermRefPicSet(const RPS& rps);
     void finishSlice()                 { encodeBinTrm(1); finish(); dynamic_cast<Bitstream*>(m_bitIf)->writeByteAlignment(); }
 
@@ -187,6 +222,7 @@ public:
 
     /* RDO functions */
     void estBit(EstBitsSbac& estBitsSbac, uint32_t log2TrSize, bool bIsLuma) const;
+    void estBitNoCache(EstBitsSbac& estBitsSbac, uint32_t log2TrSize, bool bIsLuma) const;
     void estCBFBit(EstBitsSbac& estBitsSbac) const;
     void estSignificantCoeffGroupMapBit(EstBitsSbac& estBitsSbac, bool bIsLuma) const;
     void estSignificantMapBit(EstBitsSbac& estBitsSbac, uint32_t log2TrSize, bool bIsLuma) const;
@@ -227,6 +263,7 @@ private:
     void finishCU(const CUData& ctu, uint32_t absPartIdx, uint32_t depth, bool bEncodeDQP);
 
     void writeOut();
+    void writeOutByte(uint32_t byte, uint32_t& pending, int& numPending);
 
     /* SBac private methods */
     void writeUnaryMaxSymbol(uint32_t symbol, uint8_t* scmModel, int offset, uint32_t maxSymbol);
@@ -255,6 +292,103 @@ private:
     void copyFrom(const Entropy& src);
     void copyContextsFrom(const Entropy& src);
 };
+
+/* The bin coders are inline so they do not cost a call per bin, the
+ * library is built position independent and would not inline them otherwise */
+
+/** Encode bin */
+inline void Entropy::encodeBin(uint32_t binValue, uint8_t &ctxModel)
+{
+    uint32_t mstate = ctxModel;
+
+    ctxModel = sbacNext(mstate, binValue);
+
+    if (!m_bitIf)
+    {
+        m_fracBits += sbacGetEntropyBits(mstate, binValue);
+        return;
+    }
+
+    uint32_t range = m_range;
+    uint32_t state = sbacGetState(mstate);
+    uint32_t lps = g_lpsTable[state][((uint8_t)range >> 6)];
+    range -= lps;
+
+    X265_CHECK(lps >= 2, "lps is too small\n");
+
+    int numBits = (uint32_t)(range - 256) >> 31;
+    uint64_t low = m_low;
+
+    // NOTE: MPS must be LOWEST bit in mstate
+    X265_CHECK((uint32_t)((binValue ^ mstate) & 1) == (uint32_t)(binValue != sbacGetMps(mstate)), "binValue failure\n");
+    if ((binValue ^ mstate) & 1)
+    {
+        // NOTE: lps is non-zero and the maximum of idx is 8 because lps less than 256
+        //numBits = g_renormTable[lps >> 3];
+        unsigned long idx;
+        CLZ(idx, lps);
+        X265_CHECK(state != 63 || idx == 1, "state failure\n");
+
+        numBits = 8 - idx;
+        if (state >= 63)
+            numBits = 6;
+        X265_CHECK(numBits <= 6, "numBits failure\n");
+
+        low += range;
+        range = lps;
+    }
+    m_low = (low << numBits);
+    m_range = (range << numBits);
+    m_bitsLeft += numBits;
+
+    if (m_bitsLeft >= CABAC_FLUSH_BITS)
+        writeOut();
+}
+
+/** Encode equiprobable bin */
+inline void Entropy::encodeBinEP(uint32_t binValue)
+{
+    if (!m_bitIf)
+    {
+        m_fracBits += 32768;
+        return;
+    }
+    m_low <<= 1;
+    if (binValue)
+        m_low += m_range;
+    m_bitsLeft++;
+
+    if (m_bitsLeft >= CABAC_FLUSH_BITS)
+        writeOut();
+}
+
+/** Encode equiprobable bins, up to 16 per renormalisation */
+inline void Entropy::encodeBinsEP(uint32_t binValues, int numBins)
+{
+    if (!m_bitIf)
+    {
+        m_fracBits += 32768 * numBins;
+        return;
+    }
+
+    while (numBins > 16)
+    {
+        numBins -= 16;
+        uint32_t pattern = binValues >> numBins;
+        m_low = (m_low << 16) + (uint64_t)m_range * pattern;
+        binValues -= pattern << numBins;
+        m_bitsLeft += 16;
+
+        if (m_bitsLeft >= CABAC_FLUSH_BITS)
+            writeOut();
+    }
+
+    m_low = (m_low << numBins) + (uint64_t)m_range * binValues;
+    m_bitsLeft += numBins;
+
+    if (m_bitsLeft >= CABAC_FLUSH_BITS)
+        writeOut();
+}
 }
 
 #endif // ifndef X265_ENTROPY_H
@@ -38,6 +38,24 @@
 namespace X265_NS {
 void weightAnalyse(Slice& slice, Frame& frame, x265_param& param);
 
+static bool isSamePicture(const PicYuv& a, const PicYuv& b)
+{
+    int numPlanes = a.m_picCsp == X265_CSP_I400 ? 1 : 3;
+    for (int plane = 0; plane < numPlanes; plane++)
+    {
+        uint32_t width = plane ? a.m_picWidth >> a.m_hChromaShift : a.m_picWidth;
+        uint32_t height = plane ? a.m_picHeight >> a.m_vChromaShift : a.m_picHeight;
+        intptr_t stride = plane ? a.m_strideC : a.m_stride;
+        const pixel* pa = a.m_picOrg[plane];
+        const pixel* pb = b.m_picOrg[plane];
+        for (uint32_t y = 0; y < height; y++, pa += stride, pb += stride)
+            if (memcmp(pa, pb, width * sizeof(pixel)))
+                return false;
+    }
+
+    return true;
+}
+
 FrameEncoder::FrameEncoder()
 {
     m_prevOutputTime = x265_mdate();
@@ -47,13 +65,24 @@ FrameEncoder::FrameEncoder()
     m_slicetypeWaitTime = 0;
     m_activeWorkerCount = 0;
     m_completionCount = 0;
-    m_bAllRowsStop = false;
-    m_vbvResetTriggerRow = -1;
+    m_numRowsFinished = 0;
+    m_numSlicesOutput = 0;
+    m_numNalOutput = 0;
+    for (int i = 0; i < X265_MAX_SLICES; i++)
+    {
+        m_bAllRowsStop[i] = false;
+        m_vbvResetTriggerRow[i] = -1;
+    }
     m_outStreams = NULL;
     m_substreamSizes = NULL;
     m_nr = NULL;
     m_tld = NULL;
     m_rows = NULL;
+    m_numTileCols = 1;
+    m_numTiles = 1;
+    m_tileColBd = NULL;
+    m_tileRowBd = NULL;
+    m_bRowJobs = false;
     m_top = NULL;
     m_param = NULL;
     m_frame = NULL;
@@ -91,6 +120,7 @@ void FrameEncoder::destroy()
     X265_FREE(m_nr);
 
     m_frameFilter.destroy();
+    m_blockHashScratch.destroy();
 
     if (m_param->bEmitHRDSEI || !!m_param->interlaceMode)
     {
@@ -110,9 +140,32 @@ bool FrameEncoder::init(Encoder *top, int numRows, int numCols)
                         || (!m_param->bEnableLoopFilter && m_param->bEnableSAO)) ?
                         2 : (m_param->bEnableSAO || m_param->bEnableLoopFilter ? 1 : 0);
     m_filterRowDelayCus = m_filterRowDelay * numCols;
-    m_rows = new CTURow[m_numRows];
+    m_numTileCols = top->m_pps.numTileColumns;
+    m_numTiles = m_numTileCols * top->m_pps.numTileRows;
+    m_tileColBd = top->m_pps.tileColBd;
+    m_tileRowBd = top->m_pps.tileRowBd;
+    m_rows = new CTURow[m_numRows * m_numTileCols];
     bool ok = !!m_numRows;
 
+    /* each slice is a band of whole CTU rows, sized as evenly as possible */
+    for (int i = 0; i <= m_param->maxSlices; i++)
+        m_sliceBaseRow[i] = (uint32_t)((uint64_t)m_numRows * i / m_param->maxSlices);
+
+    /* with tiles, m_rows holds the segment of each row within each tile column */
+    for (int sliceId = 0, tileRow = 0; sliceId < m_param->maxSlices; sliceId++)
+    {
+        for (uint32_t row = m_sliceBaseRow[sliceId]; row < m_sliceBaseRow[sliceId + 1]; row++)
+        {
+            if (row == m_tileRowBd[tileRow + 1])
+                tileRow++;
+            for (uint32_t tileCol = 0; tileCol < m_numTileCols; tileCol++)
+            {
+                m_rows[row * m_numTileCols + tileCol].sliceId = sliceId;
+                m_rows[row * m_numTileCols + tileCol].tileId = tileRow * m_numTileCols + tileCol;
+            }
+        }
+    }
+
     /* determine full motion search range */
     int range  = m_param->searchRange;       /* fpel search */
     range += !!(m_param->searchMethod < 2);  /* diamond/hex range check lag */
@@ -120,15 +173,22 @@ bool FrameEncoder::init(Encoder *top, int numRows, int numCols)
     range += 2 + MotionEstimate::hpelIterationCount(m_param->subpelRefine) / 2; /* subpel refine steps */
     m_refLagRows = 1 + ((range + g_maxCUSize - 1) / g_maxCUSize);
 
-    // NOTE: 2 times of numRows because both Encoder and Filter in same queue
-    if (!WaveFront::init(m_numRows * 2))
+    // NOTE: the encoder jobs of every tile column and the filter of each row share the queue
+    if (!WaveFront::init(m_numRows * (m_numTileCols + 1)))
     {
         x265_log(m_param, X265_LOG_ERROR, "unable to initialize wavefront queue\n");
         m_pool = NULL;
     }
+    m_bRowJobs = m_pool && (m_param->bEnableWavefront || m_numTiles > 1);
 
     m_frameFilter.init(top, this, numRows, numCols);
 
+    if (m_param->bHashME)
+    {
+        m_blockHashBuild.m_frameEncoder = this;
+        ok &= m_blockHashScratch.create(m_param->sourceWidth, m_param->sourceHeight);
+    }
+
     // initialize HRD parameters of SPS
     if (m_param->bEmitHRDSEI || !!m_param->interlaceMode)
     {
@@ -252,6 +312,7 @@ void FrameEncoder::threadMain()
             {
                 m_tld[i].analysis.initSearch(*m_param, m_top->m_scalingList);
                 m_tld[i].analysis.create(m_tld);
+                m_tld[i].analysis.m_cuClassifier = &m_top->m_cuClassifier;
             }
 
             for (int i = 0; i < m_pool->m_numProviders; i++)
@@ -274,6 +335,7 @@ void FrameEncoder::threadMain()
         m_tld = new ThreadLocalData;
         m_tld->analysis.initSearch(*m_param, m_top->m_scalingList);
         m_tld->analysis.create(NULL);
+        m_tld->analysis.m_cuClassifier = &m_top->m_cuClassifier;
         m_localTldIdx = 0;
     }
 
@@ -294,6 +356,20 @@ void FrameEncoder::WeightAnalysis::processTasks(int /* workerThreadId */)
     weightAnalyse(*frame->m_encData->m_slice, *frame, *master.m_param);
 }
 
+void FrameEncoder::BlockHashBuild::processTasks(int /* workerThreadId */)
+{
+    m_lock.acquire();
+    bool bClaimed = m_jobAcquired < m_jobTotal;
+    m_jobAcquired = m_jobTotal;
+    m_lock.release();
+
+    if (bClaimed)
+    {
+        FrameData& encData = *m_frameEncoder->m_frame->m_encData;
+        encData.m_blockHash->build(*m_frameEncoder->m_frame->m_fencPic, m_frameEncoder->m_blockHashScratch);
+    }
+}
+
 void FrameEncoder::compressFrame()
 {
     ProfileScopeEvent(frameThread);
@@ -304,12 +380,21 @@ void FrameEncoder::compressFrame()
     m_totalWorkerElapsedTime = 0;
     m_totalNoWorkerTime = 0;
     m_countRowBlocks = 0;
+    m_budgetCTUsDone = 0;
     m_allRowsAvailableTime = 0;
     m_stallStartTime = 0;
+    if (m_param->frameBudget > 0)
+        initDegradedParams();
 
     m_completionCount = 0;
-    m_bAllRowsStop = false;
-    m_vbvResetTriggerRow = -1;
+    m_numRowsFinished = 0;
+    m_numSlicesOutput = 0;
+    m_numNalOutput = 0;
+    for (int i = 0; i < m_param->maxSlices; i++)
+    {
+        m_bAllRowsStop[i] = false;
+        m_vbvResetTriggerRow[i] = -1;
+    }
 
     m_SSDY = m_SSDU = m_SSDV = 0;
     m_ssim = 0;
@@ -392,6 +477,37 @@ void FrameEncoder::compressFrame()
 
     }
 
+    /* a picture repeating the source of its first reference is static in
+     * every CTU, the per-CTU comparison with that reference can be skipped */
+    m_frame->m_bDuplicate = m_param->bStaticSkip && numPredDir && isSamePicture(*m_frame->m_fencPic, *slice->m_refFrameList[0][0]->m_fencPic);
+
+    /* --hash-me: the source of a picture which will be referenced is indexed
+     * by an idle worker while its CTU rows are coded. When no worker is idle
+     * this thread indexes it before enqueuing any row, so that the frame
+     * encoders of later pictures are not held back behind this one */
+    if (m_param->bHashME)
+    {
+        m_blockHashBuild.m_jobTotal = !!m_frame->m_encData->m_blockHash;
+        m_blockHashBuild.m_jobAcquired = 0;
+        if (m_blockHashBuild.m_jobTotal)
+        {
+            bool bBonded = m_pool && m_blockHashBuild.tryBondPeers(*this, 1);
+            if (!bBonded)
+                m_blockHashBuild.processTasks(-1);
+        }
+
+        /* motion search needs the complete index of each reference */
+        for (int l = 0; l < numPredDir; l++)
+        {
+            for (int ref = 0; ref < slice->m_numRefIdx[l]; ref++)
+            {
+                BlockHash* refHash = slice->m_refFrameList[l][ref]->m_encData->m_blockHash;
+                if (refHash)
+                    refHash->waitForBuild();
+            }
+        }
+    }
+
     int numTLD;
     if (m_pool)
         numTLD = m_param->bEnableWavefront ? m_pool->m_numWorkers : m_pool->m_numWorkers + m_pool->m_numProviders;
@@ -446,17 +562,18 @@ void FrameEncoder::compressFrame()
 
     /* reset entropy coders */
     m_entropyCoder.load(m_initSliceContext);
-    for (uint32_t i = 0; i < m_numRows; i++)
+    for (uint32_t i = 0; i < m_numRows * m_numTileCols; i++)
         m_rows[i].init(m_initSliceContext);
 
-    uint32_t numSubstreams = m_param->bEnableWavefront ? slice->m_sps->numCuInHeight : 1;
+    /* with WPP each row is a substream, otherwise each slice or tile is one */
+    uint32_t numSubstreams = m_param->bEnableWavefront ? slice->m_sps->numCuInHeight : m_param->maxSlices * m_numTiles;
     if (!m_outStreams)
     {
         m_outStreams = new Bitstream[numSubstreams];
         m_substreamSizes = X265_MALLOC(uint32_t, numSubstreams);
         if (!m_param->bEnableSAO)
-            for (uint32_t i = 0; i < numSubstreams; i++)
-                m_rows[i].rowGoOnCoder.setBitstream(&m_outStreams[i]);
+            for (uint32_t i = 0; i < m_numRows * m_numTileCols; i++)
+                m_rows[i].rowGoOnCoder.setBitstream(&m_outStreams[m_param->bEnableWavefront ? i : m_rows[i].sliceId * m_numTiles + m_rows[i].tileId]);
     }
     else
         for (uint32_t i = 0; i < numSubstreams; i++)
@@ -540,8 +657,7 @@ void FrameEncoder::compressFrame()
      * compressed in a wave-front pattern if WPP is enabled. Row based loop
      * filters runs behind the CTU compression and reconstruction */
 
-    m_rows[0].active = true;
-    if (m_param->bEnableWavefront)
+    if (m_bRowJobs)
     {
         for (uint32_t row = 0; row < m_numRows; row++)
         {
@@ -561,11 +677,18 @@ void FrameEncoder::compressFrame()
                 }
             }
 
-            enableRowEncoder(row); /* clear external dependency for this row */
             if (!row)
-            {
                 m_row0WaitTime = x265_mdate();
-                enqueueRowEncoder(0); /* clear internal dependency, start wavefront */
+            for (uint32_t tileCol = 0; tileCol < m_numTileCols; tileCol++)
+            {
+                CTURow& curRow = m_rows[row * m_numTileCols + tileCol];
+                enableRowEncoder(row, tileCol); /* clear external dependency for this row */
+                if (row == m_sliceBaseRow[curRow.sliceId] || row == m_tileRowBd[curRow.tileId / m_numTileCols])
+                {
+                    /* clear internal dependency, start wavefront of this slice or the first row of this tile */
+                    curRow.active = true;
+                    enqueueRowEncoder(row, tileCol);
+                }
             }
             tryWakeOne();
         }
@@ -604,7 +727,8 @@ void FrameEncoder::compressFrame()
                     m_row0WaitTime = x265_mdate();
                 else if (i == m_numRows - 1)
                     m_allRowsAvailableTime = x265_mdate();
-                processRowEncoder(i, m_tld[m_localTldIdx]);
+                for (uint32_t tileCol = 0; tileCol < m_numTileCols; tileCol++)
+                    processRowEncoder(i, tileCol, m_tld[m_localTldIdx]);
             }
 
             // filter
@@ -613,12 +737,15 @@ void FrameEncoder::compressFrame()
         }
     }
 
+    if (m_param->bHashME)
+        m_blockHashBuild.waitForExit();
+
     if (m_param->rc.bStatWrite)
     {
         int totalI = 0, totalP = 0, totalSkip = 0;
 
         // accumulate intra,inter,skip cu count per frame for 2 pass
-        for (uint32_t i = 0; i < m_numRows; i++)
+        for (uint32_t i = 0; i < m_numRows * m_numTileCols; i++)
         {
             m_frame->m_encData->m_frameStats.mvBits    += m_rows[i].rowStats.mvBits;
             m_frame->m_encData->m_frameStats.coeffBits += m_rows[i].rowStats.coeffBits;
@@ -632,7 +759,7 @@ void FrameEncoder::compressFrame()
         m_frame->m_encData->m_frameStats.percent8x8Inter = (double)totalP / totalCuCount;
         m_frame->m_encData->m_frameStats.percent8x8Skip  = (double)totalSkip / totalCuCount;
     }
-    for (uint32_t i = 0; i < m_numRows; i++)
+    for (uint32_t i = 0; i < m_numRows * m_numTileCols; i++)
     {
         m_frame->m_encData->m_frameStats.cntIntraNxN      += m_rows[i].rowStats.cntIntraNxN;
         m_frame->m_encData->m_frameStats.totalCu          += m_rows[i].rowStats.totalCu;
@@ -641,6 +768,8 @@ void FrameEncoder::compressFrame()
         m_frame->m_encData->m_frameStats.chromaDistortion += m_rows[i].rowStats.chromaDistortion;
         m_frame->m_encData->m_frameStats.psyEnergy        += m_rows[i].rowStats.psyEnergy;
         m_frame->m_encData->m_frameStats.resEnergy        += m_rows[i].rowStats.resEnergy;
+        m_frame->m_encData->m_frameStats.cntDegradedCtu   += m_rows[i].rowStats.cntDegradedCtu;
+        m_frame->m_encData->m_frameStats.maxDegradeLevel   = X265_MAX(m_frame->m_encData->m_frameStats.maxDegradeLevel, m_rows[i].rowStats.maxDegradeLevel);
         for (uint32_t depth = 0; depth <= g_maxCUDepth; depth++)
         {
             m_frame->m_encData->m_frameStats.cntSkipCu[depth] += m_rows[i].rowStats.cntSkipCu[depth];
@@ -656,6 +785,7 @@ void FrameEncoder::compressFrame()
     m_frame->m_encData->m_frameStats.avgPsyEnergy        = (double)(m_frame->m_encData->m_frameStats.psyEnergy) / m_frame->m_encData->m_frameStats.totalCtu;
     m_frame->m_encData->m_frameStats.avgResEnergy        = (double)(m_frame->m_encData->m_frameStats.resEnergy) / m_frame->m_encData->m_frameStats.totalCtu;
     m_frame->m_encData->m_frameStats.percentIntraNxN     = (double)(m_frame->m_encData->m_frameStats.cntIntraNxN * 100) / m_frame->m_encData->m_frameStats.totalCu;
+    m_frame->m_encData->m_frameStats.percentDegradedCtu  = (double)(m_frame->m_encData->m_frameStats.cntDegradedCtu * 100) / m_frame->m_encData->m_frameStats.totalCtu;
     for (uint32_t depth = 0; depth <= g_maxCUDepth; depth++)
     {
         m_frame->m_encData->m_frameStats.percentSkipCu[depth]  = (double)(m_frame->m_encData->m_frameStats.cntSkipCu[depth] * 100) / m_frame->m_encData->m_frameStats.totalCu;
@@ -669,25 +799,11 @@ void FrameEncoder::compressFrame()
         m_frame->m_encData->m_frameStats.percentInterDistribution[depth][2] = (double)(m_frame->m_encData->m_frameStats.cuInterDistribution[depth][3] * 100) / m_frame->m_encData->m_frameStats.totalCu;
     }
 
-    m_bs.resetBits();
-    m_entropyCoder.load(m_initSliceContext);
-    m_entropyCoder.setBitstream(&m_bs);
-    m_entropyCoder.codeSliceHeader(*slice, *m_frame->m_encData);
-
-    // finish encode of each CTU row, only required when SAO is enabled
-    if (m_param->bEnableSAO)
-        encodeSlice();
-
-    // serialize each row, record final lengths in slice header
-    uint32_t maxStreamSize = m_nalList.serializeSubstreams(m_substreamSizes, numSubstreams, m_outStreams);
+    // the hash SEI and the frame stats need the metrics of every row
+    m_frameFilter.finishRowMetrics();
 
-    // complete the slice header by writing WPP row-starts
-    m_entropyCoder.setBitstream(&m_bs);
-    if (slice->m_pps->bEntropyCodingSyncEnabled)
-        m_entropyCoder.codeSliceHeaderWPPEntryPoints(*slice, m_substreamSizes, maxStreamSize);
-    m_bs.writeByteAlignment();
-
-    m_nalList.serialize(slice->m_nalUnitType, m_bs);
+    // serialize the slices which were not output while the picture was encoded
+    outputSlices(m_numRows);
 
     if (m_param->decodedPictureHashSEI)
     {
@@ -718,6 +834,12 @@ void FrameEncoder::compressFrame()
         m_nalList.serialize(NAL_UNIT_SUFFIX_SEI, m_bs);
     }
 
+    if (m_param->nalOutput)
+    {
+        m_param->nalOutput(m_param->nalOutputOpaque, m_nalList.m_nal + m_numNalOutput, m_nalList.m_numNal - m_numNalOutput, m_frame->m_pts, 1);
+        m_numNalOutput = m_nalList.m_numNal;
+    }
+
     uint64_t bytes = 0;
     for (uint32_t i = 0; i < m_nalList.m_numNal; i++)
     {
@@ -791,73 +913,136 @@ void FrameEncoder::compressFrame()
     m_endFrameTime = x265_mdate();
 }
 
-void FrameEncoder::encodeSlice()
+void FrameEncoder::outputSlices(uint32_t endRow)
 {
+    ScopedLock outputLock(m_sliceOutputLock);
+
     Slice* slice = m_frame->m_encData->m_slice;
-    const uint32_t widthInLCUs = slice->m_sps->numCuInWidth;
-    const uint32_t lastCUAddr = (slice->m_endCUAddr + NUM_4x4_PARTITIONS - 1) / NUM_4x4_PARTITIONS;
-    const uint32_t numSubstreams = m_param->bEnableWavefront ? slice->m_sps->numCuInHeight : 1;
+    uint32_t firstSlice = m_numSlicesOutput;
 
-    SAOParam* saoParam = slice->m_sps->bUseSAO ? m_frame->m_encData->m_saoParam : NULL;
-    for (uint32_t cuAddr = 0; cuAddr < lastCUAddr; cuAddr++)
+    while (m_numSlicesOutput < (uint32_t)m_param->maxSlices && m_sliceBaseRow[m_numSlicesOutput + 1] <= endRow)
     {
-        uint32_t col = cuAddr % widthInLCUs;
-        uint32_t lin = cuAddr / widthInLCUs;
-        uint32_t subStrm = lin % numSubstreams;
-        CUData* ctu = m_frame->m_encData->getPicCTU(cuAddr);
+        uint32_t sliceId = m_numSlicesOutput++;
+        uint32_t baseRow = m_sliceBaseRow[sliceId];
 
-        m_entropyCoder.setBitstream(&m_outStreams[subStrm]);
+        // finish encode of each CTU row, only required when SAO is enabled
+        if (m_param->bEnableSAO)
+            encodeSlice(sliceId);
 
-        // Synchronize cabac probabilities with upper-right CTU if it's available and we're at the start of a line.
-        if (m_param->bEnableWavefront && !col && lin)
-        {
-            m_entropyCoder.copyState(m_initSliceContext);
-            m_entropyCoder.loadContexts(m_rows[lin - 1].bufferedEntropy);
-        }
+        m_bs.resetBits();
+        m_entropyCoder.load(m_initSliceContext);
+        m_entropyCoder.setBitstream(&m_bs);
+        m_entropyCoder.codeSliceHeader(*slice, *m_frame->m_encData, baseRow * m_numCols);
+
+        // serialize each row or tile of the slice, record final lengths in slice header
+        uint32_t firstStream = m_param->bEnableWavefront ? baseRow : sliceId * m_numTiles;
+        uint32_t sliceStreams = m_param->bEnableWavefront ? m_sliceBaseRow[sliceId + 1] - baseRow : m_numTiles;
+        uint32_t maxStreamSize = m_nalList.serializeSubstreams(m_substreamSizes + firstStream, sliceStreams, m_outStreams + firstStream);
+
+        // complete the slice header by writing WPP row-starts or tile starts
+        m_entropyCoder.setBitstream(&m_bs);
+        if (slice->m_pps->bEntropyCodingSyncEnabled || m_numTiles > 1)
+            m_entropyCoder.codeSliceHeaderWPPEntryPoints(m_substreamSizes + firstStream, sliceStreams, maxStreamSize);
+        m_bs.writeByteAlignment();
 
-        if (saoParam)
+        m_nalList.serialize(slice->m_nalUnitType, m_bs);
+    }
+
+    if (m_param->nalOutput && m_numSlicesOutput > firstSlice)
+    {
+        m_param->nalOutput(m_param->nalOutputOpaque, m_nalList.m_nal + m_numNalOutput, m_nalList.m_numNal - m_numNalOutput, m_frame->m_pts, 0);
+        m_numNalOutput = m_nalList.m_numNal;
+    }
+}
+
+void FrameEncoder::encodeSlice(uint32_t sliceId)
+{
+    Slice* slice = m_frame->m_encData->m_slice;
+    const uint32_t widthInLCUs = slice->m_sps->numCuInWidth;
+    const uint32_t sliceBaseRow = m_sliceBaseRow[sliceId];
+    const uint32_t sliceEndRow = m_sliceBaseRow[sliceId + 1];
+
+    SAOParam* saoParam = slice->m_sps->bUseSAO ? m_frame->m_encData->m_saoParam : NULL;
+
+    /* CTUs are coded in tile scan, each tile in turn in raster order. A
+     * slice holds either whole tiles or CTU rows of the only tile */
+    for (uint32_t tileId = 0; tileId < m_numTiles; tileId++)
+    {
+        const uint32_t tileCol = tileId % m_numTileCols;
+        const uint32_t tileRow = tileId / m_numTileCols;
+        const uint32_t tileWidth = m_tileColBd[tileCol + 1] - m_tileColBd[tileCol];
+        const uint32_t beginRow = X265_MAX(sliceBaseRow, m_tileRowBd[tileRow]);
+        const uint32_t endRow = X265_MIN(sliceEndRow, m_tileRowBd[tileRow + 1]);
+        if (beginRow >= endRow)
+            continue;
+        const uint32_t tileCUs = tileWidth * (endRow - beginRow);
+
+        for (uint32_t i = 0; i < tileCUs; i++)
         {
-            if (saoParam->bSaoFlag[0] || saoParam->bSaoFlag[1])
+            uint32_t col = m_tileColBd[tileCol] + i % tileWidth;
+            uint32_t lin = beginRow + i / tileWidth;
+            uint32_t cuAddr = lin * widthInLCUs + col;
+            uint32_t subStrm = m_param->bEnableWavefront ? lin : m_rows[lin * m_numTileCols + tileCol].sliceId * m_numTiles + tileId;
+            CUData* ctu = m_frame->m_encData->getPicCTU(cuAddr);
+
+            m_entropyCoder.setBitstream(&m_outStreams[subStrm]);
+
+            // Each slice and each tile starts from the initial contexts
+            if (ctu->m_bFirstColInTile && (ctu->m_bFirstRowInSlice || ctu->m_bFirstRowInTile))
+                m_entropyCoder.load(m_initSliceContext);
+            // Synchronize cabac probabilities with upper-right CTU if it's available and we're at the start of a line.
+            else if (m_param->bEnableWavefront && !col)
+            {
+                m_entropyCoder.copyState(m_initSliceContext);
+                m_entropyCoder.loadContexts(m_rows[lin - 1].bufferedEntropy);
+            }
+
+            if (saoParam)
             {
-                int mergeLeft = col && saoParam->ctuParam[0][cuAddr].mergeMode == SAO_MERGE_LEFT;
-                int mergeUp = lin && saoParam->ctuParam[0][cuAddr].mergeMode == SAO_MERGE_UP;
-                if (col)
-                    m_entropyCoder.codeSaoMerge(mergeLeft);
-                if (lin && !mergeLeft)
-                    m_entropyCoder.codeSaoMerge(mergeUp);
-                if (!mergeLeft && !mergeUp)
+                if (saoParam->bSaoFlag[0] || saoParam->bSaoFlag[1])
                 {
-                    if (saoParam->bSaoFlag[0])
-                        m_entropyCoder.codeSaoOffset(saoParam->ctuParam[0][cuAddr], 0);
-                    if (saoParam->bSaoFlag[1])
+                    // merge candidates must be in the same slice and tile
+                    bool bAllowMergeUp = !ctu->m_bFirstRowInSlice && !ctu->m_bFirstRowInTile;
+                    int mergeLeft = !ctu->m_bFirstColInTile && saoParam->ctuParam[0][cuAddr].mergeMode == SAO_MERGE_LEFT;
+                    int mergeUp = bAllowMergeUp && saoParam->ctuParam[0][cuAddr].mergeMode == SAO_MERGE_UP;
+                    if (!ctu->m_bFirstColInTile)
+                        m_entropyCoder.codeSaoMerge(mergeLeft);
+                    if (bAllowMergeUp && !mergeLeft)
+                        m_entropyCoder.codeSaoMerge(mergeUp);
+                    if (!mergeLeft && !mergeUp)
                     {
-                        m_entropyCoder.codeSaoOffset(saoParam->ctuParam[1][cuAddr], 1);
-                        m_entropyCoder.codeSaoOffset(saoParam->ctuParam[2][cuAddr], 2);
+                        if (saoParam->bSaoFlag[0])
+                            m_entropyCoder.codeSaoOffset(saoParam->ctuParam[0][cuAddr], 0);
+                        if (saoParam->bSaoFlag[1])
+                        {
+                            m_entropyCoder.codeSaoOffset(saoParam->ctuParam[1][cuAddr], 1);
+                            m_entropyCoder.codeSaoOffset(saoParam->ctuParam[2][cuAddr], 2);
+                        }
                     }
                 }
+                else
+                {
+                    for (int c = 0; c < (m_param->internalCsp != X265_CSP_I400 ? 3 : 1); c++)
+                        saoParam->ctuParam[c][cuAddr].reset();
+                }
             }
-            else
-            {
-                for (int i = 0; i < (m_param->internalCsp != X265_CSP_I400 ? 3 : 1); i++)
-                    saoParam->ctuParam[i][cuAddr].reset();
-            }
-        }
 
-        // final coding (bitstream generation) for this CU
-        m_entropyCoder.encodeCTU(*ctu, m_cuGeoms[m_ctuGeomMap[cuAddr]]);
+            // final coding (bitstream generation) for this CU
+            m_entropyCoder.encodeCTU(*ctu, m_cuGeoms[m_ctuGeomMap[cuAddr]]);
 
-        if (m_param->bEnableWavefront)
-        {
-            if (col == 1)
-                // Store probabilities of second CTU in line into buffer
-                m_rows[lin].bufferedEntropy.loadContexts(m_entropyCoder);
+            if (m_param->bEnableWavefront)
+            {
+                if (col == 1)
+                    // Store probabilities of second CTU in line into buffer
+                    m_rows[lin].bufferedEntropy.loadContexts(m_entropyCoder);
 
-            if (col == widthInLCUs - 1)
+                if (col == widthInLCUs - 1)
+                    m_entropyCoder.finishSlice();
+            }
+            else if (ctu->m_bLastCuInSlice || i == tileCUs - 1)
                 m_entropyCoder.finishSlice();
         }
     }
-    if (!m_param->bEnableWavefront)
-        m_entropyCoder.finishSlice();
 }
 
 void FrameEncoder::processRow(int row, int threadId)
@@ -866,11 +1051,11 @@ void FrameEncoder::processRow(int row, int threadId)
     if (ATOMIC_INC(&m_activeWorkerCount) == 1 && m_stallStartTime)
         m_totalNoWorkerTime += x265_mdate() - m_stallStartTime;
 
-    const uint32_t realRow = row >> 1;
-    const uint32_t typeNum = row & 1;
+    const uint32_t realRow = row / (m_numTileCols + 1);
+    const uint32_t typeNum = row % (m_numTileCols + 1);
 
-    if (!typeNum)
-        processRowEncoder(realRow, m_tld[threadId]);
+    if (typeNum < m_numTileCols)
+        processRowEncoder(realRow, typeNum, m_tld[threadId]);
     else
     {
         m_frameFilter.processRow(realRow);
@@ -887,13 +1072,13 @@ void FrameEncoder::processRow(int row, int threadId)
 }
 
 // Called by worker threads
-void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
+void FrameEncoder::processRowEncoder(int intRow, int tileCol, ThreadLocalData& tld)
 {
     const uint32_t row = (uint32_t)intRow;
-    CTURow& curRow = m_rows[row];
+    CTURow& curRow = m_rows[row * m_numTileCols + tileCol];
 
     tld.analysis.m_param = m_param;
-    if (m_param->bEnableWavefront)
+    if (m_bRowJobs)
     {
         ScopedLock self(curRow.lock);
         if (!curRow.active)
@@ -913,39 +1098,52 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
         curRow.busy = true;
     }
 
+    const uint32_t sliceId = curRow.sliceId;
+    const uint32_t sliceBaseRow = m_sliceBaseRow[sliceId];
+    const uint32_t sliceEndRow = m_sliceBaseRow[sliceId + 1];
+    const uint32_t rowInSlice = row - sliceBaseRow;
+
+    /* the segment of this row within its tile, the whole row without tiles */
+    const uint32_t tileColBegin = m_tileColBd[tileCol];
+    const uint32_t tileCols = m_tileColBd[tileCol + 1] - tileColBegin;
+    const uint32_t tileEndRow = m_tileRowBd[curRow.tileId / m_numTileCols + 1];
+
     /* When WPP is enabled, every row has its own row coder instance. Otherwise
-     * they share row 0 */
-    Entropy& rowCoder = m_param->bEnableWavefront ? m_rows[row].rowGoOnCoder : m_rows[0].rowGoOnCoder;
+     * they share the first row of their slice or tile */
+    const uint32_t streamBaseRow = X265_MAX(sliceBaseRow, m_tileRowBd[curRow.tileId / m_numTileCols]);
+    const uint32_t streamEndRow = X265_MIN(sliceEndRow, tileEndRow);
+    Entropy& rowCoder = m_param->bEnableWavefront ? m_rows[row].rowGoOnCoder : m_rows[streamBaseRow * m_numTileCols + tileCol].rowGoOnCoder;
     FrameData& curEncData = *m_frame->m_encData;
     Slice *slice = curEncData.m_slice;
 
     const uint32_t numCols = m_numCols;
-    const uint32_t lineStartCUAddr = row * numCols;
+    const uint32_t lineStartCUAddr = row * numCols + tileColBegin;
     bool bIsVbv = m_param->rc.vbvBufferSize > 0 && m_param->rc.vbvMaxBitrate > 0;
 
     uint32_t maxBlockCols = (m_frame->m_fencPic->m_picWidth + (16 - 1)) / 16;
     uint32_t maxBlockRows = (m_frame->m_fencPic->m_picHeight + (16 - 1)) / 16;
     uint32_t noOfBlocks = g_maxCUSize / 16;
 
-    while (curRow.completed < numCols)
+    while (curRow.completed < tileCols)
     {
         ProfileScopeEvent(encodeCTU);
 
-        const uint32_t col = curRow.completed;
-        const uint32_t cuAddr = lineStartCUAddr + col;
+        const uint32_t col = tileColBegin + curRow.completed;
+        const uint32_t cuAddr = lineStartCUAddr + curRow.completed;
         CUData* ctu = curEncData.getPicCTU(cuAddr);
-        ctu->initCTU(*m_frame, cuAddr, slice->m_sliceQp);
+        ctu->initCTU(*m_frame, cuAddr, slice->m_sliceQp, !rowInSlice, row == sliceEndRow - 1,
+                     row == sliceEndRow - 1 && col == numCols - 1);
 
         if (bIsVbv)
         {
-            if (!row)
+            if (!rowInSlice)
             {
                 curEncData.m_rowStat[row].diagQp = curEncData.m_avgQpRc;
                 curEncData.m_rowStat[row].diagQpScale = x265_qp2qScale(curEncData.m_avgQpRc);
             }
 
             FrameData::RCStatCU& cuStat = curEncData.m_cuStat[cuAddr];
-            if (row >= col && row && m_vbvResetTriggerRow != intRow)
+            if (rowInSlice >= col && rowInSlice && m_vbvResetTriggerRow[sliceId] != intRow)
                 cuStat.baseQp = curEncData.m_cuStat[cuAddr - numCols + 1].baseQp;
             else
                 cuStat.baseQp = curEncData.m_rowStat[row].diagQp;
@@ -970,15 +1168,32 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
         else
             curEncData.m_cuStat[cuAddr].baseQp = curEncData.m_avgQpRc;
 
-        if (m_param->bEnableWavefront && !col && row)
+        if (m_param->bEnableWavefront && !col && rowInSlice)
         {
             // Load SBAC coder context from previous row and initialize row state.
             rowCoder.copyState(m_initSliceContext);
             rowCoder.loadContexts(m_rows[row - 1].bufferedEntropy);
         }
 
+        if (m_param->frameBudget > 0)
+        {
+            int level = getDegradeLevel();
+            tld.analysis.m_param = level ? &m_degradedParam[level - 1] : m_param;
+            if (level)
+            {
+                curRow.rowStats.cntDegradedCtu++;
+                curRow.rowStats.maxDegradeLevel = X265_MAX(curRow.rowStats.maxDegradeLevel, level);
+            }
+        }
+
         // Does all the CU analysis, returns best top level mode decision
         Mode& best = tld.analysis.compressCTU(*ctu, *m_frame, m_cuGeoms[m_ctuGeomMap[cuAddr]], rowCoder);
+#if DETAILED_CU_STATS
+        tld.analysis.flushIntraPredCacheStats(m_jpId);
+#endif
+
+        if (m_param->frameBudget > 0)
+            ATOMIC_INC(&m_budgetCTUsDone);
 
         // take a sample of the current active worker count
         ATOMIC_ADD(&m_totalActiveWorkerCount, m_activeWorkerCount);
@@ -999,12 +1214,14 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
         /* Deblock with idle threading */
         if (m_param->bEnableLoopFilter | m_param->bEnableSAO)
         {
-            // NOTE: in VBV mode, we may reencode anytime, so we can't do Deblock stage-Horizon and SAO
-            if (!bIsVbv)
+            // NOTE: in VBV mode, we may reencode anytime, so we can't do Deblock stage-Horizon and SAO.
+            // The rows of different tiles finish out of order, they are filtered only by the row filter jobs
+            if (!bIsVbv && m_numTiles == 1)
             {
                 // TODO: Multiple Threading
-                // Delay ONE row to avoid Intra Prediction Conflict
-                if (m_pool && (row >= 1))
+                // Delay ONE row to avoid Intra Prediction Conflict, the row above
+                // may not be encoded yet if it belongs to another slice
+                if (m_pool && (rowInSlice >= 1))
                 {
                     // Waitting last threading finish
                     m_frameFilter.m_parallelFilter[row - 1].waitForExit();
@@ -1042,8 +1259,9 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
                 }
             } // end of !bIsVbv
         }
-        // Both Loopfilter and SAO Disabled
-        else
+        // Both Loopfilter and SAO Disabled, the border extension of a row
+        // split into tiles waits for the row filter
+        else if (m_numTiles == 1)
         {
             m_frameFilter.m_parallelFilter[row].processPostCu(col);
         }
@@ -1052,7 +1270,7 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
         curRow.completed++;
 
         FrameStats frameLog;
-        curEncData.m_rowStat[row].sumQpAq += collectCTUStatistics(*ctu, &frameLog);
+        curRow.sumQpAq += collectCTUStatistics(*ctu, &frameLog);
 
         // copy no. of intra, inter Cu cnt per row into frame stats for 2 pass
         if (m_param->rc.bStatWrite)
@@ -1107,10 +1325,14 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
 
             // If current block is at row diagonal checkpoint, call vbv ratecontrol.
 
-            if (row == col && row)
+            if (rowInSlice == col && rowInSlice)
             {
                 double qpBase = curEncData.m_cuStat[cuAddr].baseQp;
-                int reEncode = m_top->m_rateControl->rowDiagonalVbvRateControl(m_frame, row, &m_rce, qpBase);
+                int reEncode;
+                {
+                    ScopedLock vbvLock(m_vbvLock);
+                    reEncode = m_top->m_rateControl->rowDiagonalVbvRateControl(m_frame, row, sliceBaseRow, &m_rce, qpBase);
+                }
                 qpBase = x265_clip3((double)QP_MIN, (double)QP_MAX_MAX, qpBase);
                 curEncData.m_rowStat[row].diagQp = qpBase;
                 curEncData.m_rowStat[row].diagQpScale =  x265_qp2qScale(qpBase);
@@ -1121,10 +1343,10 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
                              m_frame->m_poc, row, qpBase, curEncData.m_cuStat[cuAddr].baseQp);
 
                     // prevent the WaveFront::findJob() method from providing new jobs
-                    m_vbvResetTriggerRow = row;
-                    m_bAllRowsStop = true;
+                    m_vbvResetTriggerRow[sliceId] = row;
+                    m_bAllRowsStop[sliceId] = true;
 
-                    for (uint32_t r = m_numRows - 1; r >= row; r--)
+                    for (uint32_t r = sliceEndRow - 1; r >= row; r--)
                     {
                         CTURow& stopRow = m_rows[r];
 
@@ -1134,7 +1356,7 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
                             stopRow.lock.acquire();
                             while (stopRow.active)
                             {
-                                if (dequeueRow(r * 2))
+                                if (dequeueRow(r * (m_numTileCols + 1)))
                                     stopRow.active = false;
                                 else
                                 {
@@ -1163,22 +1385,22 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
 
                         m_outStreams[r].resetBits();
                         stopRow.completed = 0;
+                        stopRow.sumQpAq = 0;
                         memset(&stopRow.rowStats, 0, sizeof(stopRow.rowStats));
                         curEncData.m_rowStat[r].numEncodedCUs = 0;
                         curEncData.m_rowStat[r].encodedBits = 0;
                         curEncData.m_rowStat[r].diagSatd = 0;
                         curEncData.m_rowStat[r].diagIntraSatd = 0;
                         curEncData.m_rowStat[r].sumQpRc = 0;
-                        curEncData.m_rowStat[r].sumQpAq = 0;
                     }
 
-                    m_bAllRowsStop = false;
+                    m_bAllRowsStop[sliceId] = false;
                 }
             }
         }
 
-        if (m_param->bEnableWavefront && curRow.completed >= 2 && row < m_numRows - 1 &&
-            (!m_bAllRowsStop || intRow + 1 < m_vbvResetTriggerRow))
+        if (m_param->bEnableWavefront && curRow.completed >= 2 && row < sliceEndRow - 1 &&
+            (!m_bAllRowsStop[sliceId] || intRow + 1 < m_vbvResetTriggerRow[sliceId]))
         {
             /* activate next row */
             ScopedLock below(m_rows[row + 1].lock);
@@ -1192,8 +1414,8 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
         }
 
         ScopedLock self(curRow.lock);
-        if ((m_bAllRowsStop && intRow > m_vbvResetTriggerRow) ||
-            (row > 0 && ((curRow.completed < numCols - 1) || (m_rows[row - 1].completed < numCols)) && m_rows[row - 1].completed < m_rows[row].completed + 2))
+        if ((m_bAllRowsStop[sliceId] && intRow > m_vbvResetTriggerRow[sliceId]) ||
+            (m_param->bEnableWavefront && rowInSlice > 0 && ((curRow.completed < numCols - 1) || (m_rows[row - 1].completed < numCols)) && m_rows[row - 1].completed < m_rows[row].completed + 2))
         {
             curRow.active = false;
             curRow.busy = false;
@@ -1204,6 +1426,63 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
 
     /** this row of CTUs has been compressed **/
 
+    /* flush row bitstream (if WPP and no SAO) or flush slice or tile if no WPP and no SAO */
+    if (!m_param->bEnableSAO && (m_param->bEnableWavefront || row == streamEndRow - 1))
+        rowCoder.finishSlice();
+
+    /* without WPP the next row of the tile continues with this row's coder */
+    if (m_bRowJobs && !m_param->bEnableWavefront && row + 1 < streamEndRow)
+    {
+        CTURow& nextRow = m_rows[(row + 1) * m_numTileCols + tileCol];
+        ScopedLock below(nextRow.lock);
+        nextRow.active = true;
+        enqueueRowEncoder(row + 1, tileCol);
+        tryWakeOne();
+    }
+
+    /* Processing left Deblock block with current threading */
+    if ((m_param->bEnableLoopFilter | m_param->bEnableSAO) & (row >= 2) & (rowInSlice >= 1) & (m_numTiles == 1))
+    {
+        /* TODO: Multiple Threading */
+
+        /* Check conditional to start previous row process with current threading */
+        if (m_frameFilter.m_parallelFilter[row - 2].m_lastDeblocked.get() == (int)numCols)
+        {
+            /* stop threading on current row and restart it */
+            m_frameFilter.m_parallelFilter[row - 1].waitForExit();
+            m_frameFilter.m_parallelFilter[row - 1].m_allowedCol.set(numCols);
+            m_frameFilter.m_parallelFilter[row - 1].processTasks(-1);
+        }
+    }
+
+    /* Rows of different slices may finish out of order. The rate control
+     * update and the row filters follow the rows finished in picture order,
+     * so each finished row is handled by the thread which completes the
+     * run of finished rows above it */
+    uint32_t firstInOrder, endInOrder;
+    {
+        ScopedLock finishLock(m_rowFinishLock);
+        curRow.finished = true;
+        curEncData.m_rowStat[row].sumQpAq += curRow.sumQpAq;
+        firstInOrder = m_numRowsFinished;
+        while (m_numRowsFinished < m_numRows)
+        {
+            /* a row is finished once the segments of all tiles are */
+            const CTURow* segments = m_rows + m_numRowsFinished * m_numTileCols;
+            uint32_t numFinished = 0;
+            while (numFinished < m_numTileCols && segments[numFinished].finished)
+                numFinished++;
+            if (numFinished < m_numTileCols)
+                break;
+            m_numRowsFinished++;
+        }
+        endInOrder = m_numRowsFinished;
+    }
+
+    /* without SAO the slices are complete once all of their rows are */
+    if (m_param->nalOutput && !m_param->bEnableSAO && endInOrder > firstInOrder)
+        outputSlices(endInOrder);
+
     /* If encoding with ABR, update update bits and complexity in rate control
      * after a number of rows so the next frame's rateControlStart has more
      * accurate data for estimation. At the start of the encode we update stats
@@ -1219,7 +1498,7 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
             rowCount = X265_MIN((m_numRows + 1) / 2, m_numRows - 1);
         else
             rowCount = X265_MIN(m_refLagRows, m_numRows - 1);
-        if (row == rowCount)
+        if (rowCount >= firstInOrder && rowCount < endInOrder)
         {
             m_rce.rowTotalBits = 0;
             if (bIsVbv)
@@ -1233,53 +1512,86 @@ void FrameEncoder::processRowEncoder(int intRow, ThreadLocalData& tld)
         }
     }
 
-    /* flush row bitstream (if WPP and no SAO) or flush frame if no WPP and no SAO */
-    if (!m_param->bEnableSAO && (m_param->bEnableWavefront || row == m_numRows - 1))
-        rowCoder.finishSlice();
-
-    /* Processing left Deblock block with current threading */
-    if ((m_param->bEnableLoopFilter | m_param->bEnableSAO) & (row >= 2))
-    {
-        /* TODO: Multiple Threading */
-
-        /* Check conditional to start previous row process with current threading */
-        if (m_frameFilter.m_parallelFilter[row - 2].m_lastDeblocked.get() == (int)numCols)
-        {
-            /* stop threading on current row and restart it */
-            m_frameFilter.m_parallelFilter[row - 1].waitForExit();
-            m_frameFilter.m_parallelFilter[row - 1].m_allowedCol.set(numCols);
-            m_frameFilter.m_parallelFilter[row - 1].processTasks(-1);
-        }
-    }
-
     /* trigger row-wise loop filters */
-    if (m_param->bEnableWavefront)
+    if (m_bRowJobs)
     {
-        if (row >= m_filterRowDelay)
+        for (uint32_t r = firstInOrder; r < endInOrder; r++)
         {
-            enableRowFilter(row - m_filterRowDelay);
+            if (r >= m_filterRowDelay)
+            {
+                enableRowFilter(r - m_filterRowDelay);
 
-            /* NOTE: Activate filter if first row (row 0) */
-            if (row == m_filterRowDelay)
-                enqueueRowFilter(0);
-            tryWakeOne();
-        }
+                /* NOTE: Activate filter if first row (row 0) */
+                if (r == m_filterRowDelay)
+                    enqueueRowFilter(0);
+                tryWakeOne();
+            }
 
-        if (row == m_numRows - 1)
-        {
-            for (uint32_t i = m_numRows - m_filterRowDelay; i < m_numRows; i++)
-                enableRowFilter(i);
-            tryWakeOne();
+            if (r == m_numRows - 1)
+            {
+                for (uint32_t i = m_numRows - m_filterRowDelay; i < m_numRows; i++)
+                    enableRowFilter(i);
+                tryWakeOne();
+            }
         }
     }
 
     tld.analysis.m_param = NULL;
     curRow.busy = false;
 
-    if (ATOMIC_INC(&m_completionCount) == 2 * (int)m_numRows)
+    if (ATOMIC_INC(&m_completionCount) == (int)((m_numTileCols + 1) * m_numRows))
         m_completionEvent.trigger();
 }
 
+/* Each level keeps the reductions of the levels below it. Only options which
+ * may change between CTUs of a picture are touched: nothing coded in the SPS,
+ * PPS or slice header, and nothing which would widen the reference lag */
+void FrameEncoder::initDegradedParams()
+{
+    for (int level = 1; level <= MAX_DEGRADE_LEVEL; level++)
+    {
+        x265_param& p = m_degradedParam[level - 1];
+        memcpy(&p, level > 1 ? &m_degradedParam[level - 2] : m_param, sizeof(x265_param));
+        switch (level)
+        {
+        case 1:
+            p.limitModes = 1;
+            /* pmode only supports the depth limit, see Encoder::configure() */
+            p.limitReferences = p.bDistributeModeAnalysis ? X265_REF_LIMIT_DEPTH : X265_REF_LIMIT_DEPTH | X265_REF_LIMIT_CU;
+            p.bEnableEarlySkip = 1;
+            p.subpelRefine = X265_MIN(p.subpelRefine, 2);
+            break;
+        case 2:
+            p.bEnableRectInter = 0;
+            p.bEnableFastIntra = 1;
+            p.subpelRefine = X265_MIN(p.subpelRefine, 1);
+            p.rdLevel = X265_MIN(p.rdLevel, 3);
+            break;
+        default:
+            p.bIntraInBFrames = 0;
+            /* --pmode at rd 2 may code CUs which do not match its reconstruction */
+            if (!p.bDistributeModeAnalysis)
+                p.rdLevel = X265_MIN(p.rdLevel, 2);
+            break;
+        }
+    }
+}
+
+/* The frame's budget is spread evenly over its CTUs. Each 10% of the budget
+ * the frame is behind that schedule reduces the analysis effort by one level,
+ * the effort is restored as soon as the frame is back within 10% of it */
+int FrameEncoder::getDegradeLevel()
+{
+    double budget = m_param->frameBudget * 1000;
+    double elapsed = (double)(x265_mdate() - m_startCompressTime);
+    double progress = X265_MIN(1.0, (double)m_budgetCTUsDone / (m_numRows * m_numCols));
+    double lag = (elapsed - budget * progress) / budget;
+    if (lag <= 0)
+        return 0;
+
+    return X265_MIN(MAX_DEGRADE_LEVEL, (int)(lag * 10));
+}
+
 /* collect statistics about CU coding decisions, return total QP */
 int FrameEncoder::collectCTUStatistics(const CUData& ctu, FrameStats* log)
 {
@@ -49,6 +49,7 @@ class Encoder;
 
 #define ANGULAR_MODE_ID 2
 #define AMP_ID 3
+#define MAX_DEGRADE_LEVEL 3 // analysis effort reductions available to --frame-budget
 
 struct StatisticLog
 {
@@ -67,8 +68,10 @@ struct StatisticLog
     }
 };
 
-/* manages the state of encoding one row of CTU blocks.  When
- * WPP is active, several rows will be simultaneously encoded. */
+/* manages the state of encoding one row of CTU blocks, or the segment of
+ * the row within one tile column when tiles are used.  When WPP is active,
+ * several rows will be simultaneously encoded, with tiles the segments of
+ * different tiles are. */
 struct CTURow
 {
     Entropy           bufferedEntropy;  /* store CTU2 context for next row CTU0 */
@@ -95,12 +98,27 @@ struct CTURow
     /* count of completed CUs in this row */
     volatile uint32_t completed;
 
+    /* all CUs of this row are compressed and its bitstream is flushed. Rows
+     * of different slices or tiles may finish out of order. Protected by the
+     * frame encoder's m_rowFinishLock */
+    bool              finished;
+
+    /* sum of the CU QPs of this row, added to the frame's row statistics
+     * once the row is finished since tiles share rows */
+    double            sumQpAq;
+
+    /* slice and tile containing this row, fixed for the life of the frame encoder */
+    uint32_t          sliceId;
+    uint32_t          tileId;
+
     /* called at the start of each frame to initialize state */
     void init(Entropy& initContext)
     {
         active = false;
         busy = false;
+        finished = false;
         completed = 0;
+        sumQpAq = 0;
         memset(&rowStats, 0, sizeof(rowStats));
         rowGoOnCoder.load(initContext);
     }
@@ -125,18 +143,34 @@ public:
     /* blocks until worker thread is done, returns access unit */
     Frame *getEncodedPicture(NALList& list);
 
+    /* serializes the slices lying above CTU row endRow which are not yet
+     * output, and passes the new NAL units on to param->nalOutput */
+    void outputSlices(uint32_t endRow);
+
     Event                    m_enable;
     Event                    m_done;
     Event                    m_completionEvent;
     int                      m_localTldIdx;
     bool                     m_reconfigure; /* reconfigure in progress */
     volatile bool            m_threadActive;
-    volatile bool            m_bAllRowsStop;
+    volatile bool            m_bAllRowsStop[X265_MAX_SLICES];
     volatile int             m_completionCount;
-    volatile int             m_vbvResetTriggerRow;
+    volatile int             m_vbvResetTriggerRow[X265_MAX_SLICES];
 
     uint32_t                 m_numRows;
     uint32_t                 m_numCols;
+    uint32_t                 m_sliceBaseRow[X265_MAX_SLICES + 1]; /* first CTU row of each slice, m_numRows at the end */
+    uint32_t                 m_numTileCols;
+    uint32_t                 m_numTiles;
+    const uint32_t*          m_tileColBd;                          /* first CTU column of each tile column, from the PPS */
+    const uint32_t*          m_tileRowBd;                          /* first CTU row of each tile row, from the PPS */
+    bool                     m_bRowJobs;                           /* CTU rows are WaveFront jobs of the pool, with WPP or tiles */
+    uint32_t                 m_numRowsFinished;                    /* rows 0 .. m_numRowsFinished-1 are all finished */
+    Lock                     m_rowFinishLock;                      /* guards CTURow::finished and m_numRowsFinished */
+    Lock                     m_vbvLock;                            /* serializes the VBV checkpoints of parallel slices */
+    uint32_t                 m_numSlicesOutput;                    /* slices 0 .. m_numSlicesOutput-1 are serialized */
+    uint32_t                 m_numNalOutput;                       /* NAL units already passed to param->nalOutput */
+    Lock                     m_sliceOutputLock;                    /* serializes the output of finished slices */
     uint32_t                 m_filterRowDelay;
     uint32_t                 m_filterRowDelayCus;
     uint32_t                 m_refLagRows;
@@ -159,6 +193,7 @@ public:
     volatile int             m_totalActiveWorkerCount;   // sum of m_activeWorkerCount sampled at end of each CTU
     volatile int             m_activeWorkerCountSamples; // count of times m_activeWorkerCount was sampled (think vbv restarts)
     volatile int             m_countRowBlocks;           // count of workers forced to abandon a row because of top dependency
+    volatile int             m_budgetCTUsDone;           // count of CTUs compressed, for --frame-budget scheduling
     int64_t                  m_startCompressTime;        // timestamp when frame encoder is given a frame
     int64_t                  m_row0WaitTime;             // timestamp when row 0 is allowed to start
     int64_t                  m_allRowsAvailableTime;     // timestamp when all reference dependencies are resolved
@@ -184,6 +219,10 @@ public:
     CUGeom*                  m_cuGeoms;
     uint32_t*                m_ctuGeomMap;
 
+    /* copies of m_param with progressively reduced analysis effort, used for
+     * the CTUs of a frame running behind its --frame-budget schedule */
+    x265_param               m_degradedParam[MAX_DEGRADE_LEVEL];
+
     Bitstream                m_bs;
     MotionReference          m_mref[2][MAX_NUM_REF + 1];
     Entropy                  m_entropyCoder;
@@ -206,6 +245,22 @@ public:
         WeightAnalysis operator=(const WeightAnalysis&);
     };
 
+    /* --hash-me: indexes the source of the picture while its CTU rows are
+     * coded, the one task is claimed by a bonded worker or the frame thread */
+    class BlockHashBuild : public BondedTaskGroup
+    {
+    public:
+
+        FrameEncoder* m_frameEncoder;
+
+        BlockHashBuild() : m_frameEncoder(NULL) {}
+
+        void processTasks(int workerThreadId);
+    };
+
+    BlockHashBuild           m_blockHashBuild;
+    BlockHashScratch         m_blockHashScratch;
+
 protected:
 
     bool initializeGeoms();
@@ -213,21 +268,24 @@ protected:
     /* analyze / compress frame, can be run in parallel within reference constraints */
     void compressFrame();
 
-    /* called by compressFrame to generate final per-row bitstreams */
-    void encodeSlice();
+    /* generate the final per-row bitstreams of one slice, only required when SAO is enabled */
+    void encodeSlice(uint32_t sliceId);
 
     void threadMain();
     int  collectCTUStatistics(const CUData& ctu, FrameStats* frameLog);
+    void initDegradedParams();
+    int  getDegradeLevel();
     void noiseReductionUpdate();
 
     /* Called by WaveFront::findJob() */
     virtual void processRow(int row, int threadId);
-    virtual void processRowEncoder(int row, ThreadLocalData& tld);
+    virtual void processRowEncoder(int row, int tileCol, ThreadLocalData& tld);
 
-    void enqueueRowEncoder(int row) { WaveFront::enqueueRow(row * 2 + 0); }
-    void enqueueRowFilter(int row)  { WaveFront::enqueueRow(row * 2 + 1); }
-    void enableRowEncoder(int row)  { WaveFront::enableRow(row * 2 + 0); }
-    void enableRowFilter(int row)   { WaveFront::enableRow(row * 2 + 1); }
+    /* each CTU row has one encoder job per tile column followed by its filter job */
+    void enqueueRowEncoder(int row, int tileCol = 0) { WaveFront::enqueueRow(row * (m_numTileCols + 1) + tileCol); }
+    void enqueueRowFilter(int row)  { WaveFront::enqueueRow(row * (m_numTileCols + 1) + m_numTileCols); }
+    void enableRowEncoder(int row, int tileCol = 0)  { WaveFront::enableRow(row * (m_numTileCols + 1) + tileCol); }
+    void enableRowFilter(int row)   { WaveFront::enableRow(row * (m_numTileCols + 1) + m_numTileCols); }
 };
 }
 
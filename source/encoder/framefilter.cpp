@@ -101,6 +101,7 @@ void FrameFilter::init(Encoder *top, FrameEncoder *frame, int numRows, uint32_t
         }
     }
 
+    m_rowMetrics.m_frameFilter = this;
 }
 
 void FrameFilter::start(Frame *frame, Entropy& initState)
@@ -125,6 +126,9 @@ void FrameFilter::start(Frame *frame, Entropy& initState)
         if (m_param->bEnableSAO)
             m_parallelFilter[0].m_sao.resetStats();
     }
+
+    m_rowMetrics.m_rowsFinished = 0;
+    m_rowMetrics.m_rowsMeasured = 0;
 }
 
 /* restore original YUV samples to recon after SAO (if lossless) */
@@ -176,38 +180,52 @@ static void origCUSampleRestoration(const CUData* cu, const CUGeom& cuGeom, Fram
 
 void FrameFilter::ParallelFilter::copySaoAboveRef(PicYuv* reconPic, uint32_t cuAddr, int col)
 {
-    // Copy SAO Top Reference Pixels
+    // Copy SAO Top Reference Pixels, from the CTU itself when the row above belongs to another slice
     int ctuWidth  = g_maxCUSize;
-    const pixel* recY = reconPic->getPlaneAddr(0, cuAddr) - (m_rowAddr == 0 ? 0 : reconPic->m_stride);
+    const bool bAboveUnavail = m_rowAddr == 0 || m_encData->getPicCTU(cuAddr)->m_bFirstRowInSlice;
+    const pixel* recY = reconPic->getPlaneAddr(0, cuAddr) - (bAboveUnavail ? 0 : reconPic->m_stride);
+
+    // The CTU is deblocked but for its last lines, keep the line above them for their deferred SAO
+    const bool bDeferred = m_row != m_frameFilter->m_numRows - 1;
+    int aboveDeferred = g_maxCUSize - SAO::SAO_DEFERRED_LINES - 1;
 
     // Luma
     memcpy(&m_sao.m_tmpU[0][col * ctuWidth], recY, ctuWidth * sizeof(pixel));
     X265_CHECK(col * ctuWidth + ctuWidth <= m_sao.m_numCuInWidth * ctuWidth, "m_tmpU buffer beyond bound write detected");
+    if (bDeferred)
+        memcpy(&m_sao.m_tmpDeferredU[0][col * ctuWidth], reconPic->getPlaneAddr(0, cuAddr) + aboveDeferred * reconPic->m_stride, ctuWidth * sizeof(pixel));
 
     // Chroma
     if (m_frameFilter->m_param->internalCsp != X265_CSP_I400)
     {
         ctuWidth  >>= m_sao.m_hChromaShift;
+        aboveDeferred = (g_maxCUSize >> m_sao.m_vChromaShift) - (SAO::SAO_DEFERRED_LINES >> m_sao.m_vChromaShift) - 1;
 
-        const pixel* recU = reconPic->getPlaneAddr(1, cuAddr) - (m_rowAddr == 0 ? 0 : reconPic->m_strideC);
-        const pixel* recV = reconPic->getPlaneAddr(2, cuAddr) - (m_rowAddr == 0 ? 0 : reconPic->m_strideC);
+        const pixel* recU = reconPic->getPlaneAddr(1, cuAddr) - (bAboveUnavail ? 0 : reconPic->m_strideC);
+        const pixel* recV = reconPic->getPlaneAddr(2, cuAddr) - (bAboveUnavail ? 0 : reconPic->m_strideC);
         memcpy(&m_sao.m_tmpU[1][col * ctuWidth], recU, ctuWidth * sizeof(pixel));
         memcpy(&m_sao.m_tmpU[2][col * ctuWidth], recV, ctuWidth * sizeof(pixel));
 
         X265_CHECK(col * ctuWidth + ctuWidth <= m_sao.m_numCuInWidth * ctuWidth, "m_tmpU buffer beyond bound write detected");
+        if (bDeferred)
+        {
+            memcpy(&m_sao.m_tmpDeferredU[1][col * ctuWidth], reconPic->getPlaneAddr(1, cuAddr) + aboveDeferred * reconPic->m_strideC, ctuWidth * sizeof(pixel));
+            memcpy(&m_sao.m_tmpDeferredU[2][col * ctuWidth], reconPic->getPlaneAddr(2, cuAddr) + aboveDeferred * reconPic->m_strideC, ctuWidth * sizeof(pixel));
+        }
     }
 }
 
-void FrameFilter::ParallelFilter::processSaoCTU(SAOParam *saoParam, int col)
+void FrameFilter::ParallelFilter::processSaoCTU(SAOParam *saoParam, int col, bool bDeferred)
 {
-    // TODO: apply SAO on CU and copy back soon, is it necessary?
     if (saoParam->bSaoFlag[0])
-        m_sao.generateLumaOffsets(saoParam->ctuParam[0], m_row, col);
+        m_sao.generateLumaOffsets(saoParam->ctuParam[0], m_row, col, bDeferred);
 
     if (saoParam->bSaoFlag[1])
-        m_sao.generateChromaOffsets(saoParam->ctuParam, m_row, col);
+        m_sao.generateChromaOffsets(saoParam->ctuParam, m_row, col, bDeferred);
 
-    if (m_encData->m_slice->m_pps->bTransquantBypassEnabled)
+    // Lossless CUs get their original samples back once all lines of the CTU are filtered
+    const bool bCtuDone = bDeferred || m_row == m_frameFilter->m_numRows - 1;
+    if (bCtuDone && m_encData->m_slice->m_pps->bTransquantBypassEnabled)
     {
         const CUGeom* cuGeoms = m_frameFilter->m_frameEncoder->m_cuGeoms;
         const uint32_t* ctuGeomMap = m_frameFilter->m_frameEncoder->m_ctuGeomMap;
@@ -364,16 +382,22 @@ void FrameFilter::ParallelFilter::processTasks(int /*workerThreadId*/)
                     // NOTE: Delay 2 column to avoid mistake on below case, it is Deblock sync logic issue, less probability but still alive
                     //       ... H V |
                     //       ..S H V |
-                    m_sao.rdoSaoUnitCu(saoParam, m_rowAddr, col - 2, cuAddr - 2);
+                    m_sao.rdoSaoUnitCu(saoParam, cuAddr - 2);
                 }
 
-                // Process Previous Row SAO CU
+                // Process Previous Row SAO CU, the lines left by its first pass
                 if (m_row >= 1 && col >= 3)
                 {
                     // Must delay 1 row to avoid thread data race conflict
-                    m_prevRow->processSaoCTU(saoParam, col - 3);
+                    m_prevRow->processSaoCTU(saoParam, col - 3, true);
                     m_prevRow->processPostCu(col - 3);
                 }
+
+                // SAO of all lines of the CU which the deblocking of the row below
+                // leaves alone, while it is still in cache. Delayed behind the
+                // previous row so that row still sees unfiltered pixels below it
+                if (col >= 4)
+                    processSaoCTU(saoParam, col - 4, false);
             }
 
             m_lastDeblocked.set(col);
@@ -404,30 +428,33 @@ void FrameFilter::ParallelFilter::processTasks(int /*workerThreadId*/)
             // SAO Decide
             // NOTE: reduce condition check for 1 CU only video, Why someone play with it?
             if (numCols >= 2)
-                m_sao.rdoSaoUnitCu(saoParam, m_rowAddr, numCols - 2, cuAddr - 1);
+                m_sao.rdoSaoUnitCu(saoParam, cuAddr - 1);
 
             if (numCols >= 1)
-                m_sao.rdoSaoUnitCu(saoParam, m_rowAddr, numCols - 1, cuAddr);
+                m_sao.rdoSaoUnitCu(saoParam, cuAddr);
 
             // Process Previous Rows SAO CU
             if (m_row >= 1 && numCols >= 3)
             {
-                m_prevRow->processSaoCTU(saoParam, numCols - 3);
+                m_prevRow->processSaoCTU(saoParam, numCols - 3, true);
                 m_prevRow->processPostCu(numCols - 3);
             }
 
             if (m_row >= 1 && numCols >= 2)
             {
-                m_prevRow->processSaoCTU(saoParam, numCols - 2);
+                m_prevRow->processSaoCTU(saoParam, numCols - 2, true);
                 m_prevRow->processPostCu(numCols - 2);
             }
 
             if (m_row >= 1 && numCols >= 1)
             {
-                m_prevRow->processSaoCTU(saoParam, numCols - 1);
+                m_prevRow->processSaoCTU(saoParam, numCols - 1, true);
                 m_prevRow->processPostCu(numCols - 1);
             }
 
+            for (int col = X265_MAX(numCols - 4, 0); col < numCols; col++)
+                processSaoCTU(saoParam, col, false);
+
             // Setting column sync counter
             if (m_row >= 1)
                 m_frameFilter->m_frame->m_reconColCount[m_row - 1].set(numCols - 1);
@@ -447,6 +474,11 @@ void FrameFilter::processRow(int row)
 
     if (!m_param->bEnableLoopFilter && !m_param->bEnableSAO)
     {
+        if (m_frameEncoder->m_numTiles > 1)
+        {
+            for (int col = 0; col < m_numCols; col++)
+                m_parallelFilter[row].processPostCu(col);
+        }
         processPostRow(row);
         return;
     }
@@ -472,15 +504,8 @@ void FrameFilter::processRow(int row)
             if ((row >= 1) && (m_parallelFilter[row - 1].m_lastDeblocked.get() != m_numCols))
                 x265_log(m_param, X265_LOG_WARNING, "detected ParallelFilter race condition on last row\n");
 
-            /* Apply SAO on last row of CUs, because we always apply SAO on row[X-1] */
-            if (m_param->bEnableSAO)
-            {
-                for(int col = 0; col < m_numCols; col++)
-                {
-                    // NOTE: must use processSaoUnitCu(), it include TQBypass logic
-                    m_parallelFilter[row].processSaoCTU(saoParam, col);
-                }
-            }
+            /* SAO of the last row of CUs was applied whole by its own pass, there
+             * is no row below to defer its last lines to */
 
             // Process border extension on last row
             for(int col = 0; col < m_numCols; col++)
@@ -493,6 +518,10 @@ void FrameFilter::processRow(int row)
 
     // this row of CTUs has been encoded
 
+    // the SAO parameters of the slices above are decided, they may be output
+    if (m_param->nalOutput && m_param->bEnableSAO)
+        m_frameEncoder->outputSlices(row + 1);
+
     if (row > 0)
         processPostRow(row - 1);
 
@@ -514,14 +543,95 @@ void FrameFilter::processRow(int row)
 }
 
 void FrameFilter::processPostRow(int row)
+{
+    // Notify other FrameEncoders that this row of reconstructed pixels is available
+    m_frame->m_reconRowCount.incr();
+
+    if (m_param->bAsyncMetrics && m_frameEncoder->m_pool)
+        m_rowMetrics.rowFinished();
+    else
+        computeRowMetrics(row);
+
+    if (ATOMIC_INC(&m_frameEncoder->m_completionCount) == (int)((m_frameEncoder->m_numTileCols + 1) * m_frameEncoder->m_numRows))
+        m_frameEncoder->m_completionEvent.trigger();
+}
+
+void FrameFilter::RowMetrics::rowFinished()
+{
+    ScopedLock lock(m_stateLock);
+
+    m_rowsFinished++;
+    if (!m_bActive && tryBondPeers(*m_frameFilter->m_frameEncoder, 1))
+        m_bActive = true;
+}
+
+void FrameFilter::RowMetrics::processTasks(int /*workerThreadId*/)
+{
+    for (;;)
+    {
+        int row;
+        {
+            ScopedLock lock(m_stateLock);
+            if (m_rowsMeasured == m_rowsFinished)
+            {
+                m_bActive = false;
+                return;
+            }
+            row = m_rowsMeasured++;
+        }
+        m_frameFilter->computeRowMetrics(row);
+    }
+}
+
+void FrameFilter::RowMetrics::finish()
+{
+    waitForExit();
+
+    /* no peer is bonded, the rows no idle thread picked up are measured here */
+    while (m_rowsMeasured < m_rowsFinished)
+        m_frameFilter->computeRowMetrics(m_rowsMeasured++);
+}
+
+void FrameFilter::finishRowMetrics()
+{
+    if (m_param->bAsyncMetrics)
+        m_rowMetrics.finish();
+
+    if (m_param->decodedPictureHashSEI == 2 || m_param->decodedPictureHashSEI == 3)
+    {
+        int planes = (m_param->internalCsp != X265_CSP_I400) ? 3 : 1;
+
+        for (int i = 0; i < planes; i++)
+        {
+            uint32_t width = m_frame->m_reconPic->m_picWidth >> (i ? m_hChromaShift : 0);
+
+            if (m_param->decodedPictureHashSEI == 2)
+            {
+                uint32_t& crc = m_frameEncoder->m_crc[i];
+                crc = 0xffff;
+                for (int row = 0; row < m_numRows; row++)
+                {
+                    uint32_t height = m_parallelFilter[row].getCUHeight() >> (i ? m_vChromaShift : 0);
+                    crcCombine(crc, m_parallelFilter[row].m_rowHash[i], (uint64_t)width * height * sizeof(pixel));
+                }
+            }
+            else
+            {
+                uint32_t& checksum = m_frameEncoder->m_checksum[i];
+                checksum = 0;
+                for (int row = 0; row < m_numRows; row++)
+                    checksum += m_parallelFilter[row].m_rowHash[i];
+            }
+        }
+    }
+}
+
+void FrameFilter::computeRowMetrics(int row)
 {
     PicYuv *reconPic = m_frame->m_reconPic;
     const uint32_t numCols = m_frame->m_encData->m_slice->m_sps->numCuInWidth;
     const uint32_t lineStartCUAddr = row * numCols;
 
-    // Notify other FrameEncoders that this row of reconstructed pixels is available
-    m_frame->m_reconRowCount.incr();
-
     uint32_t cuAddr = lineStartCUAddr;
     if (m_param->bEnablePsnr)
     {
@@ -598,20 +708,20 @@ void FrameFilter::processPostRow(int row)
         uint32_t height = m_parallelFilter[row].getCUHeight();
         uint32_t width = reconPic->m_picWidth;
         intptr_t stride = reconPic->m_stride;
+        uint32_t* rowHash = m_parallelFilter[row].m_rowHash;
 
-        if (!row)
-            m_frameEncoder->m_crc[0] = 0xffff;
-
-        updateCRC(reconPic->getLumaAddr(cuAddr), m_frameEncoder->m_crc[0], height, width, stride);
+        /* each row is hashed on its own, finishRowMetrics() chains them */
+        rowHash[0] = 0;
+        updateCRC(reconPic->getLumaAddr(cuAddr), rowHash[0], height, width, stride);
         if (m_param->internalCsp != X265_CSP_I400)
         {
             width >>= m_hChromaShift;
             height >>= m_vChromaShift;
             stride = reconPic->m_strideC;
-            m_frameEncoder->m_crc[1] = m_frameEncoder->m_crc[2] = 0xffff;
+            rowHash[1] = rowHash[2] = 0;
 
-            updateCRC(reconPic->getCbAddr(cuAddr), m_frameEncoder->m_crc[1], height, width, stride);
-            updateCRC(reconPic->getCrAddr(cuAddr), m_frameEncoder->m_crc[2], height, width, stride);
+            updateCRC(reconPic->getCbAddr(cuAddr), rowHash[1], height, width, stride);
+            updateCRC(reconPic->getCrAddr(cuAddr), rowHash[2], height, width, stride);
         }
     }
     else if (m_param->decodedPictureHashSEI == 3)
@@ -620,28 +730,22 @@ void FrameFilter::processPostRow(int row)
         uint32_t height = m_parallelFilter[row].getCUHeight();
         intptr_t stride = reconPic->m_stride;
         uint32_t cuHeight = g_maxCUSize;
+        uint32_t* rowHash = m_parallelFilter[row].m_rowHash;
 
-        if (!row)
-            m_frameEncoder->m_checksum[0] = 0;
-
-        updateChecksum(reconPic->m_picOrg[0], m_frameEncoder->m_checksum[0], height, width, stride, row, cuHeight);
+        rowHash[0] = 0;
+        updateChecksum(reconPic->m_picOrg[0], rowHash[0], height, width, stride, row, cuHeight);
         if (m_param->internalCsp != X265_CSP_I400)
         {
             width >>= m_hChromaShift;
             height >>= m_vChromaShift;
             stride = reconPic->m_strideC;
             cuHeight >>= m_vChromaShift;
+            rowHash[1] = rowHash[2] = 0;
 
-            if (!row)
-                m_frameEncoder->m_checksum[1] = m_frameEncoder->m_checksum[2] = 0;
-
-            updateChecksum(reconPic->m_picOrg[1], m_frameEncoder->m_checksum[1], height, width, stride, row, cuHeight);
-            updateChecksum(reconPic->m_picOrg[2], m_frameEncoder->m_checksum[2], height, width, stride, row, cuHeight);
+            updateChecksum(reconPic->m_picOrg[1], rowHash[1], height, width, stride, row, cuHeight);
+            updateChecksum(reconPic->m_picOrg[2], rowHash[2], height, width, stride, row, cuHeight);
         }
     }
-
-    if (ATOMIC_INC(&m_frameEncoder->m_completionCount) == 2 * (int)m_frameEncoder->m_numRows)
-        m_frameEncoder->m_completionEvent.trigger();
 }
 
 static uint64_t computeSSD(pixel *fenc, pixel *rec, intptr_t stride, uint32_t width, uint32_t height)
@@ -73,6 +73,7 @@ public:
         ThreadSafeInteger   m_lastCol;          /* The column that next to process */
         ThreadSafeInteger   m_allowedCol;       /* The column that processed from Encode pipeline */
         ThreadSafeInteger   m_lastDeblocked;   /* The column that finished all of Deblock stages  */
+        uint32_t            m_rowHash[3];      /* CRC or checksum of the row of each plane */
 
         ParallelFilter()
             : m_rowHeight(0)
@@ -90,7 +91,7 @@ public:
         void processTasks(int workerThreadId);
 
         // Apply SAO on a CU in current row
-        void processSaoCTU(SAOParam *saoParam, int col);
+        void processSaoCTU(SAOParam *saoParam, int col, bool bDeferred);
 
         // Copy and Save SAO reference pixels for SAO Rdo decide
         void copySaoAboveRef(PicYuv* reconPic, uint32_t cuAddr, int col);
@@ -110,6 +111,41 @@ public:
 
     ParallelFilter*     m_parallelFilter;
 
+    /* Measures PSNR, SSIM and the picture hash of finished rows off the
+     * critical path, on one idle worker bonded as rows complete. Rows are
+     * measured strictly in order since the hashes are sequential */
+    class RowMetrics : public BondedTaskGroup
+    {
+    public:
+        FrameFilter*        m_frameFilter;
+        Lock                m_stateLock;
+        int                 m_rowsFinished;     /* rows handed over by processPostRow */
+        int                 m_rowsMeasured;     /* rows claimed for measurement */
+        bool                m_bActive;          /* a bonded peer is measuring rows */
+
+        RowMetrics()
+            : m_frameFilter(NULL)
+            , m_rowsFinished(0)
+            , m_rowsMeasured(0)
+            , m_bActive(false)
+        {
+        }
+
+        void processTasks(int workerThreadId);
+
+        // Hand over a finished row, bond an idle peer if none is measuring
+        void rowFinished();
+
+        // Wait for the bonded peer and measure the remaining rows
+        void finish();
+
+    protected:
+
+        RowMetrics operator=(const RowMetrics&);
+    };
+
+    RowMetrics          m_rowMetrics;
+
     FrameFilter()
         : m_param(NULL)
         , m_frame(NULL)
@@ -131,6 +167,11 @@ public:
 
     void processRow(int row);
     void processPostRow(int row);
+    void computeRowMetrics(int row);
+
+    // Must be called before the frame's metrics or hash SEI are used, it
+    // also combines the row CRCs or checksums of the picture hash
+    void finishRowMetrics();
 };
 }
 
@@ -28,21 +28,136 @@
 
 using namespace X265_NS;
 
+namespace {
+
+/* sets the high bit of each byte of x which is zero, and clears all others */
+inline uint64_t zeroBytes(uint64_t x)
+{
+    const uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+    return ~(((x & low7) + low7) | x | low7);
+}
+
+/* Returns the position of the first pair of zero bytes at or after start,
+ * or size if there is none. Only such pairs can require emulation
+ * prevention, so the bytes before them can be copied as they are. Tests 32
+ * bytes per iteration, as four 64-bit words plus the byte pairs which
+ * straddle the words */
+uint32_t findZeroPair(const uint8_t* buf, uint32_t start, uint32_t size)
+{
+    uint32_t i = start;
+    for (; i + 32 < size; i += 32)
+    {
+        uint64_t w[4];
+        memcpy(w, buf + i, sizeof(w));
+
+        uint64_t pairs = 0;
+        for (int k = 0; k < 4; k++)
+        {
+            uint64_t z = zeroBytes(w[k]);
+            pairs |= z & ((z >> 8) | (z << 8));
+        }
+
+        if (pairs || !(buf[i + 7] | buf[i + 8]) || !(buf[i + 15] | buf[i + 16]) ||
+            !(buf[i + 23] | buf[i + 24]) || !(buf[i + 31] | buf[i + 32]))
+            break;
+    }
+
+    for (; i + 1 < size; i++)
+        if (!(buf[i] | buf[i + 1]))
+            return i;
+
+    return size;
+}
+
+/* Appends size bytes of in to out, inserting an emulation prevention byte
+ * before each byte <= 0x03 which follows two zero bytes (7.4.2). zeros is
+ * the number of zero bytes which end the output so far, it is updated for
+ * the next call. Returns the number of bytes output, or when out is NULL
+ * the number of bytes which would have been output */
+uint32_t escapeBytes(uint8_t* out, const uint8_t* in, uint32_t size, uint32_t& zeros)
+{
+    uint32_t bytes = 0;
+    uint32_t i = 0;
+    while (i < size)
+    {
+        if (!zeros)
+        {
+            /* no escape is possible before the next pair of zero bytes */
+            uint32_t end = findZeroPair(in, i, size);
+            if (end > i)
+            {
+                if (out)
+                    memcpy(out + bytes, in + i, end - i);
+                bytes += end - i;
+                zeros = !in[end - 1];
+                i = end;
+                if (i == size)
+                    break;
+            }
+        }
+
+        uint8_t b = in[i++];
+        if (zeros >= 2 && b <= 0x03)
+        {
+            if (out)
+                out[bytes] = 0x03;
+            bytes++;
+            zeros = 0;
+        }
+        if (out)
+            out[bytes] = b;
+        bytes++;
+        zeros = b ? 0 : zeros + 1;
+    }
+
+    return bytes;
+}
+
+}
+
 NALList::NALList()
     : m_numNal(0)
     , m_buffer(NULL)
     , m_occupancy(0)
     , m_allocSize(0)
-    , m_extraBuffer(NULL)
-    , m_extraOccupancy(0)
-    , m_extraAllocSize(0)
+    , m_substreams(NULL)
+    , m_numSubstreams(0)
+    , m_substreamBytes(0)
     , m_annexB(true)
+    , m_bufferAlloc(NULL)
+    , m_bufferFree(NULL)
+    , m_bufferOpaque(NULL)
 {}
 
+void NALList::init(const x265_param& param)
+{
+    m_annexB = !!param.bAnnexB;
+    m_bufferAlloc = param.nalBufferAlloc;
+    m_bufferFree = param.nalBufferFree;
+    m_bufferOpaque = param.nalBufferOpaque;
+}
+
+uint8_t* NALList::allocBuffer(uint32_t size)
+{
+    if (m_bufferAlloc)
+        return (uint8_t*)m_bufferAlloc(m_bufferOpaque, size);
+    return X265_MALLOC(uint8_t, size);
+}
+
+void NALList::freeBuffer(uint8_t* buffer)
+{
+    if (!buffer)
+        return;
+    if (m_bufferFree)
+        m_bufferFree(m_bufferOpaque, buffer);
+    else
+        X265_FREE(buffer);
+}
+
 void NALList::takeContents(NALList& other)
 {
     /* take other NAL buffer, discard our old one */
-    X265_FREE(m_buffer);
+    freeBuffer(m_buffer);
     m_buffer = other.m_buffer;
     m_allocSize = other.m_allocSize;
     m_occupancy = other.m_occupancy;
@@ -54,7 +169,9 @@ void NALList::takeContents(NALList& other)
     /* reset other list, re-allocate their buffer with same size */
     other.m_numNal = 0;
     other.m_occupancy = 0;
-    other.m_buffer = X265_MALLOC(uint8_t, m_allocSize);
+    other.m_buffer = other.allocBuffer(m_allocSize);
+    if (!other.m_buffer)
+        other.m_allocSize = 0;
 }
 
 void NALList::serialize(NalUnitType nalUnitType, const Bitstream& bs)
@@ -66,10 +183,12 @@ void NALList::serialize(NalUnitType nalUnitType, const Bitstream& bs)
     if (!bpayload)
         return;
 
-    uint32_t nextSize = m_occupancy + sizeof(startCodePrefix) + 2 + payloadSize + (payloadSize >> 1) + m_extraOccupancy;
+    uint32_t nextSize = m_occupancy + sizeof(startCodePrefix) + 2 + payloadSize + (payloadSize >> 1) + m_substreamBytes + 1;
     if (nextSize > m_allocSize)
     {
-        uint8_t *temp = X265_MALLOC(uint8_t, nextSize);
+        /* grow geometrically, every growth copies the access unit so far */
+        uint32_t allocSize = X265_MAX(nextSize, m_allocSize * 2);
+        uint8_t *temp = allocBuffer(allocSize);
         if (temp)
         {
             memcpy(temp, m_buffer, m_occupancy);
@@ -78,9 +197,9 @@ void NALList::serialize(NalUnitType nalUnitType, const Bitstream& bs)
             for (uint32_t i = 0; i < m_numNal; i++)
                 m_nal[i].payload = temp + (m_nal[i].payload - m_buffer);
 
-            X265_FREE(m_buffer);
+            freeBuffer(m_buffer);
             m_buffer = temp;
-            m_allocSize = nextSize;
+            m_allocSize = allocSize;
         }
         else
         {
@@ -121,28 +240,34 @@ void NALList::serialize(NalUnitType nalUnitType, const Bitstream& bs)
      * any byte-aligned position:
      *  - 0x000000
      *  - 0x000001
-     *  - 0x000002 */
-    for (uint32_t i = 0; i < payloadSize; i++)
+     *  - 0x000002
+     * The header ends in a non-zero byte. The last payload byte is not
+     * escaped, it is followed by the substreams or is the end of the RBSP */
+    if (payloadSize)
     {
-        if (i > 2 && !out[bytes - 2] && !out[bytes - 3] && out[bytes - 1] <= 0x03)
-        {
-            /* inject 0x03 to prevent emulating a start code */
-            out[bytes] = out[bytes - 1];
-            out[bytes - 1] = 0x03;
-            bytes++;
-        }
-
-        out[bytes++] = bpayload[i];
+        uint32_t zeros = 0;
+        bytes += escapeBytes(out + bytes, bpayload, payloadSize - 1, zeros);
+        out[bytes++] = bpayload[payloadSize - 1];
     }
 
     X265_CHECK(bytes <= 4 + 2 + payloadSize + (payloadSize >> 1), "NAL buffer overflow\n");
 
-    if (m_extraOccupancy)
+    if (m_numSubstreams)
     {
-        /* these bytes were escaped by serializeSubstreams */
-        memcpy(out + bytes, m_extraBuffer, m_extraOccupancy);
-        bytes += m_extraOccupancy;
-        m_extraOccupancy = 0;
+        /* escaped as one run, independently of the payload */
+        uint32_t zeros = 0;
+#if CHECKED_BUILD || _DEBUG
+        uint32_t substreamStart = bytes;
+#endif
+        for (uint32_t s = 0; s < m_numSubstreams; s++)
+        {
+            if (m_substreams[s].getFIFO())
+                bytes += escapeBytes(out + bytes, m_substreams[s].getFIFO(), m_substreams[s].getNumberOfWrittenBytes(), zeros);
+        }
+        X265_CHECK(bytes - substreamStart == m_substreamBytes, "substream size mismatch\n");
+        m_substreams = NULL;
+        m_numSubstreams = 0;
+        m_substreamBytes = 0;
     }
 
     /* 7.4.1.1
@@ -171,34 +296,14 @@ void NALList::serialize(NalUnitType nalUnitType, const Bitstream& bs)
     nal.payload = out;
 }
 
-/* concatenate and escape WPP sub-streams, return escaped row lengths.
- * These streams will be appended to the next serialized NAL */
+/* measure the escaped lengths of the concatenated WPP sub-streams, return the
+ * largest. The streams are escaped into the next serialized NAL, they must
+ * remain unchanged until then */
 uint32_t NALList::serializeSubstreams(uint32_t* streamSizeBytes, uint32_t streamCount, const Bitstream* streams)
 {
     uint32_t maxStreamSize = 0;
-    uint32_t estSize = 0;
-    for (uint32_t s = 0; s < streamCount; s++)
-        estSize += streams[s].getNumberOfWrittenBytes();
-    estSize += estSize >> 1;
-
-    if (estSize > m_extraAllocSize)
-    {
-        uint8_t *temp = X265_MALLOC(uint8_t, estSize);
-        if (temp)
-        {
-            X265_FREE(m_extraBuffer);
-            m_extraBuffer = temp;
-            m_extraAllocSize = estSize;
-        }
-        else
-        {
-            x265_log(NULL, X265_LOG_ERROR, "Unable to realloc WPP substream concatenation buffer\n");
-            return 0;
-        }
-    }
-
     uint32_t bytes = 0;
-    uint8_t *out = m_extraBuffer;
+    uint32_t zeros = 0;
     for (uint32_t s = 0; s < streamCount; s++)
     {
         const Bitstream& stream = streams[s];
@@ -207,18 +312,7 @@ uint32_t NALList::serializeSubstreams(uint32_t* streamSizeBytes, uint32_t stream
         uint32_t prevBufSize = bytes;
 
         if (inBytes)
-        {
-            for (uint32_t i = 0; i < inSize; i++)
-            {
-                if (bytes >= 2 && !out[bytes - 2] && !out[bytes - 1] && inBytes[i] <= 0x03)
-                {
-                    /* inject 0x03 to prevent emulating a start code */
-                    out[bytes++] = 3;
-                }
-
-                out[bytes++] = inBytes[i];
-            }
-        }
+            bytes += escapeBytes(NULL, inBytes, inSize, zeros);
 
         if (s < streamCount - 1)
         {
@@ -228,6 +322,8 @@ uint32_t NALList::serializeSubstreams(uint32_t* streamSizeBytes, uint32_t stream
         }
     }
 
-    m_extraOccupancy = bytes;
+    m_substreams = streams;
+    m_numSubstreams = streamCount;
+    m_substreamBytes = bytes;
     return maxStreamSize;
 }
@@ -34,7 +34,7 @@ class Bitstream;
 
 class NALList
 {
-    static const int MAX_NAL_UNITS = 16;
+    static const int MAX_NAL_UNITS = 16 + X265_MAX_SLICES;
 
 public:
 
@@ -45,19 +45,33 @@ public:
     uint32_t    m_occupancy;
     uint32_t    m_allocSize;
 
-    uint8_t*    m_extraBuffer;
-    uint32_t    m_extraOccupancy;
-    uint32_t    m_extraAllocSize;
+    /* WPP substreams measured by serializeSubstreams(), which are escaped
+     * straight into the buffer after the next serialized NAL */
+    const Bitstream* m_substreams;
+    uint32_t    m_numSubstreams;
+    uint32_t    m_substreamBytes;
     bool        m_annexB;
 
+    /* optional user allocator of the access unit buffers, see x265_param */
+    void*       (*m_bufferAlloc)(void* opaque, uint32_t size);
+    void        (*m_bufferFree)(void* opaque, void* buffer);
+    void*       m_bufferOpaque;
+
     NALList();
-    ~NALList() { X265_FREE(m_buffer); X265_FREE(m_extraBuffer); }
+    ~NALList() { freeBuffer(m_buffer); }
+
+    void init(const x265_param& param);
 
     void takeContents(NALList& other);
 
     void serialize(NalUnitType nalUnitType, const Bitstream& bs);
 
     uint32_t serializeSubstreams(uint32_t* streamSizeBytes, uint32_t streamCount, const Bitstream* streams);
+
+protected:
+
+    uint8_t* allocBuffer(uint32_t size);
+    void     freeBuffer(uint8_t* buffer);
 };
 
 }
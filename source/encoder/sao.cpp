@@ -57,6 +57,15 @@ inline int64_t estSaoDist(int32_t count, int32_t offset, int32_t offsetOrg)
 {
     return (count * offset - offsetOrg * 2) * offset;
 }
+
+/* block of a SAO type for saoCuStatsAll */
+inline void setStatsBlock(int* bounds, int startX, int startY, int endX, int endY)
+{
+    bounds[0] = startX;
+    bounds[1] = startY;
+    bounds[2] = endX;
+    bounds[3] = endY;
+}
 } // end anonymous namespace
 
 
@@ -82,12 +91,11 @@ SAO::SAO()
     m_tmpU[0] = NULL;
     m_tmpU[1] = NULL;
     m_tmpU[2] = NULL;
-    m_tmpL1[0] = NULL;
-    m_tmpL1[1] = NULL;
-    m_tmpL1[2] = NULL;
-    m_tmpL2[0] = NULL;
-    m_tmpL2[1] = NULL;
-    m_tmpL2[2] = NULL;
+    memset(m_tmpL1, 0, sizeof(m_tmpL1));
+    memset(m_tmpL2, 0, sizeof(m_tmpL2));
+    m_tmpDeferredU[0] = NULL;
+    m_tmpDeferredU[1] = NULL;
+    m_tmpDeferredU[2] = NULL;
     m_depthSaoRate = NULL;
 }
 
@@ -107,13 +115,18 @@ bool SAO::create(x265_param* param, int initCommon)
 
     for (int i = 0; i < (param->internalCsp != X265_CSP_I400 ? 3 : 1); i++)
     {
-        CHECKED_MALLOC(m_tmpL1[i], pixel, g_maxCUSize + 1);
-        CHECKED_MALLOC(m_tmpL2[i], pixel, g_maxCUSize + 1);
+        for (int pass = 0; pass < 2; pass++)
+        {
+            CHECKED_MALLOC(m_tmpL1[pass][i], pixel, g_maxCUSize + 1);
+            CHECKED_MALLOC(m_tmpL2[pass][i], pixel, g_maxCUSize + 1);
+        }
 
         // SAO asm code will read 1 pixel before and after, so pad by 2
         // NOTE: m_param->sourceWidth+2 enough, to avoid condition check in copySaoAboveRef(), I alloc more up to 63 bytes in here
         CHECKED_MALLOC(m_tmpU[i], pixel, m_numCuInWidth * g_maxCUSize + 2 + 32);
         m_tmpU[i] += 1;
+        CHECKED_MALLOC(m_tmpDeferredU[i], pixel, m_numCuInWidth * g_maxCUSize + 2 + 32);
+        m_tmpDeferredU[i] += 1;
     }
 
     if (initCommon)
@@ -183,16 +196,19 @@ void SAO::destroy(int destoryCommon)
 {
     for (int i = 0; i < 3; i++)
     {
-        if (m_tmpL1[i])
+        for (int pass = 0; pass < 2; pass++)
         {
-            X265_FREE(m_tmpL1[i]);
-            m_tmpL1[i] = NULL;
-        }
+            if (m_tmpL1[pass][i])
+            {
+                X265_FREE(m_tmpL1[pass][i]);
+                m_tmpL1[pass][i] = NULL;
+            }
 
-        if (m_tmpL2[i])
-        {
-            X265_FREE(m_tmpL2[i]);
-            m_tmpL2[i] = NULL;
+            if (m_tmpL2[pass][i])
+            {
+                X265_FREE(m_tmpL2[pass][i]);
+                m_tmpL2[pass][i] = NULL;
+            }
         }
 
         if (m_tmpU[i])
@@ -200,6 +216,12 @@ void SAO::destroy(int destoryCommon)
             X265_FREE(m_tmpU[i] - 1);
             m_tmpU[i] = NULL;
         }
+
+        if (m_tmpDeferredU[i])
+        {
+            X265_FREE(m_tmpDeferredU[i] - 1);
+            m_tmpDeferredU[i] = NULL;
+        }
     }
 
     if (destoryCommon)
@@ -271,7 +293,9 @@ void SAO::startSlice(Frame* frame, Entropy& initState)
 }
 
 // CTU-based SAO process without slice granularity
-void SAO::applyPixelOffsets(int addr, int typeIdx, int plane)
+/* Filters the lines [lineBegin, lineEnd) of the CTU. The lines above lineBegin
+ * are already filtered, their unfiltered last line is in m_tmpDeferredU */
+void SAO::applyPixelOffsets(int addr, int typeIdx, int plane, int lineBegin, int lineEnd)
 {
     PicYuv* reconPic = m_frame->m_reconPic;
     pixel* rec = reconPic->getPlaneAddr(plane, addr);
@@ -296,16 +320,25 @@ void SAO::applyPixelOffsets(int addr, int typeIdx, int plane)
     uint32_t bpely = x265_min(tpely + ctuHeight, picHeight);
     ctuWidth  = rpelx - lpelx;
     ctuHeight = bpely - tpely;
+    lineEnd   = x265_min(lineEnd, ctuHeight);
+
+    /* pixels of neighboring slices are not used */
+    bool bAboveUnavail = !lineBegin && (!tpely || cu->m_bFirstRowInSlice);
+    bool bBelowUnavail = lineEnd == ctuHeight && (bpely == picHeight || cu->m_bLastRowInSlice);
+
+    rec += lineBegin * stride;
+    ctuHeight = lineEnd - lineBegin;
 
     int8_t _upBuff1[MAX_CU_SIZE + 2], *upBuff1 = _upBuff1 + 1, signLeft1[2];
     int8_t _upBufft[MAX_CU_SIZE + 2], *upBufft = _upBufft + 1;
 
     memset(_upBuff1 + MAX_CU_SIZE, 0, 2 * sizeof(int8_t)); /* avoid valgrind uninit warnings */
 
-    pixel* tmpL = m_tmpL1[plane];
-    pixel* tmpU = &(m_tmpU[plane][lpelx]);
+    const int bDeferred = lineBegin > 0;
+    pixel* tmpL = m_tmpL1[bDeferred][plane];
+    pixel* tmpU = &((bDeferred ? m_tmpDeferredU : m_tmpU)[plane][lpelx]);
 
-    int8_t* offsetEo = m_offsetEo[plane];
+    int8_t* offsetEo = m_offsetEo[bDeferred][plane];
 
     switch (typeIdx)
     {
@@ -367,9 +400,9 @@ void SAO::applyPixelOffsets(int addr, int typeIdx, int plane)
     }
     case SAO_EO_1: // dir: |
     {
-        int startY = !tpely;
-        int endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight;
-        if (!tpely)
+        int startY = bAboveUnavail;
+        int endY   = bBelowUnavail ? ctuHeight - 1 : ctuHeight;
+        if (bAboveUnavail)
             rec += stride;
 
         if (ctuWidth & 15)
@@ -408,10 +441,10 @@ void SAO::applyPixelOffsets(int addr, int typeIdx, int plane)
         int startX = !lpelx;
         int endX   = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth;
 
-        int startY = !tpely;
-        int endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight;
+        int startY = bAboveUnavail;
+        int endY   = bBelowUnavail ? ctuHeight - 1 : ctuHeight;
 
-        if (!tpely)
+        if (bAboveUnavail)
             rec += stride;
 
         if (!(ctuWidth & 15))
@@ -474,10 +507,10 @@ void SAO::applyPixelOffsets(int addr, int typeIdx, int plane)
         int startX = !lpelx;
         int endX   = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth;
 
-        int startY = !tpely;
-        int endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight;
+        int startY = bAboveUnavail;
+        int endY   = bBelowUnavail ? ctuHeight - 1 : ctuHeight;
 
-        if (!tpely)
+        if (bAboveUnavail)
             rec += stride;
 
         if (ctuWidth & 15)
@@ -538,7 +571,7 @@ void SAO::applyPixelOffsets(int addr, int typeIdx, int plane)
     }
     case SAO_BO:
     {
-        const int8_t* offsetBo = m_offsetBo[plane];
+        const int8_t* offsetBo = m_offsetBo[bDeferred][plane];
 
         if (ctuWidth & 15)
         {
@@ -558,22 +591,33 @@ void SAO::applyPixelOffsets(int addr, int typeIdx, int plane)
     }
 }
 
-/* Process SAO unit */
-void SAO::generateLumaOffsets(SaoCtuParam* ctuParam, int idxY, int idxX)
+/* Process SAO unit. The last lines of a CTU are still modified by the deblocking
+ * of the CTU row below, so SAO is applied in two passes: all lines above them
+ * as soon as the CTU is deblocked, while it is still in cache, and the deferred
+ * lines once the row below is deblocked. CTUs of the last row are filtered in
+ * the first pass. The unfiltered line above the deferred lines is saved in
+ * m_tmpDeferredU by FrameFilter::ParallelFilter::copySaoAboveRef() */
+void SAO::generateLumaOffsets(SaoCtuParam* ctuParam, int idxY, int idxX, bool bDeferred)
 {
     PicYuv* reconPic = m_frame->m_reconPic;
     intptr_t stride = reconPic->m_stride;
     int ctuWidth  = g_maxCUSize;
     int ctuHeight = g_maxCUSize;
 
+    int splitLine = idxY == m_numCuInHeight - 1 ? ctuHeight : ctuHeight - SAO_DEFERRED_LINES;
+    int lineBegin = bDeferred ? splitLine : 0;
+    int lineEnd   = bDeferred ? ctuHeight : splitLine;
+    if (lineBegin == lineEnd)
+        return;
+
     int addr = idxY * m_numCuInWidth + idxX;
-    pixel* rec = reconPic->getLumaAddr(addr);
+    pixel* rec = reconPic->getLumaAddr(addr) + lineBegin * stride;
 
     if (idxX == 0)
     {
-        for (int i = 0; i < ctuHeight + 1; i++)
+        for (int i = 0; i < lineEnd - lineBegin + 1; i++)
         {
-            m_tmpL1[0][i] = rec[0];
+            m_tmpL1[bDeferred][0][i] = rec[0];
             rec += stride;
         }
     }
@@ -583,10 +627,10 @@ void SAO::generateLumaOffsets(SaoCtuParam* ctuParam, int idxY, int idxX)
 
     if (idxX != (m_numCuInWidth - 1))
     {
-        rec = reconPic->getLumaAddr(addr);
-        for (int i = 0; i < ctuHeight + 1; i++)
+        rec = reconPic->getLumaAddr(addr) + lineBegin * stride;
+        for (int i = 0; i < lineEnd - lineBegin + 1; i++)
         {
-            m_tmpL2[0][i] = rec[ctuWidth - 1];
+            m_tmpL2[bDeferred][0][i] = rec[ctuWidth - 1];
             rec += stride;
         }
     }
@@ -597,10 +641,10 @@ void SAO::generateLumaOffsets(SaoCtuParam* ctuParam, int idxY, int idxX)
         {
             if (typeIdx == SAO_BO)
             {
-                memset(m_offsetBo[0], 0, sizeof(m_offsetBo[0]));
+                memset(m_offsetBo[bDeferred][0], 0, sizeof(m_offsetBo[0][0]));
 
                 for (int i = 0; i < SAO_NUM_OFFSET; i++)
-                    m_offsetBo[0][((ctuParam[addr].bandPos + i) & (MAX_NUM_SAO_CLASS - 1))] = (int8_t)(ctuParam[addr].offset[i] << SAO_BIT_INC);
+                    m_offsetBo[bDeferred][0][((ctuParam[addr].bandPos + i) & (MAX_NUM_SAO_CLASS - 1))] = (int8_t)(ctuParam[addr].offset[i] << SAO_BIT_INC);
             }
             else // if (typeIdx == SAO_EO_0 || typeIdx == SAO_EO_1 || typeIdx == SAO_EO_2 || typeIdx == SAO_EO_3)
             {
@@ -610,16 +654,16 @@ void SAO::generateLumaOffsets(SaoCtuParam* ctuParam, int idxY, int idxX)
                     offset[i + 1] = ctuParam[addr].offset[i] << SAO_BIT_INC;
 
                 for (int edgeType = 0; edgeType < NUM_EDGETYPE; edgeType++)
-                    m_offsetEo[0][edgeType] = (int8_t)offset[s_eoTable[edgeType]];
+                    m_offsetEo[bDeferred][0][edgeType] = (int8_t)offset[s_eoTable[edgeType]];
             }
         }
-        applyPixelOffsets(addr, typeIdx, 0);
+        applyPixelOffsets(addr, typeIdx, 0, lineBegin, lineEnd);
     }
-    std::swap(m_tmpL1[0], m_tmpL2[0]);
+    std::swap(m_tmpL1[bDeferred][0], m_tmpL2[bDeferred][0]);
 }
 
 /* Process SAO unit (Chroma only) */
-void SAO::generateChromaOffsets(SaoCtuParam* ctuParam[3], int idxY, int idxX)
+void SAO::generateChromaOffsets(SaoCtuParam* ctuParam[3], int idxY, int idxX, bool bDeferred)
 {
     PicYuv* reconPic = m_frame->m_reconPic;
     intptr_t stride = reconPic->m_strideC;
@@ -631,16 +675,22 @@ void SAO::generateChromaOffsets(SaoCtuParam* ctuParam[3], int idxY, int idxX)
         ctuHeight >>= m_vChromaShift;
     }
 
+    int splitLine = idxY == m_numCuInHeight - 1 ? ctuHeight : ctuHeight - (SAO_DEFERRED_LINES >> m_vChromaShift);
+    int lineBegin = bDeferred ? splitLine : 0;
+    int lineEnd   = bDeferred ? ctuHeight : splitLine;
+    if (lineBegin == lineEnd)
+        return;
+
     int addr = idxY * m_numCuInWidth + idxX;
-    pixel* recCb = reconPic->getCbAddr(addr);
-    pixel* recCr = reconPic->getCrAddr(addr);
+    pixel* recCb = reconPic->getCbAddr(addr) + lineBegin * stride;
+    pixel* recCr = reconPic->getCrAddr(addr) + lineBegin * stride;
 
     if (idxX == 0)
     {
-        for (int i = 0; i < ctuHeight + 1; i++)
+        for (int i = 0; i < lineEnd - lineBegin + 1; i++)
         {
-            m_tmpL1[1][i] = recCb[0];
-            m_tmpL1[2][i] = recCr[0];
+            m_tmpL1[bDeferred][1][i] = recCb[0];
+            m_tmpL1[bDeferred][2][i] = recCr[0];
             recCb += stride;
             recCr += stride;
         }
@@ -654,12 +704,12 @@ void SAO::generateChromaOffsets(SaoCtuParam* ctuParam[3], int idxY, int idxX)
 
     if (idxX != (m_numCuInWidth - 1))
     {
-        recCb = reconPic->getCbAddr(addr);
-        recCr = reconPic->getCrAddr(addr);
-        for (int i = 0; i < ctuHeight + 1; i++)
+        recCb = reconPic->getCbAddr(addr) + lineBegin * stride;
+        recCr = reconPic->getCrAddr(addr) + lineBegin * stride;
+        for (int i = 0; i < lineEnd - lineBegin + 1; i++)
         {
-            m_tmpL2[1][i] = recCb[ctuWidth - 1];
-            m_tmpL2[2][i] = recCr[ctuWidth - 1];
+            m_tmpL2[bDeferred][1][i] = recCb[ctuWidth - 1];
+            m_tmpL2[bDeferred][2][i] = recCr[ctuWidth - 1];
             recCb += stride;
             recCr += stride;
         }
@@ -672,10 +722,10 @@ void SAO::generateChromaOffsets(SaoCtuParam* ctuParam[3], int idxY, int idxX)
         {
             if (typeIdxCb == SAO_BO)
             {
-                memset(m_offsetBo[1], 0, sizeof(m_offsetBo[0]));
+                memset(m_offsetBo[bDeferred][1], 0, sizeof(m_offsetBo[0][0]));
 
                 for (int i = 0; i < SAO_NUM_OFFSET; i++)
-                    m_offsetBo[1][((ctuParam[1][addr].bandPos + i) & (MAX_NUM_SAO_CLASS - 1))] = (int8_t)(ctuParam[1][addr].offset[i] << SAO_BIT_INC);
+                    m_offsetBo[bDeferred][1][((ctuParam[1][addr].bandPos + i) & (MAX_NUM_SAO_CLASS - 1))] = (int8_t)(ctuParam[1][addr].offset[i] << SAO_BIT_INC);
             }
             else // if (typeIdx == SAO_EO_0 || typeIdx == SAO_EO_1 || typeIdx == SAO_EO_2 || typeIdx == SAO_EO_3)
             {
@@ -685,10 +735,10 @@ void SAO::generateChromaOffsets(SaoCtuParam* ctuParam[3], int idxY, int idxX)
                     offset[i + 1] = ctuParam[1][addr].offset[i] << SAO_BIT_INC;
 
                 for (int edgeType = 0; edgeType < NUM_EDGETYPE; edgeType++)
-                    m_offsetEo[1][edgeType] = (int8_t)offset[s_eoTable[edgeType]];
+                    m_offsetEo[bDeferred][1][edgeType] = (int8_t)offset[s_eoTable[edgeType]];
             }
         }
-        applyPixelOffsets(addr, typeIdxCb, 1);
+        applyPixelOffsets(addr, typeIdxCb, 1, lineBegin, lineEnd);
     }
 
     // Process V
@@ -698,10 +748,10 @@ void SAO::generateChromaOffsets(SaoCtuParam* ctuParam[3], int idxY, int idxX)
         {
             if (typeIdxCr == SAO_BO)
             {
-                memset(m_offsetBo[2], 0, sizeof(m_offsetBo[0]));
+                memset(m_offsetBo[bDeferred][2], 0, sizeof(m_offsetBo[0][0]));
 
                 for (int i = 0; i < SAO_NUM_OFFSET; i++)
-                    m_offsetBo[2][((ctuParam[2][addr].bandPos + i) & (MAX_NUM_SAO_CLASS - 1))] = (int8_t)(ctuParam[2][addr].offset[i] << SAO_BIT_INC);
+                    m_offsetBo[bDeferred][2][((ctuParam[2][addr].bandPos + i) & (MAX_NUM_SAO_CLASS - 1))] = (int8_t)(ctuParam[2][addr].offset[i] << SAO_BIT_INC);
             }
             else // if (typeIdx == SAO_EO_0 || typeIdx == SAO_EO_1 || typeIdx == SAO_EO_2 || typeIdx == SAO_EO_3)
             {
@@ -711,14 +761,14 @@ void SAO::generateChromaOffsets(SaoCtuParam* ctuParam[3], int idxY, int idxX)
                     offset[i + 1] = ctuParam[2][addr].offset[i] << SAO_BIT_INC;
 
                 for (int edgeType = 0; edgeType < NUM_EDGETYPE; edgeType++)
-                    m_offsetEo[2][edgeType] = (int8_t)offset[s_eoTable[edgeType]];
+                    m_offsetEo[bDeferred][2][edgeType] = (int8_t)offset[s_eoTable[edgeType]];
             }
         }
-        applyPixelOffsets(addr, typeIdxCb, 2);
+        applyPixelOffsets(addr, typeIdxCb, 2, lineBegin, lineEnd);
     }
 
-    std::swap(m_tmpL1[1], m_tmpL2[1]);
-    std::swap(m_tmpL1[2], m_tmpL2[2]);
+    std::swap(m_tmpL1[bDeferred][1], m_tmpL2[bDeferred][1]);
+    std::swap(m_tmpL1[bDeferred][2], m_tmpL2[bDeferred][2]);
 }
 
 /* Calculate SAO statistics for current CTU without non-crossing slice */
@@ -750,6 +800,7 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
     uint32_t bpely = x265_min(tpely + ctuHeight, picHeight);
     ctuWidth  = rpelx - lpelx;
     ctuHeight = bpely - tpely;
+    bool bAboveUnavail = !tpely || cu->m_bFirstRowInSlice;
 
     int startX;
     int startY;
@@ -764,6 +815,10 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
 
     ALIGN_VAR_32(int16_t, diff[MAX_CU_SIZE * MAX_CU_SIZE]);
 
+    // With the single pass kernel the blocks of the types are only collected below
+    const bool bStatsAll = !!primitives.saoCuStatsAll;
+    int bounds[MAX_NUM_SAO_TYPE][4];
+
     // Calculate (fenc - frec) and put into diff[]
     if ((lpelx + ctuWidth <  picWidth) & (tpely + ctuHeight < picHeight))
     {
@@ -797,7 +852,9 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
         endX = (rpelx == picWidth) ? ctuWidth : ctuWidth - skipR + plane_offset;
         endY = (bpely == picHeight) ? ctuHeight : ctuHeight - skipB + plane_offset;
 
-        primitives.saoCuStatsBO(diff, rec0, stride, endX, endY, m_offsetOrg[plane][SAO_BO], m_count[plane][SAO_BO]);
+        setStatsBlock(bounds[SAO_BO], 0, 0, endX, endY);
+        if (!bStatsAll)
+            primitives.saoCuStatsBO(diff, rec0, stride, endX, endY, m_offsetOrg[plane][SAO_BO], m_count[plane][SAO_BO]);
     }
 
     {
@@ -812,7 +869,9 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
             startX = !lpelx;
             endX   = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth - skipR + plane_offset;
 
-            primitives.saoCuStatsE0(diff + startX, rec0 + startX, stride, endX - startX, ctuHeight - skipB + plane_offset, m_offsetOrg[plane][SAO_EO_0], m_count[plane][SAO_EO_0]);
+            setStatsBlock(bounds[SAO_EO_0], startX, 0, endX, ctuHeight - skipB + plane_offset);
+            if (!bStatsAll)
+                primitives.saoCuStatsE0(diff + startX, rec0 + startX, stride, endX - startX, ctuHeight - skipB + plane_offset, m_offsetOrg[plane][SAO_EO_0], m_count[plane][SAO_EO_0]);
         }
 
         // SAO_EO_1: // dir: |
@@ -825,17 +884,21 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
 
             rec  = rec0;
 
-            startY = !tpely;
+            startY = bAboveUnavail;
             endX   = (rpelx == picWidth) ? ctuWidth : ctuWidth - skipR + plane_offset;
             endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight - skipB + plane_offset;
-            if (!tpely)
+            if (bAboveUnavail)
             {
                 rec += stride;
             }
 
-            primitives.sign(upBuff1, rec, &rec[- stride], ctuWidth);
+            setStatsBlock(bounds[SAO_EO_1], 0, startY, endX, endY);
+            if (!bStatsAll)
+            {
+                primitives.sign(upBuff1, rec, &rec[- stride], ctuWidth);
 
-            primitives.saoCuStatsE1(diff + startY * MAX_CU_SIZE, rec0 + startY * stride, stride, upBuff1, endX, endY - startY, m_offsetOrg[plane][SAO_EO_1], m_count[plane][SAO_EO_1]);
+                primitives.saoCuStatsE1(diff + startY * MAX_CU_SIZE, rec0 + startY * stride, stride, upBuff1, endX, endY - startY, m_offsetOrg[plane][SAO_EO_1], m_count[plane][SAO_EO_1]);
+            }
         }
 
         // SAO_EO_2: // dir: 135
@@ -852,17 +915,21 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
             startX = !lpelx;
             endX   = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth - skipR + plane_offset;
 
-            startY = !tpely;
+            startY = bAboveUnavail;
             endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight - skipB + plane_offset;
-            if (!tpely)
+            if (bAboveUnavail)
             {
                 fenc += stride;
                 rec += stride;
             }
 
-            primitives.sign(upBuff1, &rec[startX], &rec[startX - stride - 1], (endX - startX));
+            setStatsBlock(bounds[SAO_EO_2], startX, startY, endX, endY);
+            if (!bStatsAll)
+            {
+                primitives.sign(upBuff1, &rec[startX], &rec[startX - stride - 1], (endX - startX));
 
-            primitives.saoCuStatsE2(diff + startX + startY * MAX_CU_SIZE, rec0  + startX + startY * stride, stride, upBuff1, upBufft, endX - startX, endY - startY, m_offsetOrg[plane][SAO_EO_2], m_count[plane][SAO_EO_2]);
+                primitives.saoCuStatsE2(diff + startX + startY * MAX_CU_SIZE, rec0  + startX + startY * stride, stride, upBuff1, upBufft, endX - startX, endY - startY, m_offsetOrg[plane][SAO_EO_2], m_count[plane][SAO_EO_2]);
+            }
         }
 
         // SAO_EO_3: // dir: 45
@@ -879,20 +946,27 @@ void SAO::calcSaoStatsCTU(int addr, int plane)
             startX = !lpelx;
             endX   = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth - skipR + plane_offset;
 
-            startY = !tpely;
+            startY = bAboveUnavail;
             endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight - skipB + plane_offset;
 
-            if (!tpely)
+            if (bAboveUnavail)
             {
                 fenc += stride;
                 rec += stride;
             }
 
-            primitives.sign(upBuff1, &rec[startX - 1], &rec[startX - 1 - stride + 1], (endX - startX + 1));
+            setStatsBlock(bounds[SAO_EO_3], startX, startY, endX, endY);
+            if (!bStatsAll)
+            {
+                primitives.sign(upBuff1, &rec[startX - 1], &rec[startX - 1 - stride + 1], (endX - startX + 1));
 
-            primitives.saoCuStatsE3(diff + startX + startY * MAX_CU_SIZE, rec0  + startX + startY * stride, stride, upBuff1 + 1, endX - startX, endY - startY, m_offsetOrg[plane][SAO_EO_3], m_count[plane][SAO_EO_3]);
+                primitives.saoCuStatsE3(diff + startX + startY * MAX_CU_SIZE, rec0  + startX + startY * stride, stride, upBuff1 + 1, endX - startX, endY - startY, m_offsetOrg[plane][SAO_EO_3], m_count[plane][SAO_EO_3]);
+            }
         }
     }
+
+    if (bStatsAll)
+        primitives.saoCuStatsAll(diff, rec0, stride, bounds[0], m_offsetOrg[plane][0], m_count[plane][0]);
 }
 
 void SAO::calcSaoStatsCu_BeforeDblk(Frame* frame, int idxX, int idxY)
@@ -915,6 +989,7 @@ void SAO::calcSaoStatsCu_BeforeDblk(Frame* frame, int idxX, int idxY)
     uint32_t bpely = x265_min(tpely + ctuHeight, picHeight);
     ctuWidth  = rpelx - lpelx;
     ctuHeight = bpely - tpely;
+    bool bAboveUnavail = !tpely || cu->m_bFirstRowInSlice;
 
     int startX;
     int startY;
@@ -1028,10 +1103,10 @@ void SAO::calcSaoStatsCu_BeforeDblk(Frame* frame, int idxX, int idxY)
 
             startX = (rpelx == picWidth) ? ctuWidth : ctuWidth - skipR;
             startY = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight - skipB;
-            firstY = !tpely;
+            firstY = bAboveUnavail;
             // endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight;
             endY   = ctuHeight - 1; // not refer below CTU
-            if (!tpely)
+            if (bAboveUnavail)
             {
                 fenc += stride;
                 rec += stride;
@@ -1074,12 +1149,12 @@ void SAO::calcSaoStatsCu_BeforeDblk(Frame* frame, int idxX, int idxY)
             startX = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth - skipR;
             startY = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight - skipB;
             firstX = !lpelx;
-            firstY = !tpely;
+            firstY = bAboveUnavail;
             // endX   = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth;
             // endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight;
             endX   = ctuWidth - 1;  // not refer right CTU
             endY   = ctuHeight - 1; // not refer below CTU
-            if (!tpely)
+            if (bAboveUnavail)
             {
                 fenc += stride;
                 rec += stride;
@@ -1126,12 +1201,12 @@ void SAO::calcSaoStatsCu_BeforeDblk(Frame* frame, int idxX, int idxY)
             startX = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth - skipR;
             startY = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight - skipB;
             firstX = !lpelx;
-            firstY = !tpely;
+            firstY = bAboveUnavail;
             // endX   = (rpelx == picWidth) ? ctuWidth - 1 : ctuWidth;
             // endY   = (bpely == picHeight) ? ctuHeight - 1 : ctuHeight;
             endX   = ctuWidth - 1;  // not refer right CTU
             endY   = ctuHeight - 1; // not refer below CTU
-            if (!tpely)
+            if (bAboveUnavail)
             {
                 fenc += stride;
                 rec += stride;
@@ -1186,7 +1261,7 @@ void SAO::rdoSaoUnitRowEnd(const SAOParam* saoParam, int numctus)
         m_depthSaoRate[1 * SAO_DEPTHRATE_SIZE + m_refDepth] = m_numNoSao[1] / ((double)numctus);
 }
 
-void SAO::rdoSaoUnitCu(SAOParam* saoParam, int rowBaseAddr, int idxX, int addr)
+void SAO::rdoSaoUnitCu(SAOParam* saoParam, int addr)
 {
     Slice* slice = m_frame->m_encData->m_slice;
 //    int qp = slice->m_sliceQp;
@@ -1204,9 +1279,10 @@ void SAO::rdoSaoUnitCu(SAOParam* saoParam, int rowBaseAddr, int idxX, int addr)
     lambda[0] = (int64_t)floor(256.0 * x265_lambda2_tab[qp]);
     lambda[1] = (int64_t)floor(256.0 * x265_lambda2_tab[qpCb]); // Use Cb QP for SAO chroma
 
-    const bool allowMerge[2] = {(idxX != 0), (rowBaseAddr != 0)}; // left, up
+    /* merge candidates must be in the same slice and tile */
+    const bool allowMerge[2] = {!cu->m_bFirstColInTile, (!cu->m_bFirstRowInTile && !cu->m_bFirstRowInSlice)}; // left, up
 
-    const int addrMerge[2] = {(idxX ? addr - 1 : -1), (rowBaseAddr ? addr - m_numCuInWidth : -1)};// left, up
+    const int addrMerge[2] = {(allowMerge[0] ? addr - 1 : -1), (allowMerge[1] ? addr - m_numCuInWidth : -1)};// left, up
 
     bool chroma = m_param->internalCsp != X265_CSP_I400 && m_frame->m_fencPic->m_picCsp != X265_CSP_I400;
     int planes = chroma ? 3 : 1;
@@ -1844,6 +1920,45 @@ void saoCuStatsE3_c(const int16_t *diff, const pixel *rec, intptr_t stride, int8
     }
 }
 
+void saoCuStatsAll_c(const int16_t *diff, const pixel *rec, intptr_t stride, const int *bounds, int32_t *stats, int32_t *count)
+{
+    const int boShift = X265_DEPTH - SAO_BO_BITS;
+
+    /* the two neighbors compared by each EO type */
+    const intptr_t neighbor[SAO_BO][2] =
+    {
+        { -1, 1 },
+        { -stride, stride },
+        { -stride - 1, stride + 1 },
+        { -stride + 1, stride - 1 }
+    };
+
+    for (int type = 0; type < MAX_NUM_SAO_TYPE; type++)
+    {
+        const int* block = bounds + 4 * type;
+        int32_t* typeStats = stats + type * SAO::MAX_NUM_SAO_CLASS;
+        int32_t* typeCount = count + type * SAO::MAX_NUM_SAO_CLASS;
+
+        for (int y = block[1]; y < block[3]; y++)
+        {
+            const pixel* recY = rec + y * stride;
+            const int16_t* diffY = diff + y * MAX_CU_SIZE;
+
+            for (int x = block[0]; x < block[2]; x++)
+            {
+                int classIdx;
+                if (type == SAO_BO)
+                    classIdx = recY[x] >> boShift;
+                else
+                    classIdx = SAO::s_eoTable[signOf(recY[x] - recY[x + neighbor[type][0]]) + signOf(recY[x] - recY[x + neighbor[type][1]]) + 2];
+
+                typeStats[classIdx] += diffY[x];
+                typeCount[classIdx]++;
+            }
+        }
+    }
+}
+
 void setupSaoPrimitives_c(EncoderPrimitives &p)
 {
     // TODO: move other sao functions to here
@@ -1852,6 +1967,7 @@ void setupSaoPrimitives_c(EncoderPrimitives &p)
     p.saoCuStatsE1 = saoCuStatsE1_c;
     p.saoCuStatsE2 = saoCuStatsE2_c;
     p.saoCuStatsE3 = saoCuStatsE3_c;
+    p.saoCuStatsAll = saoCuStatsAll_c;
 }
 }
 
@@ -55,6 +55,7 @@ public:
     enum { NUM_EDGETYPE = 5 };
     enum { NUM_PLANE = 3 };
     enum { SAO_DEPTHRATE_SIZE = 4 };
+    enum { SAO_DEFERRED_LINES = 4 }; /* bottom luma lines of a CTU filtered after the CTU row below is deblocked */
 
     static const uint32_t s_eoTable[NUM_EDGETYPE];
 
@@ -73,8 +74,9 @@ protected:
     PerPlane*   m_offsetOrgPreDblk;
 
     double*     m_depthSaoRate;
-    int8_t      m_offsetBo[NUM_PLANE][MAX_NUM_SAO_CLASS];
-    int8_t      m_offsetEo[NUM_PLANE][NUM_EDGETYPE];
+    /* apply state carried along the CTU row, one set per SAO pass: [bDeferred] */
+    int8_t      m_offsetBo[2][NUM_PLANE][MAX_NUM_SAO_CLASS];
+    int8_t      m_offsetEo[2][NUM_PLANE][NUM_EDGETYPE];
 
     int         m_chromaFormat;
     int         m_numCuInWidth;
@@ -86,8 +88,9 @@ protected:
     pixel*      m_clipTableBase;
 
     pixel*      m_tmpU[3];
-    pixel*      m_tmpL1[3];
-    pixel*      m_tmpL2[3];
+    pixel*      m_tmpL1[2][3];
+    pixel*      m_tmpL2[2][3];
+    pixel*      m_tmpDeferredU[3]; /* unfiltered line above the deferred lines, for the CTU row */
 
 public:
 
@@ -118,10 +121,10 @@ public:
     void resetStats();
 
     // CTU-based SAO process without slice granularity
-    void applyPixelOffsets(int addr, int typeIdx, int plane);
+    void applyPixelOffsets(int addr, int typeIdx, int plane, int lineBegin, int lineEnd);
     void processSaoUnitRow(SaoCtuParam* ctuParam, int idxY, int plane);
-    void generateLumaOffsets(SaoCtuParam* ctuParam, int idxY, int idxX);
-    void generateChromaOffsets(SaoCtuParam* ctuParam[3], int idxY, int idxX);
+    void generateLumaOffsets(SaoCtuParam* ctuParam, int idxY, int idxX, bool bDeferred);
+    void generateChromaOffsets(SaoCtuParam* ctuParam[3], int idxY, int idxX, bool bDeferred);
 
     void calcSaoStatsCTU(int addr, int plane);
     void calcSaoStatsCu_BeforeDblk(Frame* pic, int idxX, int idxY);
@@ -131,7 +134,7 @@ public:
 
     void estIterOffset(int typeIdx, int64_t lambda, int32_t count, int32_t offsetOrg, int32_t& offset, int32_t& distClasses, int64_t& costClasses);
     void rdoSaoUnitRowEnd(const SAOParam* saoParam, int numctus);
-    void rdoSaoUnitCu(SAOParam* saoParam, int rowBaseAddr, int idxX, int addr);
+    void rdoSaoUnitCu(SAOParam* saoParam, int addr);
     int64_t calcSaoRdoCost(int64_t distortion, uint32_t bits, int64_t lambda);
 
     void saoStatsInitialOffset(int planes);
@@ -64,6 +64,7 @@ Search::Search()
     m_tsCoeff = NULL;
     m_tsResidual = NULL;
     m_tsRecon = NULL;
+    memset(&m_tuCoeffCache, 0, sizeof(m_tuCoeffCache));
     m_param = NULL;
     m_slice = NULL;
     m_frame = NULL;
@@ -80,6 +81,8 @@ bool Search::initSearch(const x265_param& param, ScalingList& scalingList)
     m_me.init(param.internalCsp);
 
     bool ok = m_quant.init(param.psyRdoq, scalingList, m_entropyCoder);
+    m_estBitsCache.maxStateDrift = param.bApproxRate ? 2 : 0;
+    m_entropyCoder.m_estBitsCache = &m_estBitsCache;
     if (m_param->noiseReductionIntra || m_param->noiseReductionInter || m_param->rc.vbvBufferSize)
         ok &= m_quant.allocNoiseReduction(param);
 
@@ -156,6 +159,18 @@ bool Search::initSearch(const x265_param& param, ScalingList& scalingList)
     CHECKED_MALLOC(m_tsResidual, int16_t, MAX_TS_SIZE * MAX_TS_SIZE);
     CHECKED_MALLOC(m_tsRecon,    pixel,   MAX_TS_SIZE * MAX_TS_SIZE);
 
+    /* the denoiser accumulates statistics of every transform it is given */
+    if (!m_param->noiseReductionInter)
+    {
+        CHECKED_MALLOC(m_tuCoeffCache.predBuf, pixel, TUCoeffCache::NUM_ENTRIES * MAX_TR_SIZE * MAX_TR_SIZE);
+        CHECKED_MALLOC(m_tuCoeffCache.coeffBuf, coeff_t, TUCoeffCache::NUM_ENTRIES * MAX_TR_SIZE * MAX_TR_SIZE);
+        for (int i = 0; i < TUCoeffCache::NUM_ENTRIES; i++)
+        {
+            m_tuCoeffCache.entry[i].pred = m_tuCoeffCache.predBuf + i * MAX_TR_SIZE * MAX_TR_SIZE;
+            m_tuCoeffCache.entry[i].coeff = m_tuCoeffCache.coeffBuf + i * MAX_TR_SIZE * MAX_TR_SIZE;
+        }
+    }
+
     return ok;
 
 fail:
@@ -185,6 +200,8 @@ Search::~Search()
     X265_FREE(m_tsCoeff);
     X265_FREE(m_tsResidual);
     X265_FREE(m_tsRecon);
+    X265_FREE(m_tuCoeffCache.predBuf);
+    X265_FREE(m_tuCoeffCache.coeffBuf);
 }
 
 int Search::setLambdaFromQP(const CUData& ctu, int qp, int lambdaQp)
@@ -867,7 +884,9 @@ void Search::codeIntraChromaQt(Mode& mode, const CUGeom& cuGeom, uint32_t tuDept
             cu.setTransformSkipPartRange(0, ttype, absPartIdxC, tuIterator.absPartIdxStep);
 
             primitives.cu[sizeIdxC].calcresidual(fenc, pred, residual, stride);
-            uint32_t numSig = m_quant.transformNxN(cu, fenc, stride, residual, stride, coeffC, log2TrSizeC, ttype, absPartIdxC, false);
+            uint32_t numSig = 0;
+            if (!skipChromaResidual(cu, residual, stride, log2TrSizeC, ttype, cu.getCbf(absPartIdx, TEXT_LUMA, tuDepth) || tuDepthC != tuDepth))
+                numSig = m_quant.transformNxN(cu, fenc, stride, residual, stride, coeffC, log2TrSizeC, ttype, absPartIdxC, false);
             if (numSig)
             {
                 m_quant.invtransformNxN(cu, residual, stride, coeffC, log2TrSizeC, ttype, true, false, numSig);
@@ -1150,7 +1169,9 @@ void Search::residualQTIntraChroma(Mode& mode, const CUGeom& cuGeom, uint32_t ab
             X265_CHECK(!cu.m_transformSkip[ttype][0], "transform skip not supported at low RD levels\n");
 
             primitives.cu[sizeIdxC].calcresidual(fenc, pred, residual, stride);
-            uint32_t numSig = m_quant.transformNxN(cu, fenc, stride, residual, stride, coeffC, log2TrSizeC, ttype, absPartIdxC, false);
+            uint32_t numSig = 0;
+            if (!skipChromaResidual(cu, residual, stride, log2TrSizeC, ttype, cu.getCbf(absPartIdx, TEXT_LUMA, tuDepth) || tuDepthC != tuDepth))
+                numSig = m_quant.transformNxN(cu, fenc, stride, residual, stride, coeffC, log2TrSizeC, ttype, absPartIdxC, false);
             if (numSig)
             {
                 m_quant.invtransformNxN(cu, residual, stride, coeffC, log2TrSizeC, ttype, true, false, numSig);
@@ -1294,9 +1315,15 @@ void Search::checkIntraInInter(Mode& intraMode, const CUGeom& cuGeom)
     uint32_t mpmModes[3];
     uint32_t rbits = getIntraRemModeBits(cu, absPartIdx, mpmModes, mpms);
 
+    /* unless the CU was downscaled, predictions are made into the intra
+     * cache for reuse by encodeIntraInInter */
+    bool bCache = !!intraPredCacheBlock(DC_IDX);
+#define PRED_BUF(mode) (bCache ? intraPredCacheBlock(mode) : m_intraPredAngs)
+
     // DC
-    primitives.cu[sizeIdx].intra_pred[DC_IDX](m_intraPredAngs, scaleStride, intraNeighbourBuf[0], 0, (scaleTuSize <= 16));
-    bsad = sa8d(fenc, scaleStride, m_intraPredAngs, scaleStride) << costShift;
+    pixel* pred = PRED_BUF(DC_IDX);
+    primitives.cu[sizeIdx].intra_pred[DC_IDX](pred, scaleTuSize, intraNeighbourBuf[0], 0, (scaleTuSize <= 16));
+    bsad = sa8d(fenc, scaleStride, pred, scaleTuSize) << costShift;
     bmode = mode = DC_IDX;
     bbits = (mpms & ((uint64_t)1 << mode)) ? m_entropyCoder.bitsIntraModeMPM(mpmModes, mode) : rbits;
     bcost = m_rdCost.calcRdSADCost(bsad, bbits);
@@ -1306,18 +1333,27 @@ void Search::checkIntraInInter(Mode& intraMode, const CUGeom& cuGeom)
     if (tuSize & (8 | 16 | 32))
         planar = intraNeighbourBuf[1];
 
-    primitives.cu[sizeIdx].intra_pred[PLANAR_IDX](m_intraPredAngs, scaleStride, planar, 0, 0);
-    sad = sa8d(fenc, scaleStride, m_intraPredAngs, scaleStride) << costShift;
+    pred = PRED_BUF(PLANAR_IDX);
+    primitives.cu[sizeIdx].intra_pred[PLANAR_IDX](pred, scaleTuSize, planar, 0, 0);
+    sad = sa8d(fenc, scaleStride, pred, scaleTuSize) << costShift;
     mode = PLANAR_IDX;
     bits = (mpms & ((uint64_t)1 << mode)) ? m_entropyCoder.bitsIntraModeMPM(mpmModes, mode) : rbits;
     cost = m_rdCost.calcRdSADCost(sad, bits);
     COPY4_IF_LT(bcost, cost, bmode, mode, bsad, sad, bbits, bits);
+    if (bCache)
+        setIntraPredCached((1 << DC_IDX) | (1 << PLANAR_IDX), false);
 
     bool allangs = true;
+    pixel* predAngs = PRED_BUF(2);
     if (primitives.cu[sizeIdx].intra_pred_allangs)
     {
         primitives.cu[sizeIdx].transpose(m_fencTransposed, fenc, scaleStride);
-        primitives.cu[sizeIdx].intra_pred_allangs(m_intraPredAngs, intraNeighbourBuf[0], intraNeighbourBuf[1], (scaleTuSize <= 16)); 
+        primitives.cu[sizeIdx].intra_pred_allangs(predAngs, intraNeighbourBuf[0], intraNeighbourBuf[1], (scaleTuSize <= 16)); 
+        if (bCache)
+        {
+            setIntraPredCached(((uint64_t)1 << 18) - (1 << 2), true);
+            setIntraPredCached(((uint64_t)1 << 35) - (1 << 18), false);
+        }
     }
     else
         allangs = false;
@@ -1325,15 +1361,18 @@ void Search::checkIntraInInter(Mode& intraMode, const CUGeom& cuGeom)
 #define TRY_ANGLE(angle) \
     if (allangs) { \
         if (angle < 18) \
-            sad = sa8d(m_fencTransposed, scaleTuSize, &m_intraPredAngs[(angle - 2) * predsize], scaleTuSize) << costShift; \
+            sad = sa8d(m_fencTransposed, scaleTuSize, &predAngs[(angle - 2) * predsize], scaleTuSize) << costShift; \
         else \
-            sad = sa8d(fenc, scaleStride, &m_intraPredAngs[(angle - 2) * predsize], scaleTuSize) << costShift; \
+            sad = sa8d(fenc, scaleStride, &predAngs[(angle - 2) * predsize], scaleTuSize) << costShift; \
         bits = (mpms & ((uint64_t)1 << angle)) ? m_entropyCoder.bitsIntraModeMPM(mpmModes, angle) : rbits; \
         cost = m_rdCost.calcRdSADCost(sad, bits); \
     } else { \
         int filter = !!(g_intraFilterFlags[angle] & scaleTuSize); \
-        primitives.cu[sizeIdx].intra_pred[angle](m_intraPredAngs, scaleTuSize, intraNeighbourBuf[filter], angle, scaleTuSize <= 16); \
-        sad = sa8d(fenc, scaleStride, m_intraPredAngs, scaleTuSize) << costShift; \
+        pred = PRED_BUF(angle); \
+        primitives.cu[sizeIdx].intra_pred[angle](pred, scaleTuSize, intraNeighbourBuf[filter], angle, scaleTuSize <= 16); \
+        if (bCache) \
+            setIntraPredCached((uint64_t)1 << angle, false); \
+        sad = sa8d(fenc, scaleStride, pred, scaleTuSize) << costShift; \
         bits = (mpms & ((uint64_t)1 << angle)) ? m_entropyCoder.bitsIntraModeMPM(mpmModes, angle) : rbits; \
         cost = m_rdCost.calcRdSADCost(sad, bits); \
     }
@@ -1382,6 +1421,8 @@ void Search::checkIntraInInter(Mode& intraMode, const CUGeom& cuGeom)
             COPY4_IF_LT(bcost, cost, bmode, mode, bsad, sad, bbits, bits);
         }
     }
+#undef TRY_ANGLE
+#undef PRED_BUF
 
     cu.setLumaIntraDirSubParts((uint8_t)bmode, absPartIdx, depth + initTuDepth);
     intraMode.initCosts();
@@ -1507,10 +1548,14 @@ sse_t Search::estIntraPredQT(Mode &intraMode, const CUGeom& cuGeom, const uint32
                 pixelcmp_t sa8d = primitives.cu[sizeIdx].sa8d;
                 uint64_t modeCosts[35];
 
+                /* predictions are made into the intra cache, for reuse by the RD stage */
+                X265_CHECK(intraPredCacheBlock(DC_IDX), "intra TU not cacheable\n");
+
                 // DC
-                primitives.cu[sizeIdx].intra_pred[DC_IDX](m_intraPred, scaleStride, intraNeighbourBuf[0], 0, (scaleTuSize <= 16));
+                pixel* pred = intraPredCacheBlock(DC_IDX);
+                primitives.cu[sizeIdx].intra_pred[DC_IDX](pred, scaleTuSize, intraNeighbourBuf[0], 0, (scaleTuSize <= 16));
                 uint32_t bits = (mpms & ((uint64_t)1 << DC_IDX)) ? m_entropyCoder.bitsIntraModeMPM(mpmModes, DC_IDX) : rbits;
-                uint32_t sad = sa8d(fenc, scaleStride, m_intraPred, scaleStride) << costShift;
+                uint32_t sad = sa8d(fenc, scaleStride, pred, scaleTuSize) << costShift;
                 modeCosts[DC_IDX] = bcost = m_rdCost.calcRdSADCost(sad, bits);
 
                 // PLANAR
@@ -1518,27 +1563,33 @@ sse_t Search::estIntraPredQT(Mode &intraMode, const CUGeom& cuGeom, const uint32
                 if (tuSize >= 8 && tuSize <= 32)
                     planar = intraNeighbourBuf[1];
 
-                primitives.cu[sizeIdx].intra_pred[PLANAR_IDX](m_intraPred, scaleStride, planar, 0, 0);
+                pred = intraPredCacheBlock(PLANAR_IDX);
+                primitives.cu[sizeIdx].intra_pred[PLANAR_IDX](pred, scaleTuSize, planar, 0, 0);
                 bits = (mpms & ((uint64_t)1 << PLANAR_IDX)) ? m_entropyCoder.bitsIntraModeMPM(mpmModes, PLANAR_IDX) : rbits;
-                sad = sa8d(fenc, scaleStride, m_intraPred, scaleStride) << costShift;
+                sad = sa8d(fenc, scaleStride, pred, scaleTuSize) << costShift;
                 modeCosts[PLANAR_IDX] = m_rdCost.calcRdSADCost(sad, bits);
                 COPY1_IF_LT(bcost, modeCosts[PLANAR_IDX]);
+                setIntraPredCached((1 << DC_IDX) | (1 << PLANAR_IDX), false);
 
                 // angular predictions
                 if (primitives.cu[sizeIdx].intra_pred_allangs)
                 {
+                    /* the cache blocks of modes 2..34 are consecutive, as allangs writes them */
+                    pixel* predAngs = intraPredCacheBlock(2);
                     primitives.cu[sizeIdx].transpose(m_fencTransposed, fenc, scaleStride);
-                    primitives.cu[sizeIdx].intra_pred_allangs(m_intraPredAngs, intraNeighbourBuf[0], intraNeighbourBuf[1], (scaleTuSize <= 16));
+                    primitives.cu[sizeIdx].intra_pred_allangs(predAngs, intraNeighbourBuf[0], intraNeighbourBuf[1], (scaleTuSize <= 16));
                     for (int mode = 2; mode < 35; mode++)
                     {
                         bits = (mpms & ((uint64_t)1 << mode)) ? m_entropyCoder.bitsIntraModeMPM(mpmModes, mode) : rbits;
                         if (mode < 18)
-                            sad = sa8d(m_fencTransposed, scaleTuSize, &m_intraPredAngs[(mode - 2) * (scaleTuSize * scaleTuSize)], scaleTuSize) << costShift;
+                            sad = sa8d(m_fencTransposed, scaleTuSize, &predAngs[(mode - 2) * (scaleTuSize * scaleTuSize)], scaleTuSize) << costShift;
                         else
-                            sad = sa8d(fenc, scaleStride, &m_intraPredAngs[(mode - 2) * (scaleTuSize * scaleTuSize)], scaleTuSize) << costShift;
+                            sad = sa8d(fenc, scaleStride, &predAngs[(mode - 2) * (scaleTuSize * scaleTuSize)], scaleTuSize) << costShift;
                         modeCosts[mode] = m_rdCost.calcRdSADCost(sad, bits);
                         COPY1_IF_LT(bcost, modeCosts[mode]);
                     }
+                    setIntraPredCached(((uint64_t)1 << 18) - (1 << 2), true);
+                    setIntraPredCached(((uint64_t)1 << 35) - (1 << 18), false);
                 }
                 else
                 {
@@ -1546,23 +1597,34 @@ sse_t Search::estIntraPredQT(Mode &intraMode, const CUGeom& cuGeom, const uint32
                     {
                         bits = (mpms & ((uint64_t)1 << mode)) ? m_entropyCoder.bitsIntraModeMPM(mpmModes, mode) : rbits;
                         int filter = !!(g_intraFilterFlags[mode] & scaleTuSize);
-                        primitives.cu[sizeIdx].intra_pred[mode](m_intraPred, scaleTuSize, intraNeighbourBuf[filter], mode, scaleTuSize <= 16);
-                        sad = sa8d(fenc, scaleStride, m_intraPred, scaleTuSize) << costShift;
+                        pred = intraPredCacheBlock(mode);
+                        primitives.cu[sizeIdx].intra_pred[mode](pred, scaleTuSize, intraNeighbourBuf[filter], mode, scaleTuSize <= 16);
+                        sad = sa8d(fenc, scaleStride, pred, scaleTuSize) << costShift;
                         modeCosts[mode] = m_rdCost.calcRdSADCost(sad, bits);
                         COPY1_IF_LT(bcost, modeCosts[mode]);
                     }
+                    setIntraPredCached(((uint64_t)1 << 35) - (1 << 2), false);
                 }
 
                 /* Find the top maxCandCount candidate modes with cost within 25% of best
                 * or among the most probable modes. maxCandCount is derived from the
                 * rdLevel and depth. In general we want to try more modes at slower RD
                 * levels and at higher depths */
+                uint32_t hintMode = getHintedIntraDir(cu, absPartIdx, tuSize);
+                if (hintMode != (uint32_t)ALL_IDX)
+                    /* the mode hinted by another encode of the picture is always
+                     * measured, so fewer other candidates are needed */
+                    maxCandCount = X265_MAX(maxCandCount >> 1, 2);
+
                 for (int i = 0; i < maxCandCount; i++)
                     candCostList[i] = MAX_INT64;
 
+                if (hintMode != (uint32_t)ALL_IDX)
+                    updateCandList(hintMode, 0, maxCandCount, rdModeList, candCostList);
+
                 uint64_t paddedBcost = bcost + (bcost >> 2); // 1.25%
                 for (int mode = 0; mode < 35; mode++)
-                    if ((modeCosts[mode] < paddedBcost) || ((uint32_t)mode == mpmModes[0])) 
+                    if (((modeCosts[mode] < paddedBcost) || ((uint32_t)mode == mpmModes[0])) && (uint32_t)mode != hintMode)
                         /* choose for R-D analysis only if this mode passes cost threshold or matches MPM[0] */
                         updateCandList(mode, modeCosts[mode], maxCandCount, rdModeList, candCostList);
             }
@@ -1910,6 +1972,102 @@ MV Search::getLowresMV(const CUData& cu, const PredictionUnit& pu, int list, int
     return mvs[idx] << 1; /* scale up lowres mv */
 }
 
+/* MV chosen for the PU centre by another encode of the picture, if that
+ * encode used the same reference */
+MV Search::getHintedMV(const CUData& cu, const PredictionUnit& pu, int list, int ref)
+{
+    const AnalysisHints& hints = m_frame->m_analysisHints;
+    if (!hints.bValid)
+        return 0;
+
+    uint32_t x = X265_MIN((uint32_t)(g_zscanToPelX[cu.m_absIdxInCTU + pu.puAbsPartIdx] + pu.width / 2), g_maxCUSize - 1);
+    uint32_t y = X265_MIN((uint32_t)(g_zscanToPelY[cu.m_absIdxInCTU + pu.puAbsPartIdx] + pu.height / 2), g_maxCUSize - 1);
+    uint32_t idx = cu.m_cuAddr * hints.numPartitions + g_rasterToZscan[(y >> LOG2_UNIT_SIZE) * CUData::s_numPartInCUSize + (x >> LOG2_UNIT_SIZE)];
+
+    if (hints.refIdx[list][idx] != ref)
+        return 0;
+
+    return hints.mv[list][idx];
+}
+
+/* exact repeats of the PU source anywhere within the legal MV range in the
+ * source of the reference, found through the reference's block hash table.
+ * Returns the match with the cheapest MV as a QPEL MV in outmv, with its
+ * motion search cost (SATD against the reconstructed reference plus MV cost)
+ * in outCost, or false if there is no match */
+bool Search::hashMotionSearch(const CUData& cu, const PredictionUnit& pu, int list, int ref, const MV& mvp, MV& outmv, int& outCost)
+{
+    enum { MAX_MATCHES = 32, MAX_RANGE = 4095 };
+
+    const Frame* refFrame = m_slice->m_refFrameList[list][ref];
+    const BlockHash* hash = refFrame->m_encData->m_blockHash;
+    if (!hash || !hash->isValid() || pu.width < BlockHash::BLOCK_SIZE || pu.height < BlockHash::BLOCK_SIZE)
+        return false;
+
+    const PicYuv& fencPic = *m_frame->m_fencPic;
+    const PicYuv& refPic = *refFrame->m_fencPic;
+    intptr_t stride = fencPic.m_stride;
+    int x = cu.m_cuPelX + g_zscanToPelX[pu.puAbsPartIdx];
+    int y = cu.m_cuPelY + g_zscanToPelY[pu.puAbsPartIdx];
+    const pixel* fenc = fencPic.m_picOrg[0] + y * stride + x;
+
+    uint16_t pos[MAX_MATCHES][2];
+    int numPos = hash->lookup(fenc, stride, pos, MAX_MATCHES);
+    if (!numPos)
+        return false;
+
+    MV mvmin, mvmax;
+    setSearchRange(cu, MV(0, 0), MAX_RANGE, mvmin, mvmax);
+    m_me.setMVP(mvp);
+
+    MV bestmv;
+    uint32_t bestCost = MAX_UINT;
+    for (int i = 0; i < numPos; i++)
+    {
+        MV mv((int16_t)(pos[i][0] - x), (int16_t)(pos[i][1] - y));
+        if (!mv.checkRange(mvmin, mvmax) ||
+            pos[i][0] + pu.width > (int)refPic.m_picWidth || pos[i][1] + pu.height > (int)refPic.m_picHeight)
+            continue;
+
+        /* the hash only covers the top-left 8x8 block, verify the whole PU */
+        const pixel* fref = refPic.m_picOrg[0] + pos[i][1] * stride + pos[i][0];
+        if (primitives.pu[m_me.partEnum].sad(fenc, stride, fref, stride))
+            continue;
+
+        uint32_t cost = m_me.mvcost(mv << 2);
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            bestmv = mv;
+        }
+    }
+
+    if (bestCost == MAX_UINT)
+        return false;
+
+    outmv = bestmv << 2;
+    outCost = m_me.subpelCompare(&m_slice->m_mref[list][ref], outmv, primitives.pu[m_me.partEnum].satd) + bestCost;
+    return true;
+}
+
+/* luma intra mode chosen by another encode of the picture at the centre of
+ * the TU, or ALL_IDX if that encode did not code it intra */
+uint32_t Search::getHintedIntraDir(const CUData& cu, uint32_t absPartIdx, uint32_t tuSize)
+{
+    const AnalysisHints& hints = m_frame->m_analysisHints;
+    if (!hints.bValid)
+        return (uint32_t)ALL_IDX;
+
+    uint32_t x = g_zscanToPelX[cu.m_absIdxInCTU + absPartIdx] + tuSize / 2;
+    uint32_t y = g_zscanToPelY[cu.m_absIdxInCTU + absPartIdx] + tuSize / 2;
+    uint32_t idx = cu.m_cuAddr * hints.numPartitions + g_rasterToZscan[(y >> LOG2_UNIT_SIZE) * CUData::s_numPartInCUSize + (x >> LOG2_UNIT_SIZE)];
+
+    if (hints.predMode[idx] != MODE_INTRA || hints.lumaIntraDir[idx] == (uint8_t)ALL_IDX)
+        return (uint32_t)ALL_IDX;
+
+    return hints.lumaIntraDir[idx];
+}
+
 /* Pick between the two AMVP candidates which is the best one to use as
  * MVP for the motion search, based on SAD cost */
 int Search::selectMVP(const CUData& cu, const PredictionUnit& pu, const MV amvp[AMVP_NUM_CANDS], int list, int ref)
@@ -2006,8 +2164,8 @@ void Search::singleMotionEstimation(Search& master, Mode& interMode, const Predi
 
     MotionData* bestME = interMode.bestME[part];
 
-    // 12 mv candidates including lowresMV
-    MV  mvc[(MD_ABOVE_LEFT + 1) * 2 + 2];
+    // 13 mv candidates including lowresMV and hinted MV
+    MV  mvc[(MD_ABOVE_LEFT + 1) * 2 + 3];
     int numMvc = interMode.cu.getPMV(interMode.interNeighbours, list, ref, interMode.amvpCand[list][ref], mvc);
 
     const MV* amvp = interMode.amvpCand[list][ref];
@@ -2021,9 +2179,15 @@ void Search::singleMotionEstimation(Search& master, Mode& interMode, const Predi
             mvc[numMvc++] = lmv;
     }
 
+    MV hmv = getHintedMV(interMode.cu, pu, list, ref);
+    if (hmv.notZero())
+        mvc[numMvc++] = hmv;
+
     setSearchRange(interMode.cu, mvp, m_param->searchRange, mvmin, mvmax);
 
-    int satdCost = m_me.motionEstimate(&m_slice->m_mref[list][ref], mvmin, mvmax, mvp, numMvc, mvc, m_param->searchRange, outmv);
+    int satdCost;
+    if (!m_param->bHashME || !hashMotionSearch(interMode.cu, pu, list, ref, mvp, outmv, satdCost))
+        satdCost = m_me.motionEstimate(&m_slice->m_mref[list][ref], mvmin, mvmax, mvp, numMvc, mvc, m_param->searchRange, outmv);
 
     /* Get total cost of partition, but only include MV bit cost once */
     bits += m_me.bitcost(outmv);
@@ -2056,8 +2220,8 @@ void Search::predInterSearch(Mode& interMode, const CUGeom& cuGeom, bool bChroma
     CUData& cu = interMode.cu;
     Yuv* predYuv = &interMode.predYuv;
 
-    // 12 mv candidates including lowresMV
-    MV mvc[(MD_ABOVE_LEFT + 1) * 2 + 2];
+    // 14 mv candidates including lowresMV, hinted MV and shared reference MV
+    MV mvc[(MD_ABOVE_LEFT + 1) * 2 + 4];
 
     const Slice *slice = m_slice;
     int numPart     = cu.getNumPartInter(0);
@@ -2205,8 +2369,39 @@ void Search::predInterSearch(Mode& interMode, const CUGeom& cuGeom, bool bChroma
                             mvc[numMvc++] = lmv;
                     }
 
+                    MV hmv = getHintedMV(cu, pu, list, ref);
+                    if (hmv.notZero())
+                        mvc[numMvc++] = hmv;
+
                     setSearchRange(cu, mvp, m_param->searchRange, mvmin, mvmax);
-                    int satdCost = m_me.motionEstimate(&slice->m_mref[list][ref], mvmin, mvmax, mvp, numMvc, mvc, m_param->searchRange, outmv);
+
+                    if (m_param->bEnableRefMVShare)
+                    {
+                        /* scale the best MV found so far (this list first, else the other
+                         * list) to the POC distance of this reference. It seeds the search
+                         * and lets us skip references which are clearly worse */
+                        int seedList = bestME[list].cost != MAX_UINT ? list : !list;
+                        const MotionData& seed = bestME[seedList];
+                        if (seed.cost != MAX_UINT)
+                        {
+                            MV smv = cu.scaleMvByPOCDist(seed.mv, slice->m_poc, slice->m_refPOCList[list][ref],
+                                                         slice->m_poc, slice->m_refPOCList[seedList][seed.ref]);
+                            smv = smv.clipped(mvmin.toQPel(), mvmax.toQPel());
+
+                            uint32_t predCost = m_me.subpelCompare(&slice->m_mref[list][ref], smv, primitives.pu[m_me.partEnum].satd) +
+                                                m_rdCost.getCost(bits + m_me.bitcost(smv, mvp));
+                            if (predCost > 2 * (uint64_t)seed.cost)
+                            {
+                                ProfileCounter(interMode.cu, skippedMotionReferences[cuGeom.depth]);
+                                continue;
+                            }
+                            mvc[numMvc++] = smv;
+                        }
+                    }
+                    /* an exact repeat of the PU makes the regular search unnecessary */
+                    int satdCost;
+                    if (!m_param->bHashME || !hashMotionSearch(cu, pu, list, ref, mvp, outmv, satdCost))
+                        satdCost = m_me.motionEstimate(&slice->m_mref[list][ref], mvmin, mvmax, mvp, numMvc, mvc, m_param->searchRange, outmv);
 
                     /* Get total cost of partition, but only include MV bit cost once */
                     bits += m_me.bitcost(outmv);
@@ -2764,7 +2959,9 @@ void Search::residualTransformQuantInter(Mode& mode, const CUGeom& cuGeom, uint3
 
                 int16_t* curResiU = resiYuv.getCbAddr(absPartIdxC);
                 const pixel* fencCb = fencYuv->getCbAddr(absPartIdxC);
-                uint32_t numSigU = m_quant.transformNxN(cu, fencCb, fencYuv->m_csize, curResiU, strideResiC, coeffCurU + subTUOffset, log2TrSizeC, TEXT_CHROMA_U, absPartIdxC, false);
+                uint32_t numSigU = 0;
+                if (!skipChromaResidual(cu, curResiU, strideResiC, log2TrSizeC, TEXT_CHROMA_U, numSigY || tuDepthC != tuDepth))
+                    numSigU = m_quant.transformNxN(cu, fencCb, fencYuv->m_csize, curResiU, strideResiC, coeffCurU + subTUOffset, log2TrSizeC, TEXT_CHROMA_U, absPartIdxC, false);
                 if (numSigU)
                 {
                     m_quant.invtransformNxN(cu, curResiU, strideResiC, coeffCurU + subTUOffset, log2TrSizeC, TEXT_CHROMA_U, false, false, numSigU);
@@ -2778,7 +2975,9 @@ void Search::residualTransformQuantInter(Mode& mode, const CUGeom& cuGeom, uint3
 
                 int16_t* curResiV = resiYuv.getCrAddr(absPartIdxC);
                 const pixel* fencCr = fencYuv->getCrAddr(absPartIdxC);
-                uint32_t numSigV = m_quant.transformNxN(cu, fencCr, fencYuv->m_csize, curResiV, strideResiC, coeffCurV + subTUOffset, log2TrSizeC, TEXT_CHROMA_V, absPartIdxC, false);
+                uint32_t numSigV = 0;
+                if (!skipChromaResidual(cu, curResiV, strideResiC, log2TrSizeC, TEXT_CHROMA_V, numSigY || tuDepthC != tuDepth))
+                    numSigV = m_quant.transformNxN(cu, fencCr, fencYuv->m_csize, curResiV, strideResiC, coeffCurV + subTUOffset, log2TrSizeC, TEXT_CHROMA_V, absPartIdxC, false);
                 if (numSigV)
                 {
                     m_quant.invtransformNxN(cu, curResiV, strideResiC, coeffCurV + subTUOffset, log2TrSizeC, TEXT_CHROMA_V, false, false, numSigV);
@@ -2834,6 +3033,79 @@ uint64_t Search::estimateNullCbfCost(sse_t dist, uint32_t psyEnergy, uint32_t tu
         return m_rdCost.calcRdCost(dist, nullBits);
 }
 
+/* predict that a chroma residual would not be coded, so its transform and
+ * quant can be skipped. Certain when its energy is below that of half a
+ * quantizer step; when the co-located luma residual is not coded either,
+ * chroma residuals of up to a full quantizer step are assumed uncoded too */
+bool Search::skipChromaResidual(const CUData& cu, const int16_t* resi, intptr_t stride, uint32_t log2TrSizeC, TextType ttype, bool bLumaCbf)
+{
+    if (!m_param->bEarlyChromaSkip || cu.m_tqBypass[0])
+        return false;
+
+    sse_t limit = m_quant.zeroResidualSse(ttype);
+    if (!bLumaCbf)
+        limit *= 4;
+
+    return primitives.cu[log2TrSizeC - 2].ssd_s(resi, stride) < limit;
+}
+
+/* transformNxN() of the residual of an inter TU, re-using the coefficients of
+ * an earlier transform of the same TU when its prediction was identical */
+uint32_t Search::transformInterTU(const CUData& cu, const pixel* fenc, uint32_t fencStride, const pixel* pred, uint32_t predStride, const int16_t* resi,
+                                  uint32_t resiStride, coeff_t* coeff, uint32_t log2TrSize, TextType ttype, uint32_t absPartIdx)
+{
+    TUCoeffCache& cache = m_tuCoeffCache;
+    if (!cache.predBuf || cu.m_tqBypass[0])
+        return m_quant.transformNxN(cu, fenc, fencStride, resi, resiStride, coeff, log2TrSize, ttype, absPartIdx, false);
+
+    uint32_t trSize = 1 << log2TrSize;
+    uint32_t numCoeff = 1 << (log2TrSize * 2);
+    uint32_t ctuPartIdx = cu.m_absIdxInCTU + absPartIdx;
+    int qp = m_quant.qp(ttype);
+
+    /* RDOQ rates come from the contexts the rate tables were estimated from,
+     * for chroma V these precede the coding of chroma U */
+    const uint8_t* ctx = m_estBitsCache.loaded ? m_estBitsCache.loaded->contextState : &m_entropyCoder.m_contextState[OFF_QT_CBF_CTX];
+
+    for (int i = 0; i < TUCoeffCache::NUM_ENTRIES; i++)
+    {
+        TUCoeffCache::Entry& e = cache.entry[i];
+        if (e.frame != m_frame || e.poc != m_slice->m_poc || e.cuAddr != cu.m_cuAddr || e.absPartIdx != ctuPartIdx ||
+            e.log2CUSize != cu.m_log2CUSize[0] || e.tuDepth != cu.m_tuDepth[absPartIdx] || e.log2TrSize != log2TrSize ||
+            e.ttype != (uint32_t)ttype || e.qp != qp)
+            continue;
+        if (m_param->rdoqLevel && memcmp(e.contextState, ctx, sizeof(e.contextState)))
+            continue;
+
+        uint32_t y = 0;
+        while (y < trSize && !memcmp(e.pred + y * trSize, pred + y * predStride, trSize * sizeof(pixel)))
+            y++;
+        if (y < trSize)
+            continue;
+
+        memcpy(coeff, e.coeff, numCoeff * sizeof(coeff_t));
+        return e.numSig;
+    }
+
+    TUCoeffCache::Entry& e = cache.entry[cache.next];
+    cache.next = (cache.next + 1) % TUCoeffCache::NUM_ENTRIES;
+
+    e.numSig = m_quant.transformNxN(cu, fenc, fencStride, resi, resiStride, coeff, log2TrSize, ttype, absPartIdx, false);
+    e.frame = m_frame;
+    e.poc = m_slice->m_poc;
+    e.cuAddr = cu.m_cuAddr;
+    e.absPartIdx = ctuPartIdx;
+    e.log2CUSize = cu.m_log2CUSize[0];
+    e.tuDepth = cu.m_tuDepth[absPartIdx];
+    e.log2TrSize = log2TrSize;
+    e.ttype = ttype;
+    e.qp = qp;
+    memcpy(e.contextState, ctx, sizeof(e.contextState));
+    primitives.cu[log2TrSize - 2].copy_pp(e.pred, trSize, pred, predStride);
+    memcpy(e.coeff, coeff, numCoeff * sizeof(coeff_t));
+    return e.numSig;
+}
+
 void Search::estimateResidualQT(Mode& mode, const CUGeom& cuGeom, uint32_t absPartIdx, uint32_t tuDepth, ShortYuv& resiYuv, Cost& outCosts, const uint32_t depthRange[2])
 {
     CUData& cu = mode.cu;
@@ -2902,7 +3174,7 @@ void Search::estimateResidualQT(Mode& mode, const CUGeom& cuGeom, uint32_t absPa
 
         const pixel* fenc = fencYuv->getLumaAddr(absPartIdx);
         int16_t* resi = resiYuv.getLumaAddr(absPartIdx);
-        numSig[TEXT_LUMA][0] = m_quant.transformNxN(cu, fenc, fencYuv->m_size, resi, resiYuv.m_size, coeffCurY, log2TrSize, TEXT_LUMA, absPartIdx, false);
+        numSig[TEXT_LUMA][0] = transformInterTU(cu, fenc, fencYuv->m_size, mode.predYuv.getLumaAddr(absPartIdx), mode.predYuv.m_size, resi, resiYuv.m_size, coeffCurY, log2TrSize, TEXT_LUMA, absPartIdx);
         cbfFlag[TEXT_LUMA][0] = !!numSig[TEXT_LUMA][0];
 
         m_entropyCoder.resetBits();
@@ -3016,7 +3288,11 @@ void Search::estimateResidualQT(Mode& mode, const CUGeom& cuGeom, uint32_t absPa
 
                     fenc = fencYuv->getChromaAddr(chromaId, absPartIdxC);
                     resi = resiYuv.getChromaAddr(chromaId, absPartIdxC);
-                    numSig[chromaId][tuIterator.section] = m_quant.transformNxN(cu, fenc, fencYuv->m_csize, resi, resiYuv.m_csize, coeffCurC + subTUOffset, log2TrSizeC, (TextType)chromaId, absPartIdxC, false);
+                    if (skipChromaResidual(cu, resi, resiYuv.m_csize, log2TrSizeC, (TextType)chromaId, cbfFlag[TEXT_LUMA][0] || tuDepthC != tuDepth))
+                        numSig[chromaId][tuIterator.section] = 0;
+                    else
+                        numSig[chromaId][tuIterator.section] = transformInterTU(cu, fenc, fencYuv->m_csize, mode.predYuv.getChromaAddr(chromaId, absPartIdxC), mode.predYuv.m_csize,
+                                                                                resi, resiYuv.m_csize, coeffCurC + subTUOffset, log2TrSizeC, (TextType)chromaId, absPartIdxC);
                     cbfFlag[chromaId][tuIterator.section] = !!numSig[chromaId][tuIterator.section];
 
                     uint32_t latestBitCount = m_entropyCoder.getNumberOfWrittenBits();
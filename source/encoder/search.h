@@ -95,6 +95,39 @@ struct MotionData
     }
 };
 
+/* Quantized coefficients of the most recently coded inter TUs. Merge
+ * candidates sharing a motion field, and motion searches which find a merge
+ * candidate, produce identical predictions of a CU, and so identical
+ * residuals whose transform and quant are re-used. An entry is matched by
+ * comparing the TU position and geometry, the QP, the residual coding
+ * contexts RDOQ rates were estimated from, and the prediction itself */
+struct TUCoeffCache
+{
+    enum { NUM_ENTRIES = 8 };
+
+    struct Entry
+    {
+        const Frame* frame;
+        int          poc;
+        uint32_t     cuAddr;
+        uint32_t     absPartIdx;  // within the CTU
+        uint32_t     log2CUSize;
+        uint32_t     tuDepth;
+        uint32_t     log2TrSize;
+        uint32_t     ttype;
+        int          qp;
+        uint32_t     numSig;
+        uint8_t      contextState[EstBitsSbacCache::CTX_END - EstBitsSbacCache::CTX_BEGIN];
+        pixel*       pred;        // MAX_TR_SIZE * MAX_TR_SIZE
+        coeff_t*     coeff;       // MAX_TR_SIZE * MAX_TR_SIZE
+    };
+
+    Entry    entry[NUM_ENTRIES];
+    int      next;                // entry to replace on the next miss
+    pixel*   predBuf;
+    coeff_t* coeffBuf;
+};
+
 struct Mode
 {
     CUData     cu;
@@ -192,6 +225,9 @@ struct CUStats
     uint64_t countWeightAnalyze;
     uint64_t totalCTUs;
 
+    uint64_t intraPredCacheHits;    // intra predictions copied from the per-TU cache
+    uint64_t intraPredCacheLookups; // intra predictions made through the per-TU cache
+
     CUStats() { clear(); }
 
     void clear()
@@ -232,6 +268,8 @@ struct CUStats
         countPModeMasters += other.countPModeMasters;
         countWeightAnalyze += other.countWeightAnalyze;
         totalCTUs += other.totalCTUs;
+        intraPredCacheHits += other.intraPredCacheHits;
+        intraPredCacheLookups += other.intraPredCacheLookups;
 
         other.clear();
     }
@@ -257,6 +295,7 @@ public:
     const Slice*    m_slice;
 
     Entropy         m_entropyCoder;
+    EstBitsSbacCache m_estBitsCache;  /* rate tables of m_entropyCoder, per TU size */
     RQTData         m_rqt[NUM_FULL_DEPTH];
 
     uint8_t*        m_qtTempCbf[3];
@@ -265,7 +304,9 @@ public:
     pixel*          m_fencScaled;     /* 32x32 buffer for down-scaled version of 64x64 CU fenc */
     pixel*          m_fencTransposed; /* 32x32 buffer for transposed copy of fenc */
     pixel*          m_intraPred;      /* 32x32 buffer for individual intra predictions */
-    pixel*          m_intraPredAngs;  /* allocation for 33 consecutive (all angular) 32x32 intra predictions */
+    pixel*          m_intraPredAngs;  /* allocation for 33 consecutive (all angular) 32x32 intra predictions of downscaled 64x64 CUs */
+
+    TUCoeffCache    m_tuCoeffCache;   /* coefficients of recent inter TUs, by prediction */
 
     coeff_t*        m_tsCoeff;        /* transform skip coeff 32x32 */
     int16_t*        m_tsResidual;     /* transform skip residual 32x32 */
@@ -278,6 +319,14 @@ public:
 #if DETAILED_CU_STATS
     /* Accumulate CU statistics separately for each frame encoder */
     CUStats         m_stats[X265_MAX_FRAME_THREADS];
+
+    /* move intra prediction cache counters of recent work to a frame encoder's stats */
+    void flushIntraPredCacheStats(int frameEncoderID)
+    {
+        m_stats[frameEncoderID].intraPredCacheHits += m_intraPredCacheHits;
+        m_stats[frameEncoderID].intraPredCacheLookups += m_intraPredCacheLookups;
+        m_intraPredCacheHits = m_intraPredCacheLookups = 0;
+    }
 #endif
 
     Search();
@@ -289,6 +338,10 @@ public:
     // mark temp RD entropy contexts as uninitialized; useful for finding loads without stores
     void     invalidateContexts(int fromDepth);
 
+    /* approximate rate tables depend on which TUs were estimated before, so
+     * forget them wherever the work assigned to this thread is not fixed */
+    void     resetApproxRate() { if (m_estBitsCache.maxStateDrift) m_estBitsCache.invalidate(); }
+
     // full RD search of intra modes
     void     checkIntra(Mode& intraMode, const CUGeom& cuGeom, PartSize partSizes);
 
@@ -317,6 +370,9 @@ public:
     void checkDQPForSplitPred(Mode& mode, const CUGeom& cuGeom);
 
     MV getLowresMV(const CUData& cu, const PredictionUnit& pu, int list, int ref);
+    MV getHintedMV(const CUData& cu, const PredictionUnit& pu, int list, int ref);
+    bool hashMotionSearch(const CUData& cu, const PredictionUnit& pu, int list, int ref, const MV& mvp, MV& outmv, int& outCost);
+    uint32_t getHintedIntraDir(const CUData& cu, uint32_t absPartIdx, uint32_t tuSize);
 
     class PME : public BondedTaskGroup
     {
@@ -375,6 +431,9 @@ protected:
     };
 
     uint64_t estimateNullCbfCost(sse_t dist, uint32_t psyEnergy, uint32_t tuDepth, TextType compId);
+    bool     skipChromaResidual(const CUData& cu, const int16_t* resi, intptr_t stride, uint32_t log2TrSizeC, TextType ttype, bool bLumaCbf);
+    uint32_t transformInterTU(const CUData& cu, const pixel* fenc, uint32_t fencStride, const pixel* pred, uint32_t predStride, const int16_t* resi,
+                              uint32_t resiStride, coeff_t* coeff, uint32_t log2TrSize, TextType ttype, uint32_t absPartIdx);
     void     estimateResidualQT(Mode& mode, const CUGeom& cuGeom, uint32_t absPartIdx, uint32_t depth, ShortYuv& resiYuv, Cost& costs, const uint32_t depthRange[2]);
 
     // generate prediction, generate residual and recon. if bAllowSplit, find optimal RQT splits
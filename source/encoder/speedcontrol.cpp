@@ -0,0 +1,129 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "param.h"
+#include "speedcontrol.h"
+
+using namespace X265_NS;
+
+SpeedControl::SpeedControl()
+{
+    m_numLevels = 0;
+    m_level = 0;
+    m_targetFps = 0;
+    m_lastTime = 0;
+    m_lastCount = 0;
+}
+
+bool SpeedControl::sameEffort(const x265_param& a, const x265_param& b)
+{
+    return a.rdLevel == b.rdLevel &&
+           a.subpelRefine == b.subpelRefine &&
+           a.maxNumReferences == b.maxNumReferences &&
+           a.searchRange == b.searchRange &&
+           a.maxNumMergeCand == b.maxNumMergeCand &&
+           a.rdoqLevel == b.rdoqLevel &&
+           a.bEnableRectInter == b.bEnableRectInter &&
+           a.bEnableEarlySkip == b.bEnableEarlySkip &&
+           a.bEnableRecursionSkip == b.bEnableRecursionSkip &&
+           a.bEnableFastIntra == b.bEnableFastIntra &&
+           a.bIntraInBFrames == b.bIntraInBFrames &&
+           a.limitModes == b.limitModes &&
+           a.limitReferences == b.limitReferences;
+}
+
+void SpeedControl::init(const x265_param& param)
+{
+    m_targetFps = param.targetFps;
+    m_numLevels = 0;
+
+    for (int i = 0; x265_preset_names[i] && m_numLevels < MAX_LEVELS - 1; i++)
+    {
+        x265_param preset;
+        PARAM_NS::x265_param_default_preset(&preset, x265_preset_names[i], NULL);
+
+        x265_param& p = m_levels[m_numLevels];
+        memcpy(&p, &param, sizeof(x265_param));
+        p.rdLevel = X265_MIN(preset.rdLevel, param.rdLevel);
+        /* --pmode may code CUs which do not match its reconstruction at rd 2 */
+        if (param.bDistributeModeAnalysis && param.rdLevel >= 3)
+            p.rdLevel = X265_MAX(p.rdLevel, 3);
+        /* reconfigure cannot leave subme 0 */
+        if (param.subpelRefine)
+            p.subpelRefine = X265_MAX(1, X265_MIN(preset.subpelRefine, param.subpelRefine));
+        p.maxNumReferences = X265_MIN(preset.maxNumReferences, param.maxNumReferences);
+        p.searchRange = X265_MIN(preset.searchRange, param.searchRange);
+        p.maxNumMergeCand = X265_MIN(preset.maxNumMergeCand, param.maxNumMergeCand);
+        p.rdoqLevel = X265_MIN(preset.rdoqLevel, param.rdoqLevel);
+        p.bEnableRectInter = preset.bEnableRectInter && param.bEnableRectInter;
+        p.bIntraInBFrames = preset.bIntraInBFrames && param.bIntraInBFrames;
+        p.bEnableEarlySkip = preset.bEnableEarlySkip || param.bEnableEarlySkip;
+        p.bEnableRecursionSkip = preset.bEnableRecursionSkip || param.bEnableRecursionSkip;
+        p.bEnableFastIntra = preset.bEnableFastIntra || param.bEnableFastIntra;
+        p.limitModes = preset.limitModes || param.limitModes;
+        p.limitReferences = preset.limitReferences | param.limitReferences;
+        /* pmode only supports the depth limit, see Encoder::configure() */
+        if (param.bDistributeModeAnalysis && (p.limitReferences >> 1))
+            p.limitReferences = param.limitReferences;
+
+        if (sameEffort(p, param))
+            break;
+        if (!m_numLevels || !sameEffort(p, m_levels[m_numLevels - 1]))
+            m_numLevels++;
+    }
+
+    memcpy(&m_levels[m_numLevels], &param, sizeof(x265_param));
+    m_level = m_numLevels++;
+    m_lastTime = 0;
+    m_lastCount = 0;
+}
+
+x265_param* SpeedControl::update(int numEncoded, bool bInputBound)
+{
+    int64_t now = x265_mdate();
+    int64_t elapsed = now - m_lastTime;
+    int frames = numEncoded - m_lastCount;
+    bool bFirst = !m_lastTime;
+    if (!bFirst && !frames)
+        return NULL;
+
+    m_lastTime = now;
+    m_lastCount = numEncoded;
+    if (bFirst)
+        return NULL;
+
+    double fps = frames * 1000000.0 / X265_MAX(elapsed, 1);
+    int newLevel = m_level;
+    if (!bInputBound && fps < m_targetFps * 0.95)
+        newLevel -= fps < m_targetFps * 0.75 ? 2 : 1;
+    else if (bInputBound || fps > m_targetFps * 1.1)
+        newLevel++;
+    newLevel = x265_clip3(0, m_numLevels - 1, newLevel);
+
+    x265_log(&m_levels[m_level], X265_LOG_DEBUG, "speed control: %.2f fps%s, level %d -> %d of %d\n",
+             fps, bInputBound ? " (waiting for input)" : "", m_level, newLevel, m_numLevels - 1);
+    if (newLevel == m_level)
+        return NULL;
+
+    m_level = newLevel;
+    return &m_levels[m_level];
+}
@@ -0,0 +1,67 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+
+#ifndef X265_SPEEDCONTROL_H
+#define X265_SPEEDCONTROL_H
+
+#include "common.h"
+
+namespace X265_NS {
+// private x265 namespace
+
+/* Closed-loop control of the analysis effort for --target-fps. The ladder of
+ * speed levels is built from the presets, ultrafast first, keeping only the
+ * options x265_encoder_reconfig() can change and never exceeding the effort
+ * of the configured options, which form the top (slowest) level. At each
+ * keyframe the throughput since the previous keyframe is compared with the
+ * target and the encoder moves along the ladder. A lookahead which is not
+ * full means the encoder is waiting for input, that is it has headroom. */
+class SpeedControl
+{
+public:
+
+    enum { MAX_LEVELS = 11 };
+
+    SpeedControl();
+
+    void init(const x265_param& param);
+
+    /* called with the count of pictures output so far, returns the param of
+     * the new speed level or NULL if the level is unchanged */
+    x265_param* update(int numEncoded, bool bInputBound);
+
+    int level() const { return m_level; }
+
+protected:
+
+    x265_param m_levels[MAX_LEVELS];
+    int        m_numLevels;
+    int        m_level;
+    double     m_targetFps;
+    int64_t    m_lastTime;
+    int        m_lastCount;
+
+    static bool sameEffort(const x265_param& a, const x265_param& b);
+};
+}
+
+#endif // ifndef X265_SPEEDCONTROL_H
@@ -0,0 +1,405 @@
+/*****************************************************************************
+ * Copyright (C) 2017 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#include "common.h"
+#include "entropy.h"
+#include "bitstreamharness.h"
+
+using namespace X265_NS;
+
+enum { SAO_OFFSET_THRESH = 1 << X265_MIN(X265_DEPTH - 5, 5) };
+
+/* The reference coders below mirror the encoder's previous bit writer and
+ * CABAC core. They have external linkage like the encoder's own methods, so
+ * both sides of the benchmark are compiled under the same inlining rules */
+
+/* bit writer storing one byte at a time, with a capacity check per byte */
+class RefBitstream : public BitInterface
+{
+public:
+
+    uint8_t  fifo[1 << 16];
+    uint32_t byteOccupancy;
+    uint32_t partialByteBits;
+    uint8_t  partialByte;
+
+    void     resetBits()                    { byteOccupancy = partialByteBits = 0; partialByte = 0; }
+    uint32_t getNumberOfWrittenBits() const { return byteOccupancy * 8 + partialByteBits; }
+    void     writeByte(uint32_t val)        { push_back((uint8_t)val); }
+    void     writeAlignOne()                { }
+    void     writeAlignZero();
+    void     write(uint32_t val, uint32_t numBits);
+
+    void     push_back(uint8_t val)
+    {
+        if (byteOccupancy < sizeof(fifo))
+            fifo[byteOccupancy++] = val;
+    }
+};
+
+void RefBitstream::write(uint32_t val, uint32_t numBits)
+{
+    uint32_t totalPartialBits = partialByteBits + numBits;
+    uint32_t nextPartialBits = totalPartialBits & 7;
+    uint8_t  nextHeldByte = (uint8_t)(val << (8 - nextPartialBits));
+    uint32_t writeBytes = totalPartialBits >> 3;
+
+    if (writeBytes)
+    {
+        uint32_t topword = (numBits - nextPartialBits) & ~7;
+        uint32_t write_bits = (topword < 32 ? partialByte << topword : 0) | (val >> nextPartialBits);
+
+        for (uint32_t i = writeBytes; i > 0; i--)
+            push_back((uint8_t)(write_bits >> (8 * (i - 1))));
+
+        partialByte = nextHeldByte;
+        partialByteBits = nextPartialBits;
+    }
+    else
+    {
+        partialByte |= nextHeldByte;
+        partialByteBits = nextPartialBits;
+    }
+}
+
+void RefBitstream::writeAlignZero()
+{
+    if (partialByteBits)
+    {
+        push_back(partialByte);
+        partialByte = 0;
+        partialByteBits = 0;
+    }
+}
+
+/* CABAC coder with a 32-bit low register, resolving one byte per renorm and
+ * writing each through the BitInterface */
+class RefCabac
+{
+public:
+
+    BitInterface* bitIf;
+    uint8_t  contextState[MAX_OFF_CTX_MOD];
+    uint32_t low;
+    uint32_t range;
+    uint32_t bufferedByte;
+    int      numBufferedBytes;
+    int      bitsLeft;
+
+    void start(const uint8_t* ctx);
+    void encodeBin(uint32_t binValue, uint8_t& ctxModel);
+    void encodeBinEP(uint32_t binValue);
+    void encodeBinsEP(uint32_t binValues, int numBins);
+    void finishSlice();
+    void writeOut();
+
+    void codeSaoMaxUvlc(uint32_t code, uint32_t maxSymbol);
+    void codeSaoOffsetBO(const int* offset, int bandPos);
+};
+
+void RefCabac::start(const uint8_t* ctx)
+{
+    memcpy(contextState, ctx, sizeof(contextState));
+    bitIf->resetBits();
+    low = 0;
+    range = 510;
+    bitsLeft = -12;
+    numBufferedBytes = 0;
+    bufferedByte = 0xff;
+}
+
+void RefCabac::writeOut()
+{
+    uint32_t leadByte = low >> (13 + bitsLeft);
+    low &= (uint32_t)(~0) >> (11 + 8 - bitsLeft);
+    bitsLeft -= 8;
+
+    if (leadByte == 0xff)
+        numBufferedBytes++;
+    else
+    {
+        if (numBufferedBytes > 0)
+        {
+            uint32_t carry = leadByte >> 8;
+            bitIf->writeByte(bufferedByte + carry);
+            for (; numBufferedBytes > 1; numBufferedBytes--)
+                bitIf->writeByte(0xff + carry);
+        }
+        numBufferedBytes = 1;
+        bufferedByte = (uint8_t)leadByte;
+    }
+}
+
+void RefCabac::encodeBin(uint32_t binValue, uint8_t& ctxModel)
+{
+    uint32_t mstate = ctxModel;
+    ctxModel = sbacNext(mstate, binValue);
+
+    uint32_t state = sbacGetState(mstate);
+    uint32_t lps = g_lpsTable[state][(range >> 6) & 3];
+    range -= lps;
+
+    int numBits = (uint32_t)(range - 256) >> 31;
+    if ((binValue ^ mstate) & 1)
+    {
+        unsigned long idx;
+        CLZ(idx, lps);
+        numBits = state >= 63 ? 6 : 8 - (int)idx;
+        low += range;
+        range = lps;
+    }
+    low <<= numBits;
+    range <<= numBits;
+    bitsLeft += numBits;
+    if (bitsLeft >= 0)
+        writeOut();
+}
+
+void RefCabac::encodeBinEP(uint32_t binValue)
+{
+    low <<= 1;
+    if (binValue)
+        low += range;
+    if (++bitsLeft >= 0)
+        writeOut();
+}
+
+void RefCabac::encodeBinsEP(uint32_t binValues, int numBins)
+{
+    while (numBins > 8)
+    {
+        numBins -= 8;
+        uint32_t pattern = binValues >> numBins;
+        low = (low << 8) + range * pattern;
+        binValues -= pattern << numBins;
+        bitsLeft += 8;
+        if (bitsLeft >= 0)
+            writeOut();
+    }
+    low = (low << numBins) + range * binValues;
+    bitsLeft += numBins;
+    if (bitsLeft >= 0)
+        writeOut();
+}
+
+void RefCabac::finishSlice()
+{
+    range -= 2;
+    low += range;
+    low <<= 7;
+    range = 2 << 7;
+    bitsLeft += 7;
+    if (bitsLeft >= 0)
+        writeOut();
+
+    if (low >> (21 + bitsLeft))
+    {
+        bitIf->writeByte(bufferedByte + 1);
+        for (; numBufferedBytes > 1; numBufferedBytes--)
+            bitIf->writeByte(0x00);
+        low -= 1 << (21 + bitsLeft);
+    }
+    else
+    {
+        if (numBufferedBytes > 0)
+            bitIf->writeByte(bufferedByte);
+        for (; numBufferedBytes > 1; numBufferedBytes--)
+            bitIf->writeByte(0xff);
+    }
+    bitIf->write(low >> 8, 13 + bitsLeft);
+    bitIf->write(1, 1);
+    bitIf->writeAlignZero();
+}
+
+void RefCabac::codeSaoMaxUvlc(uint32_t code, uint32_t maxSymbol)
+{
+    encodeBinEP(!!code);
+    if (code)
+    {
+        uint32_t isCodeLast = maxSymbol > code;
+        encodeBinsEP(((1 << (code - 1)) - 1) << isCodeLast, code - 1 + isCodeLast);
+    }
+}
+
+void RefCabac::codeSaoOffsetBO(const int* offset, int bandPos)
+{
+    encodeBin(1, contextState[OFF_SAO_TYPE_IDX_CTX]);
+    encodeBinEP(0);
+    for (int i = 0; i < 4; i++)
+        codeSaoMaxUvlc(abs(offset[i]), SAO_OFFSET_THRESH - 1);
+    for (int i = 0; i < 4; i++)
+        if (offset[i])
+            encodeBinEP(offset[i] < 0);
+    encodeBinsEP(bandPos, 5);
+}
+
+namespace {
+
+/* the reference coders share the signatures of the opt functions for
+ * REPORT_SPEEDUP, they write to these globals instead */
+RefBitstream g_refBitstream;
+RefBitstream g_refCabacBitstream;
+RefCabac     g_refCabac;
+
+void write_ref(Bitstream*, const uint32_t* val, const uint8_t* len, int count)
+{
+    g_refBitstream.resetBits();
+    for (int i = 0; i < count; i++)
+        g_refBitstream.write(val[i], len[i]);
+    g_refBitstream.write(1, 1);
+    g_refBitstream.writeAlignZero();
+}
+
+void write_opt(Bitstream* bs, const uint32_t* val, const uint8_t* len, int count)
+{
+    bs->resetBits();
+    for (int i = 0; i < count; i++)
+        bs->write(val[i], len[i]);
+    bs->writeByteAlignment();
+}
+
+void encode_ref(Entropy* entropy, const Slice* slice, int (*offset)[4], const int* band, const uint8_t* cbf, int count)
+{
+    entropy->resetEntropy(*slice);
+    g_refCabac.bitIf = &g_refCabacBitstream;
+    g_refCabac.start(entropy->m_contextState);
+    for (int i = 0; i < count; i++)
+    {
+        g_refCabac.encodeBin(cbf[i], g_refCabac.contextState[OFF_QT_CBF_CTX + 1]);
+        g_refCabac.codeSaoOffsetBO(offset[i], band[i]);
+    }
+    g_refCabac.finishSlice();
+}
+
+void encode_opt(Entropy* entropy, const Slice* slice, int (*offset)[4], const int* band, const uint8_t* cbf, int count)
+{
+    entropy->resetEntropy(*slice);
+    entropy->resetBits();
+    for (int i = 0; i < count; i++)
+    {
+        entropy->codeQtCbfLuma(cbf[i], 0);
+        entropy->codeSaoOffsetBO(offset[i], band[i], 0);
+    }
+    entropy->finishSlice();
+}
+
+}
+
+BitstreamHarness::BitstreamHarness()
+{
+    for (int i = 0; i < NUM_CODES; i++)
+    {
+        code_len[i] = (uint8_t)(rand() % 33);
+        uint32_t val = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+        code_val[i] = code_len[i] == 32 ? val : val & ((1u << code_len[i]) - 1);
+    }
+
+    for (int i = 0; i < NUM_SYMBOLS; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            int mag = rand() % SAO_OFFSET_THRESH;
+            sao_offset[i][j] = (rand() & 1) ? -mag : mag;
+        }
+        sao_band[i] = rand() & 31;
+        cbf_flag[i] = (uint8_t)((rand() & 3) == 0);
+    }
+}
+
+bool BitstreamHarness::check_bitstream_write()
+{
+    Bitstream bs;
+
+    for (int i = 0; i < 100; i++)
+    {
+        int start = rand() % NUM_CODES;
+        int count = rand() % (NUM_CODES - start) + 1;
+
+        write_ref(&bs, code_val + start, code_len + start, count);
+        write_opt(&bs, code_val + start, code_len + start, count);
+
+        if (bs.getNumberOfWrittenBytes() != g_refBitstream.byteOccupancy ||
+            memcmp(bs.getFIFO(), g_refBitstream.fifo, g_refBitstream.byteOccupancy))
+            return false;
+    }
+
+    return true;
+}
+
+bool BitstreamHarness::check_cabac_encode()
+{
+    Slice slice;
+    Bitstream bs;
+    Entropy entropy;
+    entropy.setBitstream(&bs);
+
+    for (int i = 0; i < 100; i++)
+    {
+        slice.m_sliceType = (SliceType)(rand() % 3);
+        slice.m_sliceQp = rand() % (QP_MAX_SPEC + 1);
+
+        int start = rand() % NUM_SYMBOLS;
+        int count = rand() % (NUM_SYMBOLS - start) + 1;
+
+        encode_ref(&entropy, &slice, sao_offset + start, sao_band + start, cbf_flag + start, count);
+        encode_opt(&entropy, &slice, sao_offset + start, sao_band + start, cbf_flag + start, count);
+
+        if (bs.getNumberOfWrittenBytes() != g_refCabacBitstream.byteOccupancy ||
+            memcmp(bs.getFIFO(), g_refCabacBitstream.fifo, g_refCabacBitstream.byteOccupancy))
+            return false;
+    }
+
+    return true;
+}
+
+bool BitstreamHarness::testCorrectness(const EncoderPrimitives&, const EncoderPrimitives&)
+{
+    if (!check_bitstream_write())
+    {
+        printf("Bitstream::write failed!\n");
+        return false;
+    }
+
+    if (!check_cabac_encode())
+    {
+        printf("CABAC encode failed!\n");
+        return false;
+    }
+
+    return true;
+}
+
+void BitstreamHarness::measureSpeed(const EncoderPrimitives&, const EncoderPrimitives&)
+{
+    Bitstream bs;
+    printf("bitstream_write[%d]", BENCH_CODES);
+    REPORT_SPEEDUP(write_opt, write_ref, &bs, code_val, code_len, BENCH_CODES);
+
+    Slice slice;
+    slice.m_sliceType = I_SLICE;
+    slice.m_sliceQp = 22;
+
+    Entropy entropy;
+    entropy.setBitstream(&bs);
+
+    printf("cabac_encode[%d]", BENCH_SYMBOLS);
+    REPORT_SPEEDUP(encode_opt, encode_ref, &entropy, &slice, sao_offset, sao_band, cbf_flag, BENCH_SYMBOLS);
+}
@@ -0,0 +1,63 @@
+/*****************************************************************************
+ * Copyright (C) 2017 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+#ifndef _BITSTREAMHARNESS_H_1
+#define _BITSTREAMHARNESS_H_1 1
+
+#include "testharness.h"
+#include "primitives.h"
+
+/* The bit writer and the CABAC coder are not primitives, there is only one
+ * implementation of each. They are checked and timed against simple byte at
+ * a time reference coders kept here */
+class BitstreamHarness : public TestHarness
+{
+protected:
+
+    enum { NUM_CODES = 4096 };
+    enum { NUM_SYMBOLS = 1024 };
+    enum { BENCH_CODES = 256 };
+    enum { BENCH_SYMBOLS = 64 };
+
+    /* random write() arguments */
+    uint32_t code_val[NUM_CODES];
+    uint8_t  code_len[NUM_CODES];
+
+    /* random SAO band offset and cbf syntax, mostly bypass bins */
+    int      sao_offset[NUM_SYMBOLS][4];
+    int      sao_band[NUM_SYMBOLS];
+    uint8_t  cbf_flag[NUM_SYMBOLS];
+
+    bool check_bitstream_write();
+    bool check_cabac_encode();
+
+public:
+
+    BitstreamHarness();
+
+    const char *getName() const { return "bitstream"; }
+
+    bool testCorrectness(const EncoderPrimitives& ref, const EncoderPrimitives& opt);
+
+    void measureSpeed(const EncoderPrimitives& ref, const EncoderPrimitives& opt);
+};
+
+#endif // ifndef _BITSTREAMHARNESS_H_1
@@ -341,6 +341,78 @@ bool MBDstHarness::check_denoise_dct_primitive(denoiseDct_t ref, denoiseDct_t op
 }
 
 
+bool MBDstHarness::check_nonPsyRdoQuant_primitive(nonPsyRdoQuant_t ref, nonPsyRdoQuant_t opt, int log2TrSize)
+{
+    int j = 0;
+    int trSize = 1 << log2TrSize;
+    int cgStride = trSize >> 2;
+    int cmp_size = sizeof(int64_t) * trSize * trSize;
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int index = rand() % TEST_CASES;
+        int cg = rand() % (cgStride * cgStride);
+        uint32_t blkPos = (cg / cgStride) * 4 * trSize + (cg % cgStride) * 4;
+
+        int64_t refTotalUncoded = 0, refTotalRd = 0;
+        int64_t optTotalUncoded = 0, optTotalRd = 0;
+        memset(mlongbuf1, 0, cmp_size);
+        memset(mlongbuf2, 0, cmp_size);
+
+        ref(short_denoise_test_buff1[index] + j, mlongbuf1, &refTotalUncoded, &refTotalRd, blkPos);
+        checked(opt, short_denoise_test_buff1[index] + j, mlongbuf2, &optTotalUncoded, &optTotalRd, blkPos);
+
+        if (memcmp(mlongbuf1, mlongbuf2, cmp_size))
+            return false;
+
+        if (refTotalUncoded != optTotalUncoded || refTotalRd != optTotalRd)
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+
+    return true;
+}
+
+bool MBDstHarness::check_psyRdoQuant_primitive(psyRdoQuant_t ref, psyRdoQuant_t opt, int log2TrSize)
+{
+    int j = 0;
+    int trSize = 1 << log2TrSize;
+    int cgStride = trSize >> 2;
+    int cmp_size = sizeof(int64_t) * trSize * trSize;
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int index1 = rand() % TEST_CASES;
+        int index2 = rand() % TEST_CASES;
+        int cg = rand() % (cgStride * cgStride);
+        uint32_t blkPos = (cg / cgStride) * 4 * trSize + (cg % cgStride) * 4;
+
+        /* psy-rdoq strength [0, 50] * 256 times a lambda of up to 20 bits */
+        int64_t psyScale = (int64_t)(rand() % (50 * 256 + 1)) * (rand() & ((1 << 20) - 1));
+
+        int64_t refTotalUncoded = 0, refTotalRd = 0;
+        int64_t optTotalUncoded = 0, optTotalRd = 0;
+        memset(mlongbuf1, 0, cmp_size);
+        memset(mlongbuf2, 0, cmp_size);
+
+        ref(short_denoise_test_buff1[index1] + j, short_denoise_test_buff2[index2] + j, mlongbuf1, &refTotalUncoded, &refTotalRd, psyScale, blkPos);
+        checked(opt, short_denoise_test_buff1[index1] + j, short_denoise_test_buff2[index2] + j, mlongbuf2, &optTotalUncoded, &optTotalRd, psyScale, blkPos);
+
+        if (memcmp(mlongbuf1, mlongbuf2, cmp_size))
+            return false;
+
+        if (refTotalUncoded != optTotalUncoded || refTotalRd != optTotalRd)
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+
+    return true;
+}
+
 bool MBDstHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPrimitives& opt)
 {
     for (int i = 0; i < NUM_TR_SIZE; i++)
@@ -449,6 +521,26 @@ bool MBDstHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPr
         }
     }
 
+    for (int i = 0; i < NUM_TR_SIZE; i++)
+    {
+        if (opt.cu[i].nonPsyRdoQuant)
+        {
+            if (!check_nonPsyRdoQuant_primitive(ref.cu[i].nonPsyRdoQuant, opt.cu[i].nonPsyRdoQuant, i + 2))
+            {
+                printf("nonPsyRdoQuant[%dx%d]: Failed!\n", 4 << i, 4 << i);
+                return false;
+            }
+        }
+        if (opt.cu[i].psyRdoQuant)
+        {
+            if (!check_psyRdoQuant_primitive(ref.cu[i].psyRdoQuant, opt.cu[i].psyRdoQuant, i + 2))
+            {
+                printf("psyRdoQuant[%dx%d]: Failed!\n", 4 << i, 4 << i);
+                return false;
+            }
+        }
+    }
+
     return true;
 }
 
@@ -520,4 +612,19 @@ void MBDstHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
         printf("denoiseDct\t");
         REPORT_SPEEDUP(opt.denoiseDct, ref.denoiseDct, short_denoise_test_buff1[0], mubuf1, mushortbuf1, 32 * 32);
     }
+
+    int64_t totalUncodedCost = 0, totalRdCost = 0;
+    for (int value = 0; value < NUM_TR_SIZE; value++)
+    {
+        if (opt.cu[value].nonPsyRdoQuant)
+        {
+            printf("nonPsyRdoQuant[%dx%d]", 4 << value, 4 << value);
+            REPORT_SPEEDUP(opt.cu[value].nonPsyRdoQuant, ref.cu[value].nonPsyRdoQuant, short_denoise_test_buff1[0], mlongbuf1, &totalUncodedCost, &totalRdCost, 0);
+        }
+        if (opt.cu[value].psyRdoQuant)
+        {
+            printf("psyRdoQuant[%dx%d]", 4 << value, 4 << value);
+            REPORT_SPEEDUP(opt.cu[value].psyRdoQuant, ref.cu[value].psyRdoQuant, short_denoise_test_buff1[0], short_denoise_test_buff2[0], mlongbuf1, &totalUncodedCost, &totalRdCost, 256 * 23785, 0);
+        }
+    }
 }
@@ -1265,6 +1265,60 @@ bool PixelHarness::check_saoCuStatsE3_t(saoCuStatsE3_t ref, saoCuStatsE3_t opt)
     return true;
 }
 
+bool PixelHarness::check_saoCuStatsAll_t(saoCuStatsAll_t ref, saoCuStatsAll_t opt)
+{
+    enum { NUM_STATS = 5 * 32 };
+    int32_t stats_ref[NUM_STATS];
+    int32_t stats_vec[NUM_STATS];
+
+    int32_t count_ref[NUM_STATS];
+    int32_t count_vec[NUM_STATS];
+
+    int j = 0;
+    for (int i = 0; i < ITERS; i++)
+    {
+        for (int x = 0; x < NUM_STATS; x++)
+        {
+            stats_ref[x] = stats_vec[x] = rand();
+            count_ref[x] = count_vec[x] = rand();
+        }
+
+        // blocks of the types as SAO::calcSaoStatsCTU() sets them, luma or chroma CTU at any picture edge
+        const int size = (rand() & 1) ? 64 : 32;
+        const int planeOffset = size == 32 ? 2 : 0;
+        const bool bLeft = rand() & 1, bTop = rand() & 1, bRight = rand() & 1, bBottom = rand() & 1;
+        const int width = bRight ? size - (rand() % (size - 8)) : size;
+        const int height = bBottom ? size - (rand() % (size - 8)) : size;
+        const int eoEndX = bRight ? width - 1 : width - 5 + planeOffset;
+        const int boEndX = bRight ? width : width - 5 + planeOffset;
+        const int eoEndY = bBottom ? height - 1 : height - 4 + planeOffset;
+        const int boEndY = bBottom ? height : height - 4 + planeOffset;
+
+        const int bounds[5][4] =
+        {
+            { bLeft, 0,    eoEndX, height - 4 + planeOffset },
+            { 0,     bTop, boEndX, eoEndY },
+            { bLeft, bTop, eoEndX, eoEndY },
+            { bLeft, bTop, eoEndX, eoEndY },
+            { 0,     0,    boEndX, boEndY }
+        };
+
+        intptr_t stride = 64 + 16 * (rand() % 2);
+        const pixel* rec = pbuf3 + j + stride + 1;
+
+        ref(sbuf2 + j, rec, stride, bounds[0], stats_ref, count_ref);
+        checked(opt, sbuf2 + j, rec, stride, bounds[0], stats_vec, count_vec);
+
+        if (memcmp(stats_ref, stats_vec, sizeof(stats_ref)) || memcmp(count_ref, count_vec, sizeof(count_ref)))
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+
+    return true;
+}
+
 bool PixelHarness::check_saoCuOrgE3_32_t(saoCuOrgE3_t ref, saoCuOrgE3_t opt)
 {
     ALIGN_VAR_16(pixel, ref_dest[64 * 64]);
@@ -1372,6 +1426,29 @@ bool PixelHarness::check_planecopy_cp(planecopy_cp_t ref, planecopy_cp_t opt)
     return true;
 }
 
+bool PixelHarness::check_planeChecksum(planeChecksum_t ref, planeChecksum_t opt)
+{
+    int j = 0;
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int index = i % TEST_CASES;
+        int width = 1 + rand() % STRIDE;
+        int height = 1 + rand() % 32;
+        int y = rand() % 1100; /* crosses multiples of 256 */
+
+        uint32_t vres = (uint32_t)checked(opt, pixel_test_buff[index] + j, STRIDE, width, height, y);
+        uint32_t cres = ref(pixel_test_buff[index] + j, STRIDE, width, height, y);
+        if (vres != cres)
+            return false;
+
+        reportfail();
+        j += INCR;
+    }
+
+    return true;
+}
+
 bool PixelHarness::check_cutree_propagate_cost(cutree_propagate_cost ref, cutree_propagate_cost opt)
 {
     ALIGN_VAR_16(int, ref_dest[64 * 64]);
@@ -1941,6 +2018,88 @@ bool PixelHarness::check_pelFilterLumaStrong_V(pelFilterLumaStrong_t ref, pelFil
     return true;
 }
 
+bool PixelHarness::check_pelFilterLumaEdge(pelFilterLumaEdge_t ref, pelFilterLumaEdge_t opt, int dir)
+{
+    /* flat blocks with some noise and a step at the edge, which reach the
+     * strong, weak and unfiltered cases */
+    enum { COUNT = MAX_CU_SIZE >> LOG2_UNIT_SIZE };
+    intptr_t srcStep = dir ? 1 : STRIDE, offset = dir ? STRIDE : 1;
+    const int shift = X265_DEPTH - 8;
+    pixel ref_dest[STRIDE * STRIDE], opt_dest[STRIDE * STRIDE];
+    int32_t tc[COUNT], beta[COUNT], maskP[COUNT], maskQ[COUNT];
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int base = rand() % 256;
+        int step = rand() % 64 - 32;
+        int noise = 1 << (rand() % 6);
+        for (int y = 0; y < STRIDE; y++)
+        {
+            for (int x = 0; x < STRIDE; x++)
+            {
+                int across = dir ? y : x;
+                ref_dest[y * STRIDE + x] = x265_clip((base + rand() % noise + (across >= 4 ? step : 0)) << shift);
+            }
+        }
+        memcpy(opt_dest, ref_dest, sizeof(ref_dest));
+
+        for (int u = 0; u < COUNT; u++)
+        {
+            tc[u] = rand() % 4 ? (rand() % 25) << shift : 0;
+            beta[u] = (rand() % 65) << shift;
+            maskP[u] = rand() % 4 ? -1 : 0;
+            maskQ[u] = rand() % 4 ? -1 : 0;
+        }
+
+        ref(ref_dest + 4 * offset, srcStep, offset, tc, beta, maskP, maskQ, COUNT);
+        checked(opt, opt_dest + 4 * offset, srcStep, offset, tc, beta, maskP, maskQ, COUNT);
+
+        if (memcmp(ref_dest, opt_dest, sizeof(ref_dest)))
+            return false;
+
+        reportfail()
+    }
+
+    return true;
+}
+
+bool PixelHarness::check_boundaryStrength(boundaryStrength_t ref, boundaryStrength_t opt)
+{
+    enum { UNITS = MAX_NUM_PARTITIONS / 2 };
+    static const int16_t extremes[4] = { -32768, -32765, 32764, 32767 };
+    int32_t refs[4][UNITS], mvs[4][UNITS];
+    uint8_t ref_dest[UNITS], opt_dest[UNITS];
+
+    for (int i = 0; i < ITERS; i++)
+    {
+        int count = 1 + rand() % UNITS;
+        for (int l = 0; l < 4; l++)
+        {
+            for (int u = 0; u < UNITS; u++)
+            {
+                /* -2 and -1 stand for unused lists, 0 and 1 for two pictures */
+                refs[l][u] = rand() % 4 - 2;
+                int16_t x = rand() % 16 ? (int16_t)(rand() % 17 - 8) : extremes[rand() % 4];
+                int16_t y = rand() % 16 ? (int16_t)(rand() % 17 - 8) : extremes[rand() % 4];
+                mvs[l][u] = (int32_t)(((uint32_t)(uint16_t)y << 16) | (uint16_t)x);
+            }
+        }
+
+        memset(ref_dest, 0xcd, sizeof(ref_dest));
+        memset(opt_dest, 0xcd, sizeof(opt_dest));
+
+        ref(refs[0], mvs[0], UNITS, ref_dest, count);
+        checked(opt, refs[0], mvs[0], UNITS, opt_dest, count);
+
+        if (memcmp(ref_dest, opt_dest, sizeof(ref_dest)))
+            return false;
+
+        reportfail()
+    }
+
+    return true;
+}
+
 bool PixelHarness::check_pelFilterChroma_H(pelFilterChroma_t ref, pelFilterChroma_t opt)
 {
     intptr_t srcStep = 1, offset = 64;
@@ -2552,6 +2711,15 @@ bool PixelHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPr
         }
     }
 
+    if (opt.saoCuStatsAll)
+    {
+        if (!check_saoCuStatsAll_t(ref.saoCuStatsAll, opt.saoCuStatsAll))
+        {
+            printf("saoCuStatsAll failed\n");
+            return false;
+        }
+    }
+
     if (opt.planecopy_sp)
     {
         if (!check_planecopy_sp(ref.planecopy_sp, opt.planecopy_sp))
@@ -2579,6 +2747,15 @@ bool PixelHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPr
         }
     }
 
+    if (opt.planeChecksum)
+    {
+        if (!check_planeChecksum(ref.planeChecksum, opt.planeChecksum))
+        {
+            printf("planeChecksum failed\n");
+            return false;
+        }
+    }
+
     if (opt.propagateCost)
     {
         if (!check_cutree_propagate_cost(ref.propagateCost, opt.propagateCost))
@@ -2670,6 +2847,27 @@ bool PixelHarness::testCorrectness(const EncoderPrimitives& ref, const EncoderPr
         }
     }
 
+    for (int dir = 0; dir < 2; dir++)
+    {
+        if (opt.pelFilterLumaEdge[dir])
+        {
+            if (!check_pelFilterLumaEdge(ref.pelFilterLumaEdge[dir], opt.pelFilterLumaEdge[dir], dir))
+            {
+                printf("pelFilterLumaEdge[%s] failed!\n", dir ? "Horizontal" : "Vertical");
+                return false;
+            }
+        }
+    }
+
+    if (opt.boundaryStrength)
+    {
+        if (!check_boundaryStrength(ref.boundaryStrength, opt.boundaryStrength))
+        {
+            printf("boundaryStrength failed!\n");
+            return false;
+        }
+    }
+
     if (opt.pelFilterChroma[0])
     {
         if (!check_pelFilterChroma_V(ref.pelFilterChroma[0], opt.pelFilterChroma[0]))
@@ -3087,6 +3285,14 @@ void PixelHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
         REPORT_SPEEDUP(opt.saoCuStatsE3, ref.saoCuStatsE3, sbuf2, pbuf3, 64, upBuff1 + 1, 60, 61, stats, count);
     }
 
+    if (opt.saoCuStatsAll)
+    {
+        int32_t stats[5 * 32], count[5 * 32];
+        const int bounds[5][4] = { { 1, 0, 59, 60 }, { 0, 1, 59, 60 }, { 1, 1, 59, 60 }, { 1, 1, 59, 60 }, { 0, 0, 59, 60 } };
+        HEADER0("saoCuStatsAll");
+        REPORT_SPEEDUP(opt.saoCuStatsAll, ref.saoCuStatsAll, sbuf2, pbuf3 + 65, 64, bounds[0], stats, count);
+    }
+
     if (opt.planecopy_sp)
     {
         HEADER0("planecopy_sp");
@@ -3099,6 +3305,12 @@ void PixelHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
         REPORT_SPEEDUP(opt.planecopy_cp, ref.planecopy_cp, uchar_test_buff[0], 64, pbuf1, 64, 64, 64, 2);
     }
 
+    if (opt.planeChecksum)
+    {
+        HEADER0("planeChecksum");
+        REPORT_SPEEDUP(opt.planeChecksum, ref.planeChecksum, pbuf1, STRIDE, 64, 64, 300);
+    }
+
     if (opt.propagateCost)
     {
         HEADER0("propagateCost");
@@ -3193,6 +3405,33 @@ void PixelHarness::measureSpeed(const EncoderPrimitives& ref, const EncoderPrimi
         REPORT_SPEEDUP(opt.pelFilterLumaStrong[1], ref.pelFilterLumaStrong[1], pbuf1, 1, STRIDE, tcP, tcQ);
     }
 
+    if (opt.pelFilterLumaEdge[0] || opt.pelFilterLumaEdge[1])
+    {
+        int32_t tc[16], beta[16], maskP[16], maskQ[16];
+        for (int u = 0; u < 16; u++)
+        {
+            tc[u] = (1 + rand() % 24) << (X265_DEPTH - 8);
+            beta[u] = (rand() % 65) << (X265_DEPTH - 8);
+            maskP[u] = maskQ[u] = -1;
+        }
+        if (opt.pelFilterLumaEdge[0])
+        {
+            HEADER0("pelFilterLumaEdge_Vertical");
+            REPORT_SPEEDUP(opt.pelFilterLumaEdge[0], ref.pelFilterLumaEdge[0], pbuf1 + 4, STRIDE, 1, tc, beta, maskP, maskQ, 16);
+        }
+        if (opt.pelFilterLumaEdge[1])
+        {
+            HEADER0("pelFilterLumaEdge_Horizontal");
+            REPORT_SPEEDUP(opt.pelFilterLumaEdge[1], ref.pelFilterLumaEdge[1], pbuf1 + 4 * STRIDE, 1, STRIDE, tc, beta, maskP, maskQ, 16);
+        }
+    }
+
+    if (opt.boundaryStrength)
+    {
+        HEADER0("boundaryStrength");
+        REPORT_SPEEDUP(opt.boundaryStrength, ref.boundaryStrength, (int32_t*)ibuf1, (int32_t*)ibuf1 + 4 * 128, 128, (uint8_t*)psbuf1, 128);
+    }
+
     if (opt.pelFilterChroma[0])
     {
         int32_t tc = (rand() % PIXEL_MAX);
@@ -30,6 +30,7 @@
 #include "mbdstharness.h"
 #include "ipfilterharness.h"
 #include "intrapredharness.h"
+#include "bitstreamharness.h"
 #include "param.h"
 #include "cpu.h"
 
@@ -84,7 +85,7 @@ void do_help()
     printf("x265 optimized primitive testbench\n\n");
     printf("usage: TestBench [--cpuid CPU] [--testbench BENCH] [--help]\n\n");
     printf("       CPU is comma separated SIMD arch list, example: SSE4,AVX\n");
-    printf("       BENCH is one of (pixel,transforms,interp,intrapred)\n\n");
+    printf("       BENCH is one of (pixel,transforms,interp,intrapred,bitstream)\n\n");
     printf("By default, the test bench will test all benches on detected CPU architectures\n");
     printf("Options and testbench name may be truncated.\n");
 }
@@ -93,6 +94,7 @@ PixelHarness  HPixel;
 MBDstHarness  HMBDist;
 IPFilterHarness HIPFilter;
 IntraPredHarness HIPred;
+BitstreamHarness HBitstream;
 
 int main(int argc, char *argv[])
 {
@@ -147,7 +149,8 @@ int main(int argc, char *argv[])
         &HPixel,
         &HMBDist,
         &HIPFilter,
-        &HIPred
+        &HIPred,
+        &HBitstream
     };
 
     EncoderPrimitives cprim;
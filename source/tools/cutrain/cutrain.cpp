@@ -0,0 +1,401 @@
+/*****************************************************************************
+ * Copyright (C) 2016 x265 project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02111, USA.
+ *
+ * This program is also available under a commercial proprietary license.
+ * For more information, contact us at license @ x265.com.
+ *****************************************************************************/
+
+/* cutrain: trains the CU split and merge classifiers used by --cu-classify
+ * from the CSV files written by --cu-classify-dump. One L2 regularised
+ * logistic regression is fitted per decision and CU depth with Newton's
+ * method. The output is a model file for --cu-classify-model, or with
+ * --c-table an initializer for the compiled-in model in cuclassifier.cpp */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum { MAX_DEPTHS = 4, MAX_FEATURES = 32 };
+
+const char* const decisionNames[] = { "split", "merge" };
+const int numDecisions = 2;
+
+struct Sample
+{
+    int    depth;
+    double features[MAX_FEATURES];
+    bool   label[2];
+};
+
+std::vector<std::string> featureNames;
+std::vector<Sample> samples;
+
+bool split(char* line, std::vector<char*>& fields)
+{
+    fields.clear();
+    for (char* tok = strtok(line, ",\r\n"); tok; tok = strtok(NULL, ",\r\n"))
+        fields.push_back(tok);
+    return !fields.empty();
+}
+
+bool readCSV(const char* filename)
+{
+    FILE* fp = fopen(filename, "r");
+    if (!fp)
+    {
+        fprintf(stderr, "cutrain: unable to open %s\n", filename);
+        return false;
+    }
+
+    char line[1024];
+    std::vector<char*> fields;
+    if (!fgets(line, sizeof(line), fp) || !split(line, fields) || fields.size() < 4 ||
+        strcmp(fields[0], "depth") || strcmp(fields[fields.size() - 2], "split") || strcmp(fields.back(), "merge"))
+    {
+        fprintf(stderr, "cutrain: %s is not a --cu-classify-dump file\n", filename);
+        fclose(fp);
+        return false;
+    }
+
+    /* every file must have the same feature columns */
+    std::vector<std::string> names(fields.begin() + 1, fields.end() - 2);
+    if (names.size() > MAX_FEATURES || (!featureNames.empty() && names != featureNames))
+    {
+        fprintf(stderr, "cutrain: %s has unexpected feature columns\n", filename);
+        fclose(fp);
+        return false;
+    }
+    featureNames = names;
+
+    size_t numFeatures = featureNames.size();
+    int lineNum = 1;
+    while (fgets(line, sizeof(line), fp))
+    {
+        lineNum++;
+        if (!split(line, fields))
+            continue;
+        if (fields.size() != numFeatures + 3)
+        {
+            fprintf(stderr, "cutrain: %s:%d: expected %d fields\n", filename, lineNum, (int)numFeatures + 3);
+            fclose(fp);
+            return false;
+        }
+
+        Sample s;
+        s.depth = atoi(fields[0]);
+        if (s.depth < 0 || s.depth >= MAX_DEPTHS)
+            continue;
+        for (size_t i = 0; i < numFeatures; i++)
+            s.features[i] = atof(fields[i + 1]);
+        s.label[0] = !!atoi(fields[numFeatures + 1]);
+        s.label[1] = !!atoi(fields[numFeatures + 2]);
+        samples.push_back(s);
+    }
+
+    fclose(fp);
+    return true;
+}
+
+/* solve A x = b in place by Gaussian elimination with partial pivoting */
+bool solve(int n, double A[][MAX_FEATURES + 1], double* b)
+{
+    for (int c = 0; c < n; c++)
+    {
+        int pivot = c;
+        for (int r = c + 1; r < n; r++)
+            if (fabs(A[r][c]) > fabs(A[pivot][c]))
+                pivot = r;
+        if (fabs(A[pivot][c]) < 1e-12)
+            return false;
+        if (pivot != c)
+        {
+            for (int k = 0; k < n; k++)
+            {
+                double t = A[c][k]; A[c][k] = A[pivot][k]; A[pivot][k] = t;
+            }
+            double t = b[c]; b[c] = b[pivot]; b[pivot] = t;
+        }
+        for (int r = c + 1; r < n; r++)
+        {
+            double f = A[r][c] / A[c][c];
+            for (int k = c; k < n; k++)
+                A[r][k] -= f * A[c][k];
+            b[r] -= f * b[c];
+        }
+    }
+    for (int r = n - 1; r >= 0; r--)
+    {
+        for (int k = r + 1; k < n; k++)
+            b[r] -= A[r][k] * b[k];
+        b[r] /= A[r][r];
+    }
+    return true;
+}
+
+inline double sigmoid(double x) { return 1.0 / (1.0 + exp(-x)); }
+
+inline double score(const double* w, const double* x, int numFeatures)
+{
+    double s = w[0];
+    for (int i = 0; i < numFeatures; i++)
+        s += w[i + 1] * x[i];
+    return s;
+}
+
+/* fit w (bias first) for one decision and depth, returns number of samples */
+int train(int decision, int depth, double lambda, int iterations, double* w)
+{
+    int numFeatures = (int)featureNames.size();
+    int n = numFeatures + 1;
+
+    /* standardise the features so one regularisation strength fits all */
+    double mean[MAX_FEATURES] = { 0 }, scale[MAX_FEATURES];
+    int count = 0;
+    for (size_t s = 0; s < samples.size(); s++)
+    {
+        if (samples[s].depth != depth)
+            continue;
+        for (int i = 0; i < numFeatures; i++)
+            mean[i] += samples[s].features[i];
+        count++;
+    }
+    memset(w, 0, sizeof(double) * n);
+    if (!count)
+        return 0;
+
+    for (int i = 0; i < numFeatures; i++)
+        mean[i] /= count;
+    for (int i = 0; i < numFeatures; i++)
+    {
+        double var = 0;
+        for (size_t s = 0; s < samples.size(); s++)
+            if (samples[s].depth == depth)
+                var += (samples[s].features[i] - mean[i]) * (samples[s].features[i] - mean[i]);
+        scale[i] = var > 0 ? 1.0 / sqrt(var / count) : 0.0;
+    }
+
+    double v[MAX_FEATURES + 1] = { 0 };
+    for (int iter = 0; iter < iterations; iter++)
+    {
+        double H[MAX_FEATURES + 1][MAX_FEATURES + 1];
+        double g[MAX_FEATURES + 1];
+        memset(H, 0, sizeof(H));
+        memset(g, 0, sizeof(g));
+
+        for (size_t s = 0; s < samples.size(); s++)
+        {
+            const Sample& smp = samples[s];
+            if (smp.depth != depth)
+                continue;
+
+            double x[MAX_FEATURES + 1];
+            x[0] = 1.0;
+            for (int i = 0; i < numFeatures; i++)
+                x[i + 1] = (smp.features[i] - mean[i]) * scale[i];
+
+            double p = sigmoid(score(v, x + 1, numFeatures));
+            double err = p - (smp.label[decision] ? 1.0 : 0.0);
+            double h = p * (1 - p) > 1e-9 ? p * (1 - p) : 1e-9;
+            for (int i = 0; i < n; i++)
+            {
+                g[i] += err * x[i];
+                for (int k = 0; k < n; k++)
+                    H[i][k] += h * x[i] * x[k];
+            }
+        }
+
+        /* do not regularise the bias */
+        for (int i = 1; i < n; i++)
+        {
+            g[i] += lambda * v[i];
+            H[i][i] += lambda;
+        }
+
+        if (!solve(n, H, g))
+            break;
+        double step = 0;
+        for (int i = 0; i < n; i++)
+        {
+            v[i] -= g[i];
+            step += fabs(g[i]);
+        }
+        if (step < 1e-8)
+            break;
+    }
+
+    /* fold the standardisation back into the weights */
+    w[0] = v[0];
+    for (int i = 0; i < numFeatures; i++)
+    {
+        w[i + 1] = v[i + 1] * scale[i];
+        w[0] -= v[i + 1] * scale[i] * mean[i];
+    }
+
+    return count;
+}
+
+/* report how often a confident prediction is made at the thresholds used by
+ * --cu-classify 1 and 2, and how often it is wrong */
+void report(int decision, int depth, const double* w)
+{
+    static const double thresh[] = { 0.05, 0.15 };
+    int numFeatures = (int)featureNames.size();
+    int total = 0, positives = 0, fired[2] = { 0, 0 }, wrong[2] = { 0, 0 };
+
+    for (size_t s = 0; s < samples.size(); s++)
+    {
+        const Sample& smp = samples[s];
+        if (smp.depth != depth)
+            continue;
+        total++;
+        positives += smp.label[decision];
+
+        double p = sigmoid(score(w, smp.features, numFeatures));
+        for (int l = 0; l < 2; l++)
+        {
+            /* split is acted on when unlikely, merge when likely */
+            bool bFire = decision == 0 ? p < thresh[l] : p > 1 - thresh[l];
+            if (bFire)
+            {
+                fired[l]++;
+                wrong[l] += decision == 0 ? smp.label[decision] : !smp.label[decision];
+            }
+        }
+    }
+
+    if (!total)
+        return;
+    fprintf(stderr, "%-5s depth %d: %7d samples, %5.1f%% taken; level 1 acts on %5.1f%% (%4.1f%% wrong), level 2 on %5.1f%% (%4.1f%% wrong)\n",
+            decisionNames[decision], depth, total, 100.0 * positives / total,
+            100.0 * fired[0] / total, fired[0] ? 100.0 * wrong[0] / fired[0] : 0.0,
+            100.0 * fired[1] / total, fired[1] ? 100.0 * wrong[1] / fired[1] : 0.0);
+}
+
+void usage()
+{
+    fprintf(stderr,
+            "usage: cutrain [options] <dump.csv> [<dump.csv> ...]\n"
+            "\n"
+            "Train the --cu-classify models from --cu-classify-dump CSV files\n"
+            "\n"
+            "  -o <filename>      Write the model to file instead of stdout\n"
+            "  --c-table          Write a C initializer for the compiled-in model\n"
+            "  --lambda <float>   L2 regularisation strength. Default 1.0\n"
+            "  --iterations <n>   Maximum Newton iterations. Default 25\n");
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const char* outName = NULL;
+    bool bCTable = false;
+    double lambda = 1.0;
+    int iterations = 25;
+    int numFiles = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-o") && i + 1 < argc)
+            outName = argv[++i];
+        else if (!strcmp(argv[i], "--c-table"))
+            bCTable = true;
+        else if (!strcmp(argv[i], "--lambda") && i + 1 < argc)
+            lambda = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (argv[i][0] == '-')
+        {
+            usage();
+            return 1;
+        }
+        else
+        {
+            if (!readCSV(argv[i]))
+                return 1;
+            numFiles++;
+        }
+    }
+
+    if (!numFiles)
+    {
+        usage();
+        return 1;
+    }
+
+    FILE* out = outName ? fopen(outName, "w") : stdout;
+    if (!out)
+    {
+        fprintf(stderr, "cutrain: unable to open %s\n", outName);
+        return 1;
+    }
+
+    int numFeatures = (int)featureNames.size();
+    if (bCTable)
+        fprintf(out, "{\n");
+    else
+    {
+        fprintf(out, "# x265 CU classifier model, %d samples\n# decision depth bias", (int)samples.size());
+        for (int i = 0; i < numFeatures; i++)
+            fprintf(out, " %s", featureNames[i].c_str());
+        fprintf(out, "\n");
+    }
+
+    for (int decision = 0; decision < numDecisions; decision++)
+    {
+        if (bCTable)
+            fprintf(out, "    { /* %s */\n", decisionNames[decision]);
+
+        for (int depth = 0; depth < MAX_DEPTHS; depth++)
+        {
+            double w[MAX_FEATURES + 1];
+            int count = train(decision, depth, lambda, iterations, w);
+            if (count)
+                report(decision, depth, w);
+
+            if (bCTable)
+            {
+                fprintf(out, "        {");
+                for (int i = 0; i <= numFeatures; i++)
+                    fprintf(out, " %.6f%s", w[i], i < numFeatures ? "," : " },\n");
+            }
+            else if (count)
+            {
+                fprintf(out, "%s %d", decisionNames[decision], depth);
+                for (int i = 0; i <= numFeatures; i++)
+                    fprintf(out, " %.6f", w[i]);
+                fprintf(out, "\n");
+            }
+        }
+
+        if (bCTable)
+            fprintf(out, "    },\n");
+    }
+
+    if (bCTable)
+        fprintf(out, "};\n");
+
+    if (outName)
+        fclose(out);
+
+    return 0;
+}
@@ -109,6 +109,8 @@ FILE* x265_csvlog_open(const x265_api& api, const x265_param& param, const char*
                     size /= 2;
                 }
                 fprintf(csvfp, ", Avg Luma Distortion, Avg Chroma Distortion, Avg psyEnergy, Avg Luma Level, Max Luma Level, Avg Residual Energy");
+                if (param.frameBudget > 0)
+                    fprintf(csvfp, ", Max Degrade Level, Degraded CTUs");
 
                 /* detailed performance statistics */
                 if (level >= 2)
@@ -177,6 +179,8 @@ void x265_csvlog_frame(FILE* csvfp, const x265_param& param, const x265_picture&
     for (uint32_t depth = 0; depth <= g_maxCUDepth; depth++)
         fprintf(csvfp, ", %5.2lf%%", frameStats->cuStats.percentMergeCu[depth]);
     fprintf(csvfp, ", %.2lf, %.2lf, %.2lf, %.2lf, %d, %.2lf", frameStats->avgLumaDistortion, frameStats->avgChromaDistortion, frameStats->avgPsyEnergy, frameStats->avgLumaLevel, frameStats->maxLumaLevel, frameStats->avgResEnergy);
+    if (param.frameBudget > 0)
+        fprintf(csvfp, ", %d, %5.2lf%%", frameStats->maxDegradeLevel, frameStats->percentDegradedCTU);
 
     if (level >= 2)
     {
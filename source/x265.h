@@ -147,6 +147,8 @@ typedef struct x265_frame_stats
     char             sliceType;
     int              bScenecut;
     int              frameLatency;
+    int              maxDegradeLevel;      // highest --frame-budget effort reduction applied, 0 if none
+    double           percentDegradedCTU;   // CTUs analyzed at reduced effort by --frame-budget
     x265_cu_stats    cuStats;
 } x265_frame_stats;
 
@@ -301,6 +303,9 @@ typedef enum
 
 #define X265_BFRAME_MAX         16
 #define X265_MAX_FRAME_THREADS  16
+#define X265_MAX_SLICES         16
+#define X265_MAX_TILE_COLUMNS   20
+#define X265_MAX_TILE_ROWS      22
 
 #define X265_TYPE_AUTO          0x0000  /* Let x265 choose the right type */
 #define X265_TYPE_IDR           0x0001
@@ -1236,6 +1241,157 @@ typedef struct x265_param
      * value to that value. */
     uint16_t maxLuma;
 
+    /* Share motion search results between references of the same PU. The best
+     * MV found on the first searched reference is scaled by POC distance and
+     * used as an extra search candidate for the remaining references (of both
+     * lists), and references whose scaled predictor cost is far worse than the
+     * best unidirectional cost found so far are not searched. Has no effect
+     * with --pme. Default disabled */
+    int       bEnableRefMVShare;
+
+    /* Predict the range of CU depths worth evaluating in each inter CTU from
+     * the depths chosen in the co-located CTUs of the nearest references and
+     * in the left and above CTUs, refined by the variance of the lookahead's
+     * intra costs over the CTU. Depths above the range are not split into and
+     * depths below it are not evaluated. Level 1 widens the predicted range by
+     * one depth in both directions, level 2 uses it unmodified. Ignored for
+     * I slices. Default 0 (disabled) */
+    int       cuDepthPredict;
+
+    /* Use learned classifiers, evaluated on cheap per-CU features after the
+     * merge/skip analysis, to stop CU recursion and to skip the remaining
+     * inter and intra modes when a merge/skip choice is very likely. Level 1
+     * only acts on confident predictions, level 2 is more aggressive. Only
+     * used at RD levels 1 to 6 without --pmode. Default 0 (disabled) */
+    int       cuClassify;
+
+    /* Filename of a model for the CU classifiers, as written by the cutrain
+     * tool. When NULL the compiled-in model is used. Default NULL */
+    const char* cuClassifyModel;
+
+    /* Filename of a CSV file which receives the classifier features and the
+     * final split and merge decisions of every inter CU whose decisions were
+     * fully analyzed. This is the input of the cutrain tool. Default NULL */
+    const char* cuClassifyDump;
+
+    /* Wall-time budget for the encode of each frame, in milliseconds, counted
+     * from the moment a frame encoder is given the frame. When a frame falls
+     * behind a linear schedule across its CTUs, the remaining CTUs are
+     * analyzed with progressively less effort (limit-modes, early-skip, lower
+     * subme, no rect partitions, lower rd level) until it catches up. The
+     * degradation of each frame is reported in x265_frame_stats. Frame
+     * encoders run concurrently, so for real-time encodes the budget is the
+     * frame interval times the number of frame threads. Default 0 (disabled) */
+    double    frameBudget;
+
+    /* Target encoder throughput in frames per second. When non-zero, the
+     * throughput achieved since the previous keyframe is measured at each
+     * keyframe and the encoder moves along a ladder of speed levels built from
+     * the presets, limited to the options x265_encoder_reconfig() can change.
+     * The configured options are the slowest level; the encoder only trades
+     * compression efficiency for speed when it does not keep up. Levels are
+     * changed through the reconfigure mechanism, so they override analysis
+     * options reconfigured by the application. Default 0 (disabled) */
+    double    targetFps;
+
+    /* Smallest CU size, in pixels, whose prediction modes are distributed to
+     * bonded worker threads by bDistributeModeAnalysis. The modes of smaller
+     * CUs are analyzed by the thread which owns the CTU, since waking peers
+     * for them costs more than the analysis itself. Does not affect the
+     * output. Default 16 */
+    uint32_t  pmodeMinSize;
+
+    /* Code CTUs of P and B pictures whose source is identical to the co-located
+     * block of a reference picture's source as a single skip CU without mode
+     * analysis. Pictures repeating the source of their first reference skip
+     * the per-CTU comparison with that reference. Meant for screen capture and
+     * slide content. Default disabled */
+    int       bStaticSkip;
+
+    /* Index every 8x8 block position of the source of each reference picture
+     * by its hash, and before the motion search of a prediction unit look up
+     * exact repeats of the unit at any distance within the legal MV range. An
+     * exact repeat is used in place of the regular search. Finds scrolled text
+     * and moved windows in screen content. Default disabled */
+    int       bHashME;
+
+    /* Re-use the RDOQ rate tables of a transform size for as long as no
+     * residual coding context has drifted more than two probability states
+     * or flipped its most probable symbol since they were estimated, rather
+     * than only while the contexts are unchanged. Trades a little compression
+     * efficiency for speed. Only used at rd levels 2 to 4 with RDOQ enabled.
+     * Default disabled */
+    int       bApproxRate;
+
+    /* Skip the transform and quant of chroma residuals predicted to have no
+     * coded coefficients from their energy, the chroma quantizer step and
+     * whether the luma residual of the same TU is coded. Residuals below half
+     * a quantizer step are certain to be uncoded; when luma is not coded,
+     * residuals up to a full step are assumed uncoded as well. Default
+     * disabled */
+    int       bEarlyChromaSkip;
+
+    /* API only. Optional allocator of the buffers NAL units are written to.
+     * When set, the encoder serializes each access unit directly into memory
+     * obtained from nalBufferAlloc(nalBufferOpaque, size), which must return
+     * at least size bytes or NULL, so the payloads returned by
+     * x265_encoder_encode() may be handed on without a copy. The encoder
+     * returns each buffer through nalBufferFree(nalBufferOpaque, buffer) at
+     * the point it would otherwise release it, which for an output access
+     * unit is the next call to x265_encoder_encode(); the application may
+     * keep the data for longer by deferring the re-use of the buffer. Both
+     * callbacks may be called from any encoder thread. Default NULL, for
+     * buffers allocated by the encoder */
+    void*     (*nalBufferAlloc)(void* opaque, uint32_t size);
+    void      (*nalBufferFree)(void* opaque, void* buffer);
+    void*     nalBufferOpaque;
+
+    /* Number of slices each picture is split into, between 1 and
+     * X265_MAX_SLICES. Each slice is a band of whole CTU rows with its own
+     * entropy coder and its own slice NAL unit, and the first row of every
+     * slice may be encoded as soon as the frame starts, so low resolution
+     * encodes can keep more worker threads busy with fewer frame threads.
+     * Loop filtering across slice boundaries is disabled when more than one
+     * slice is used. Clamped to the number of CTU rows. Default 1 */
+    int       maxSlices;
+
+    /* Number of tile columns and tile rows each picture is split into. The
+     * tiles are spaced uniformly and each tile has its own entropy coder
+     * and entry point in the slice header. Prediction does not cross tile
+     * boundaries but loop filtering does. The CTU rows of different tile
+     * columns are encoded at once, so every tile column keeps a worker
+     * thread busy from the first CTU row of the picture to the last. Tiles
+     * replace WPP and cannot be combined with more than one slice. Tile
+     * columns are clamped to at least 256 luma samples wide and tile rows
+     * to at least 64 luma samples high. Default 1, 1 */
+    int       numTileColumns;
+    int       numTileRows;
+
+    /* API only. Optional callback which receives the NAL units of each
+     * picture as soon as they are complete, ahead of x265_encoder_encode()
+     * returning the whole access unit. Each slice is passed on once all of
+     * its CTU rows are coded and their SAO parameters decided, together with
+     * the NAL units preceding it in the access unit, so with multiple slices
+     * the first of them are available well before the picture is finished.
+     * The last call for a picture has bLast set and passes the NAL units
+     * following the last slice, if any. pts is the presentation time stamp
+     * of the picture. The payloads are valid only until the callback
+     * returns. The callback is made from encoder threads, one call at a
+     * time, in bitstream order; x265_encoder_encode() still returns every
+     * access unit as usual. Setting it limits the encoder to one frame
+     * thread. Default NULL */
+    void      (*nalOutput)(void* opaque, const x265_nal* nal, uint32_t numNal, int64_t pts, int bLast);
+    void*     nalOutputOpaque;
+
+    /* Measure PSNR and SSIM and compute the decoded picture hash of each CTU
+     * row in the background. Instead of delaying the completion of every
+     * row, the finished rows are measured in order by an otherwise idle
+     * worker thread, and whatever is left is measured when the picture is
+     * finished, before the hash SEI is written. Reported values and the
+     * bitstream are identical. Has no effect without a thread pool.
+     * Default disabled */
+    int       bAsyncMetrics;
+
 } x265_param;
 
 /* x265_param_alloc:
@@ -1427,6 +1583,26 @@ void x265_encoder_close(x265_encoder *);
 
 int x265_encoder_intra_refresh(x265_encoder *);
 
+/* x265_encoder_share_analysis:
+ *      Attach dependent as a dependent encoder of master so that the lower
+ *      renditions of an ABR ladder reuse the analysis of the master encode in
+ *      memory. Each dependent takes the master's slice type for every picture
+ *      and uses its CU depths, prediction modes, references and motion
+ *      vectors, scaled to its own resolution, to limit and seed its own CU
+ *      analysis. The decisions are not forced, each dependent still makes RD
+ *      decisions with its own rate control.
+ *
+ *      Both encoders must use the same CTU size and GOP structure (keyint,
+ *      open-gop, bframes and b-pyramid) and neither may have been passed a
+ *      picture yet. A master may have any number of dependents; a dependent
+ *      cannot itself be a master. The same pictures must be passed to all
+ *      encoders in the same order, each dependent holds back its pictures
+ *      until the master has output them, so feed and flush the master first.
+ *      The encoders may be closed in any order.
+ *
+ *      returns 0 on success, negative on error */
+int x265_encoder_share_analysis(x265_encoder *master, x265_encoder *dependent);
+
 /* x265_cleanup:
  *       release library static allocations, reset configured CTU size */
 void x265_cleanup(void);
@@ -1475,6 +1651,7 @@ typedef struct x265_api
 
     int           sizeof_frame_stats;   /* sizeof(x265_frame_stats) */
     int           (*encoder_intra_refresh)(x265_encoder*);
+    int           (*encoder_share_analysis)(x265_encoder*, x265_encoder*);
     /* add new pointers to the end, or increment X265_MAJOR_VERSION */
 } x265_api;
 
@@ -49,6 +49,9 @@ static const struct option long_options[] =
     { "pmode",                no_argument, NULL, 0 },
     { "no-pme",               no_argument, NULL, 0 },
     { "pme",                  no_argument, NULL, 0 },
+    { "pmode-min-size", required_argument, NULL, 0 },
+    { "frame-budget",   required_argument, NULL, 0 },
+    { "target-fps",     required_argument, NULL, 0 },
     { "log-level",      required_argument, NULL, 0 },
     { "profile",        required_argument, NULL, 'P' },
     { "level-idc",      required_argument, NULL, 0 },
@@ -77,6 +80,9 @@ static const struct option long_options[] =
     { "frames",         required_argument, NULL, 'f' },
     { "recon",          required_argument, NULL, 'r' },
     { "recon-depth",    required_argument, NULL, 0 },
+    { "slices",         required_argument, NULL, 0 },
+    { "tile-columns",   required_argument, NULL, 0 },
+    { "tile-rows",      required_argument, NULL, 0 },
     { "no-wpp",               no_argument, NULL, 0 },
     { "wpp",                  no_argument, NULL, 0 },
     { "ctu",            required_argument, NULL, 's' },
@@ -97,6 +103,12 @@ static const struct option long_options[] =
     { "amp",                  no_argument, NULL, 0 },
     { "no-early-skip",        no_argument, NULL, 0 },
     { "early-skip",           no_argument, NULL, 0 },
+    { "no-early-chroma-skip", no_argument, NULL, 0 },
+    { "early-chroma-skip",    no_argument, NULL, 0 },
+    { "no-static-skip",       no_argument, NULL, 0 },
+    { "static-skip",          no_argument, NULL, 0 },
+    { "no-hash-me",           no_argument, NULL, 0 },
+    { "hash-me",              no_argument, NULL, 0 },
     { "no-rskip",             no_argument, NULL, 0 },
     { "rskip",                no_argument, NULL, 0 },
     { "no-fast-cbf",          no_argument, NULL, 0 },
@@ -132,6 +144,12 @@ static const struct option long_options[] =
     { "limit-refs",     required_argument, NULL, 0 },
     { "no-limit-modes",       no_argument, NULL, 0 },
     { "limit-modes",          no_argument, NULL, 0 },
+    { "no-ref-mv-share",      no_argument, NULL, 0 },
+    { "ref-mv-share",         no_argument, NULL, 0 },
+    { "depth-predict",  required_argument, NULL, 0 },
+    { "cu-classify",    required_argument, NULL, 0 },
+    { "cu-classify-model", required_argument, NULL, 0 },
+    { "cu-classify-dump", required_argument, NULL, 0 },
     { "no-weightp",           no_argument, NULL, 0 },
     { "weightp",              no_argument, NULL, 'w' },
     { "no-weightb",           no_argument, NULL, 0 },
@@ -160,6 +178,8 @@ static const struct option long_options[] =
     { "rd",             required_argument, NULL, 0 },
     { "rdoq-level",     required_argument, NULL, 0 },
     { "no-rdoq-level",        no_argument, NULL, 0 },
+    { "approx-rate",          no_argument, NULL, 0 },
+    { "no-approx-rate",       no_argument, NULL, 0 },
     { "psy-rd",         required_argument, NULL, 0 },
     { "psy-rdoq",       required_argument, NULL, 0 },
     { "no-psy-rd",            no_argument, NULL, 0 },
@@ -184,6 +204,8 @@ static const struct option long_options[] =
     { "no-psnr",              no_argument, NULL, 0 },
     { "psnr",                 no_argument, NULL, 0 },
     { "hash",           required_argument, NULL, 0 },
+    { "no-async-metrics",     no_argument, NULL, 0 },
+    { "async-metrics",        no_argument, NULL, 0 },
     { "no-strong-intra-smoothing", no_argument, NULL, 0 },
     { "strong-intra-smoothing",    no_argument, NULL, 0 },
     { "no-cutree",                 no_argument, NULL, 0 },
@@ -282,6 +304,7 @@ static void showHelp(x265_param *param)
     H0("\nQuality reporting metrics:\n");
     H0("   --[no-]ssim                   Enable reporting SSIM metric scores. Default %s\n", OPT(param->bEnableSsim));
     H0("   --[no-]psnr                   Enable reporting PSNR metric scores. Default %s\n", OPT(param->bEnablePsnr));
+    H1("   --[no-]async-metrics          Measure metrics and picture hash of finished rows on idle worker threads. Default %s\n", OPT(param->bAsyncMetrics));
     H0("\nProfile, Level, Tier:\n");
     H0("-P/--profile <string>            Enforce an encode profile: main, main10, mainstillpicture\n");
     H0("   --level-idc <integer|float>   Force a minimum required decoder level (as '5.0' or '50')\n");
@@ -293,8 +316,14 @@ static void showHelp(x265_param *param)
     H0("                                 '-' implies no threads on node, '+' implies one thread per core on node\n");
     H0("-F/--frame-threads <integer>     Number of concurrently encoded frames. 0: auto-determined by core count\n");
     H0("   --[no-]wpp                    Enable Wavefront Parallel Processing. Default %s\n", OPT(param->bEnableWavefront));
+    H0("   --slices <integer>            Number of slices per picture, each a band of CTU rows. Default %d\n", param->maxSlices);
+    H0("   --tile-columns <integer>      Number of uniformly spaced tile columns, encoded in parallel. Default %d\n", param->numTileColumns);
+    H0("   --tile-rows <integer>         Number of uniformly spaced tile rows. Default %d\n", param->numTileRows);
     H0("   --[no-]pmode                  Parallel mode analysis. Default %s\n", OPT(param->bDistributeModeAnalysis));
     H0("   --[no-]pme                    Parallel motion estimation. Default %s\n", OPT(param->bDistributeMotionEstimation));
+    H0("   --pmode-min-size <integer>    Smallest CU size whose modes --pmode distributes. Default %u\n", param->pmodeMinSize);
+    H0("   --frame-budget <float>        Wall-time budget per frame in ms, analysis effort drops when behind. Default %.1f\n", param->frameBudget);
+    H0("   --target-fps <float>          Adapt analysis effort at keyframes to keep up with this throughput. Default %.1f\n", param->targetFps);
     H0("   --[no-]asm <bool|int|string>  Override CPU detection. Default: auto\n");
     H0("\nPresets:\n");
     H0("-p/--preset <string>             Trade off performance for compression efficiency. Default medium\n");
@@ -312,8 +341,11 @@ static void showHelp(x265_param *param)
     H0("   --[no-]psy-rd <0..5.0>        Strength of psycho-visual rate distortion optimization, 0 to disable. Default %.1f\n", param->psyRd);
     H0("   --[no-]rdoq-level <0|1|2>     Level of RDO in quantization 0:none, 1:levels, 2:levels & coding groups. Default %d\n", param->rdoqLevel);
     H0("   --[no-]psy-rdoq <0..50.0>     Strength of psycho-visual optimization in RDO quantization, 0 to disable. Default %.1f\n", param->psyRdoq);
+    H0("   --[no-]approx-rate            Re-use RDOQ rate tables until the contexts drift, at rd levels 2 to 4. Default %s\n", OPT(param->bApproxRate));
     H0("   --[no-]rd-refine              Enable QP based RD refinement for rd levels 5 and 6. Default %s\n", OPT(param->bEnableRdRefine));
     H0("   --[no-]early-skip             Enable early SKIP detection. Default %s\n", OPT(param->bEnableEarlySkip));
+    H0("   --[no-]early-chroma-skip      Skip transform and quant of chroma residuals predicted to be uncoded. Default %s\n", OPT(param->bEarlyChromaSkip));
+    H0("   --[no-]static-skip            Code CTUs identical to a reference as skip without analysis. Default %s\n", OPT(param->bStaticSkip));
     H0("   --[no-]rskip                  Enable early exit from recursion. Default %s\n", OPT(param->bEnableRecursionSkip));
     H1("   --[no-]tskip-fast             Enable fast intra transform skipping. Default %s\n", OPT(param->bEnableTSkipFast));
     H1("   --nr-intra <integer>          An integer value in range of 0 to 2000, which denotes strength of noise reduction in intra CUs. Default 0\n");
@@ -328,9 +360,15 @@ static void showHelp(x265_param *param)
     H0("   --max-merge <1..5>            Maximum number of merge candidates. Default %d\n", param->maxNumMergeCand);
     H0("   --ref <integer>               max number of L0 references to be allowed (1 .. 16) Default %d\n", param->maxNumReferences);
     H0("   --limit-refs <0|1|2|3>        Limit references per depth (1) or CU (2) or both (3). Default %d\n", param->limitReferences);
+    H0("   --[no-]ref-mv-share           Seed and prune reference searches with POC-scaled MVs of the first reference. Default %s\n", OPT(param->bEnableRefMVShare));
+    H0("   --depth-predict <0|1|2>       Limit CU depths to a range predicted from neighbour and reference CTUs. Default %d\n", param->cuDepthPredict);
+    H0("   --cu-classify <0|1|2>         Predict CU split and merge decisions with learned classifiers. Default %d\n", param->cuClassify);
+    H1("   --cu-classify-model <file>    Load the CU classifier model from file. Default compiled-in model\n");
+    H1("   --cu-classify-dump <file>     Write CU classifier training samples to a CSV file\n");
     H0("   --me <string>                 Motion search method dia hex umh star full. Default %d\n", param->searchMethod);
     H0("-m/--subme <integer>             Amount of subpel refinement to perform (0:least .. 7:most). Default %d \n", param->subpelRefine);
     H0("   --merange <integer>           Motion search range. Default %d\n", param->searchRange);
+    H0("   --[no-]hash-me                Look up exact block repeats at any distance before motion search. Default %s\n", OPT(param->bHashME));
     H0("   --[no-]rect                   Enable rectangular motion partitions Nx2N and 2NxN. Default %s\n", OPT(param->bEnableRectInter));
     H0("   --[no-]amp                    Enable asymmetric motion partitions, requires --rect. Default %s\n", OPT(param->bEnableAMP));
     H0("   --[no-]limit-modes            Limit rectangular and asymmetric motion predictions. Default %d\n", param->limitModes);